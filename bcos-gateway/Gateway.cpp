@@ -23,10 +23,12 @@
 #include <bcos-framework/libutilities/Exceptions.h>
 #include <bcos-gateway/Common.h>
 #include <bcos-gateway/Gateway.h>
+#include <bcos-gateway/libnetwork/ASIOInterface.h>
+#include <bcos-gateway/libnetwork/Host.h>
 #include <json/json.h>
 #include <boost/core/ignore_unused.hpp>
 #include <algorithm>
-#include <random>
+#include <limits>
 
 using namespace bcos;
 using namespace bcos::protocol;
@@ -212,6 +214,24 @@ bool Gateway::trySendLocalMessage(const std::string& _groupID, bcos::crypto::Nod
 void Gateway::asyncSendMessageByNodeID(const std::string& _groupID,
     bcos::crypto::NodeIDPtr _srcNodeID, bcos::crypto::NodeIDPtr _dstNodeID, bytesConstRef _payload,
     ErrorRespFunc _errorRespFunc)
+{
+    asyncSendMessageByNodeID(
+        _groupID, _srcNodeID, _dstNodeID, _payload, m_unicastTimeout, _errorRespFunc);
+}
+
+/**
+ * @brief: send message with the deadline
+ * @param _groupID: groupID
+ * @param _srcNodeID: the sender nodeID
+ * @param _dstNodeID: the receiver nodeID
+ * @param _payload: message payload
+ * @param _timeout: the milliseconds to send the message, including all the retries
+ * @param _errorRespFunc: error func
+ * @return void
+ */
+void Gateway::asyncSendMessageByNodeID(const std::string& _groupID,
+    bcos::crypto::NodeIDPtr _srcNodeID, bcos::crypto::NodeIDPtr _dstNodeID, bytesConstRef _payload,
+    uint32_t _timeout, ErrorRespFunc _errorRespFunc)
 {
     std::set<P2pID> p2pIDs;
     if (!m_gatewayNodeManager->queryP2pIDs(_groupID, _dstNodeID->hex(), p2pIDs))
@@ -238,33 +258,92 @@ void Gateway::asyncSendMessageByNodeID(const std::string& _groupID,
     class Retry : public std::enable_shared_from_this<Retry>
     {
     public:
-        // random choose one p2pID to send message
-        P2pID randomChooseP2pID()
+        // choose the p2pID to send message by the quality of the links: the better of two random
+        // gateways the first time, the best of the rest when retrying, the congested and the
+        // disconnected gateways are chosen at last
+        P2pID chooseP2pID()
         {
             auto p2pId = P2pID();
             if (!m_p2pIDs.empty())
             {
-                // shuffle
-                std::random_device rd;
-                std::default_random_engine rng(rd());
-                std::shuffle(m_p2pIDs.begin(), m_p2pIDs.end(), rng);
-                p2pId = *m_p2pIDs.begin();
-                m_p2pIDs.erase(m_p2pIDs.begin());
+                std::vector<double> scores;
+                scores.reserve(m_p2pIDs.size());
+                for (auto const& p2pID : m_p2pIDs)
+                {
+                    auto linkQuality = m_p2pInterface->linkQuality(p2pID);
+                    scores.push_back(linkQuality && !m_p2pInterface->isCongested(p2pID) ?
+                                         linkQuality->score() :
+                                         std::numeric_limits<double>::max());
+                }
+                auto it = m_p2pIDs.begin() + LinkQuality::choose(scores, m_retried);
+                p2pId = *it;
+                m_p2pIDs.erase(it);
+                m_retried = true;
             }
 
             return p2pId;
         }
 
-        // send the message with retry
+        // choose the gateway to send and the timeout of the attempt, false if no gateway left or
+        // the deadline passed, called with x_retry held
+        bool nextP2pID(P2pID& _p2pID, uint64_t& _timeout)
+        {
+            auto now = utcSteadyTime();
+            while (!m_p2pIDs.empty() && now < m_deadline)
+            {
+                // the attempt has all the remaining time, a stalled gateway is covered by the
+                // hedged request instead of cutting the time of the healthy one
+                _timeout = m_deadline - now;
+                _p2pID = chooseP2pID();
+                // the callback is never called for the disconnected gateway
+                if (m_p2pInterface->isConnected(_p2pID))
+                {
+                    return true;
+                }
+                GATEWAY_LOG(DEBUG)
+                    << LOG_BADGE("Retry") << LOG_DESC("skip the disconnected gateway")
+                    << LOG_KV("p2pid", _p2pID) << LOG_KV("seq", m_p2pMessage->seq());
+            }
+            return false;
+        }
+
+        // send the message to the next gateway, the error is responded when no gateway left or
+        // the deadline passed and no hedged request is waiting
         void trySendMessage()
         {
-            if (m_p2pIDs.empty())
+            P2pID p2pID;
+            uint64_t timeout = 0;
+            bool first = false;
             {
+                Guard l(x_retry);
+                if (m_finished)
+                {
+                    return;
+                }
+                first = !m_retried;
+                if (nextP2pID(p2pID, timeout))
+                {
+                    m_inflight++;
+                }
+                else if (m_inflight > 0)
+                {
+                    return;
+                }
+                else
+                {
+                    m_finished = true;
+                    p2pID.clear();
+                }
+            }
+            if (p2pID.empty())
+            {
+                cancelHedge();
                 GATEWAY_LOG(ERROR)
                     << LOG_DESC("[Gateway::Retry]") << LOG_DESC("unable to send the message")
                     << LOG_KV("srcNodeID", m_srcNodeID->hex())
                     << LOG_KV("dstNodeID", m_dstNodeID->hex())
-                    << LOG_KV("seq", std::to_string(m_p2pMessage->seq()));
+                    << LOG_KV("seq", std::to_string(m_p2pMessage->seq()))
+                    << LOG_KV("expired", utcSteadyTime() >= m_deadline);
 
                 if (m_respFunc)
                 {
@@ -274,11 +353,126 @@ void Gateway::asyncSendMessageByNodeID(const std::string& _groupID,
                 }
                 return;
             }
-            auto p2pID = randomChooseP2pID();
+            sendMessage(p2pID, timeout);
+            if (first && m_hedge)
+            {
+                scheduleHedge(p2pID);
+            }
+        }
+
+        // send the same message to another gateway if the first one has not responded in its
+        // p95 latency, the response arriving first is used
+        void scheduleHedge(P2pID const& _p2pID)
+        {
+            auto linkQuality = m_p2pInterface->linkQuality(_p2pID);
+            auto latency = linkQuality ? linkQuality->latencyP95() : 0;
+            auto host = m_p2pInterface->host();
+            // not enough latency samples of the gateway
+            if (latency == 0 || !host || !host->asioInterface())
+            {
+                return;
+            }
+            auto delay = std::max<uint64_t>(latency / 1000, 1);
+            Guard l(x_retry);
+            if (m_finished || m_p2pIDs.empty() || utcSteadyTime() + delay >= m_deadline)
+            {
+                return;
+            }
+            auto self = shared_from_this();
+            m_hedgeTimer = host->asioInterface()->newTimer(delay);
+            m_hedgeTimer->async_wait([self](const boost::system::error_code& _error) {
+                if (!_error)
+                {
+                    self->hedge();
+                }
+            });
+        }
+
+        // the timer holds the retry until it expires, cancel it once the request finished
+        void cancelHedge()
+        {
+            std::shared_ptr<boost::asio::deadline_timer> hedgeTimer;
+            {
+                Guard l(x_retry);
+                hedgeTimer = std::move(m_hedgeTimer);
+            }
+            if (hedgeTimer)
+            {
+                hedgeTimer->cancel();
+            }
+        }
+
+        void hedge()
+        {
+            P2pID p2pID;
+            uint64_t timeout = 0;
+            {
+                Guard l(x_retry);
+                // responded or failed already
+                if (m_finished || m_inflight == 0 || !nextP2pID(p2pID, timeout))
+                {
+                    return;
+                }
+                m_inflight++;
+            }
+            GATEWAY_LOG(DEBUG) << LOG_BADGE("Retry") << LOG_DESC("hedge the request")
+                               << LOG_KV("p2pid", p2pID) << LOG_KV("seq", m_p2pMessage->seq())
+                               << LOG_KV("timeout", timeout);
+            sendMessage(p2pID, timeout);
+        }
+
+        void onSucceeded()
+        {
+            {
+                Guard l(x_retry);
+                m_inflight--;
+                if (m_finished)
+                {
+                    return;
+                }
+                m_finished = true;
+            }
+            cancelHedge();
+            if (m_respFunc)
+            {
+                m_respFunc(nullptr);
+            }
+        }
+
+        void onFailed()
+        {
+            {
+                Guard l(x_retry);
+                m_inflight--;
+                // the hedged request is still waiting
+                if (m_finished || m_inflight > 0)
+                {
+                    return;
+                }
+            }
+            trySendMessage();
+        }
+
+        void sendMessage(P2pID const& _p2pID, uint64_t _timeout)
+        {
+            // the session carrying the message among the sessions with the gateway
+            auto linkQuality = m_p2pInterface->linkQuality(_p2pID, m_p2pMessage);
+            if (linkQuality)
+            {
+                linkQuality->onRequestStarted();
+            }
+            auto startTime = LinkQuality::steadyTimeUs();
             auto self = shared_from_this();
-            auto callback = [self, p2pID](NetworkException e, std::shared_ptr<P2PSession> session,
+            auto p2pID = _p2pID;
+            auto callback = [self, p2pID, linkQuality, startTime](NetworkException e,
+                                std::shared_ptr<P2PSession> session,
                                 std::shared_ptr<P2PMessage> message) {
                 boost::ignore_unused(session);
+                if (linkQuality)
+                {
+                    linkQuality->onRequestFinished(e.errorCode() == P2PExceptionType::Success,
+                        LinkQuality::steadyTimeUs() - startTime);
+                }
                 // network error
                 if (e.errorCode() != P2PExceptionType::Success)
                 {
@@ -287,15 +481,15 @@ void Gateway::asyncSendMessageByNodeID(const std::string& _groupID,
                         << LOG_KV("p2pid", p2pID) << LOG_KV("errorCode", e.errorCode())
                         << LOG_KV("errorMessage", e.what());
                     // try again
-                    self->trySendMessage();
+                    self->onFailed();
                     return;
                 }
 
                 try
                 {
-                    auto payload = message->payload();
+                    auto payload = message->payloadRef();
                     int respCode =
-                        boost::lexical_cast<int>(std::string(payload->begin(), payload->end()));
+                        boost::lexical_cast<int>(std::string(payload.begin(), payload.end()));
                     // the peer gateway not response not ok ,it means the gateway not dispatch the
                     // message successfully,find another gateway and try again
                     if (respCode != CommonError::SUCCESS)
@@ -304,7 +498,7 @@ void Gateway::asyncSendMessageByNodeID(const std::string& _groupID,
                             << LOG_BADGE("Retry") << LOG_KV("p2pid", p2pID)
                             << LOG_KV("errorCode", respCode) << LOG_KV("errorMessage", e.what());
                         // try again
-                        self->trySendMessage();
+                        self->onFailed();
                         return;
                     }
 
@@ -312,20 +506,18 @@ void Gateway::asyncSendMessageByNodeID(const std::string& _groupID,
                                        << LOG_KV("srcNodeID", self->m_srcNodeID->hex())
                                        << LOG_KV("dstNodeID", self->m_dstNodeID->hex());
                     // send message successfully
-                    if (self->m_respFunc)
-                    {
-                        self->m_respFunc(nullptr);
-                    }
+                    self->onSucceeded();
                     return;
                 }
                 catch (const std::exception& e)
                 {
                     GATEWAY_LOG(ERROR) << LOG_BADGE("Retry") << LOG_KV("error", e.what());
-                    self->trySendMessage();
+                    self->onFailed();
                 }
             };
 
-            m_p2pInterface->asyncSendMessageByNodeID(p2pID, m_p2pMessage, callback, Options(10000));
+            m_p2pInterface->asyncSendMessageByNodeID(
+                p2pID, m_p2pMessage, callback, Options((uint32_t)_timeout));
         }
 
     public:
@@ -335,6 +527,16 @@ void Gateway::asyncSendMessageByNodeID(const std::string& _groupID,
         std::shared_ptr<P2PMessage> m_p2pMessage;
         std::shared_ptr<P2PInterface> m_p2pInterface;
         ErrorRespFunc m_respFunc;
+        // the steady time in milliseconds when the request expires, including all the retries
+        uint64_t m_deadline = 0;
+        bool m_hedge = false;
+
+        Mutex x_retry;
+        bool m_retried = false;
+        bool m_finished = false;
+        // the requests sent and waiting for the response, 2 at most with the hedged one
+        size_t m_inflight = 0;
+        std::shared_ptr<boost::asio::deadline_timer> m_hedgeTimer;
     };
 
     auto retry = std::make_shared<Retry>();
@@ -344,6 +546,10 @@ void Gateway::asyncSendMessageByNodeID(const std::string& _groupID,
     retry->m_srcNodeID = _srcNodeID;
     retry->m_dstNodeID = _dstNodeID;
     retry->m_p2pInterface = m_p2pInterface;
+    retry->m_deadline = utcSteadyTime() + _timeout;
+    retry->m_hedge = m_hedgeRequests;
+    // the remaining time is sent with the message, so the peer gateway drops it once expired
+    retry->m_p2pMessage->setDeadline(retry->m_deadline);
     retry->trySendMessage();
 }
 
@@ -428,10 +634,8 @@ void Gateway::asyncSendBroadcastMessage(
     }
 
     auto p2pMessage = newP2PMessage(_groupID, _srcNodeID, _payload);
-    for (const P2pID& p2pID : p2pIDs)
-    {
-        m_p2pInterface->asyncSendMessageByNodeID(p2pID, p2pMessage, CallbackFuncWithSession());
-    }
+    m_p2pInterface->asyncSendMessageByNodeIDs(
+        std::vector<P2pID>(p2pIDs.begin(), p2pIDs.end()), p2pMessage);
 
     GATEWAY_LOG(TRACE) << "asyncSendBroadcastMessage send message" << LOG_KV("groupID", _groupID);
 }
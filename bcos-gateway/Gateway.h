@@ -100,6 +100,22 @@ public:
     void asyncSendMessageByNodeID(const std::string& _groupID, bcos::crypto::NodeIDPtr _srcNodeID,
         bcos::crypto::NodeIDPtr _dstNodeID, bytesConstRef _payload,
         ErrorRespFunc _errorRespFunc) override;
+    /**
+     * @brief: send message with the deadline
+     * @param _timeout: the milliseconds to send the message, including all the retries and the
+     * hedged request, the remaining time is sent to the peer gateway to drop the expired message
+     */
+    virtual void asyncSendMessageByNodeID(const std::string& _groupID,
+        bcos::crypto::NodeIDPtr _srcNodeID, bcos::crypto::NodeIDPtr _dstNodeID,
+        bytesConstRef _payload, uint32_t _timeout, ErrorRespFunc _errorRespFunc);
+
+    /// the deadline of the messages sent without timeout in milliseconds
+    uint32_t unicastTimeout() const { return m_unicastTimeout; }
+    void setUnicastTimeout(uint32_t _unicastTimeout) { m_unicastTimeout = _unicastTimeout; }
+    /// send the message to the second gateway if the first one has not responded in its p95
+    /// latency, the response arriving first is used
+    bool hedgeRequests() const { return m_hedgeRequests; }
+    void setHedgeRequests(bool _hedgeRequests) { m_hedgeRequests = _hedgeRequests; }
 
     /**
      * @brief: send message to multiple nodes
@@ -194,6 +210,8 @@ private:
     // GatewayNodeManager
     GatewayNodeManager::Ptr m_gatewayNodeManager;
     bcos::amop::AMOPImpl::Ptr m_amop;
+    uint32_t m_unicastTimeout = 10000;
+    bool m_hedgeRequests = false;
 };
 }  // namespace gateway
 }  // namespace bcos
@@ -7,6 +7,7 @@
 #include <bcos-gateway/GatewayConfig.h>
 #include <json/json.h>
 #include <boost/throw_exception.hpp>
+#include <thread>
 
 using namespace bcos;
 using namespace gateway;
@@ -163,6 +164,46 @@ void GatewayConfig::initP2PConfig(const boost::property_tree::ptree& _pt)
       listen_port=30300
       nodes_path=./
       nodes_file=nodes.json
+      ; the number of io threads, default is the number of cpu cores
+      io_thread_count=8
+      ; the received messages are dispatched by the lanes of the packet types, every lane has its
+      ; own threads, the messages of every session are handled in the received order in the lane
+      ;   control: Handshake, Heartbeat, RequestNodeIDs, ResponseNodeIDs
+      ;   p2p: PeerToPeerMessage and the other types, broadcast: BroadcastMessage, amop: AMOP
+      ; configured by lane:threads:queue_limit, the lanes not configured keep the values below,
+      ; 0 threads means dispatch by the p2p thread pool without order, the messages of a session
+      ; exceeding the queue_limit of the lane are dropped, 0 queue_limit means no limit
+      dispatch_lanes=control:2:0,p2p:16:100000,broadcast:4:100000,amop:4:10000
+      ; the watermarks of the write queue of every session, the messages are rejected when the
+      ; queue exceeds the high watermark until it drains below the low watermark
+      write_queue_high_watermark_mb=64
+      write_queue_low_watermark_mb=32
+      write_queue_high_watermark_msgs=100000
+      write_queue_low_watermark_msgs=50000
+      ; the number of the ssl sessions cached to resume the reconnections, 0 means disable
+      ssl_session_cache_size=1024
+      ; the trusted networks(e.g. the private vlan of the rack) connected in plaintext, the
+      ; identity of the peer is still authenticated with the node certificate and key
+      plaintext_networks=10.0.0.0/24,192.168.1.10
+      ; the number of the parallel connections with every peer gateway, the messages are striped
+      ; across them(the messages of the same group and nodes keep their order)
+      connections_per_peer=1
+      ; the messages larger than fragment_size_kb are sent in fragments interleaved with the
+      ; other messages(only to the peers supporting reassembly), 0 means disable
+      fragment_size_kb=64
+      ; the max memory of the messages being reassembled from all the sessions
+      max_reassembly_mb=256
+      ; compress the payloads larger than compress_threshold_kb with zstd, only for the peers
+      ; able to decompress
+      compression=false
+      compress_threshold_kb=16
+      compress_level=3
+      ; the milliseconds to send a message to the node of the other gateway, including the retries
+      ; by the other gateways, the remaining time is sent with the message to drop it once expired
+      unicast_timeout_ms=10000
+      ; send the message to the second gateway if the first one has not responded in its p95
+      ; latency, the response arriving first is used
+      hedge_requests=false
       */
     bool smSSL = _pt.get<bool>("p2p.sm_ssl", false);
     std::string listenIP = _pt.get<std::string>("p2p.listen_ip", "0.0.0.0");
@@ -182,6 +223,113 @@ void GatewayConfig::initP2PConfig(const boost::property_tree::ptree& _pt)
 
     m_nodeFileName = _pt.get<std::string>("p2p.nodes_file", "nodes.json");
 
+    int ioThreadCount =
+        _pt.get<int>("p2p.io_thread_count", std::max(1u, std::thread::hardware_concurrency()));
+    if (ioThreadCount <= 0)
+    {
+        BOOST_THROW_EXCEPTION(
+            InvalidParameter() << errinfo_comment("initP2PConfig: invalid io_thread_count, value=" +
+                                                  std::to_string(ioThreadCount)));
+    }
+    m_ioThreadCount = ioThreadCount;
+
+    std::string dispatchLanes = _pt.get<std::string>("p2p.dispatch_lanes", "");
+    parseDispatchLanes(dispatchLanes, m_dispatchLanes);
+
+    WriteQueueWatermark watermark;
+    int64_t highWatermarkMB = _pt.get<int64_t>(
+        "p2p.write_queue_high_watermark_mb", watermark.highBytes / (1024 * 1024));
+    int64_t lowWatermarkMB =
+        _pt.get<int64_t>("p2p.write_queue_low_watermark_mb", watermark.lowBytes / (1024 * 1024));
+    int64_t highWatermarkMsgs =
+        _pt.get<int64_t>("p2p.write_queue_high_watermark_msgs", watermark.highMessages);
+    int64_t lowWatermarkMsgs =
+        _pt.get<int64_t>("p2p.write_queue_low_watermark_msgs", watermark.lowMessages);
+    if (lowWatermarkMB < 0 || highWatermarkMB <= lowWatermarkMB || lowWatermarkMsgs < 0 ||
+        highWatermarkMsgs <= lowWatermarkMsgs)
+    {
+        BOOST_THROW_EXCEPTION(InvalidParameter() << errinfo_comment(
+                                  "initP2PConfig: invalid write queue watermark, the low "
+                                  "watermark must be non-negative and less than the high one"));
+    }
+    watermark.highBytes = highWatermarkMB * 1024 * 1024;
+    watermark.lowBytes = lowWatermarkMB * 1024 * 1024;
+    watermark.highMessages = highWatermarkMsgs;
+    watermark.lowMessages = lowWatermarkMsgs;
+    m_writeQueueWatermark = watermark;
+
+    int64_t sslSessionCacheSize = _pt.get<int64_t>("p2p.ssl_session_cache_size", 1024);
+    if (sslSessionCacheSize < 0)
+    {
+        BOOST_THROW_EXCEPTION(InvalidParameter() << errinfo_comment(
+                                  "initP2PConfig: invalid ssl_session_cache_size, value=" +
+                                  std::to_string(sslSessionCacheSize)));
+    }
+    m_sslSessionCacheSize = sslSessionCacheSize;
+
+    std::string plaintextNetworks = _pt.get<std::string>("p2p.plaintext_networks", "");
+    std::vector<std::string> networks;
+    boost::split(networks, plaintextNetworks, boost::is_any_of(","), boost::token_compress_on);
+    networks.erase(std::remove_if(networks.begin(), networks.end(),
+                       [](std::string& _network) {
+                           boost::trim(_network);
+                           return _network.empty();
+                       }),
+        networks.end());
+    // throws if any network is invalid
+    PlaintextNetworks checkNetworks(networks);
+    m_plaintextNetworks = networks;
+
+    int connectionsPerPeer = _pt.get<int>("p2p.connections_per_peer", 1);
+    if (connectionsPerPeer <= 0 || connectionsPerPeer > (int)c_maxConnectionsPerPeer)
+    {
+        BOOST_THROW_EXCEPTION(InvalidParameter() << errinfo_comment(
+                                  "initP2PConfig: invalid connections_per_peer, value=" +
+                                  std::to_string(connectionsPerPeer)));
+    }
+    m_connectionsPerPeer = connectionsPerPeer;
+
+    int64_t fragmentSizeKB =
+        _pt.get<int64_t>("p2p.fragment_size_kb", m_fragmentConfig.fragmentSize / 1024);
+    int64_t maxReassemblyMB = _pt.get<int64_t>(
+        "p2p.max_reassembly_mb", m_fragmentConfig.maxReassemblyBytes / (1024 * 1024));
+    if (fragmentSizeKB < 0 || maxReassemblyMB <= 0 ||
+        fragmentSizeKB * 1024 > maxReassemblyMB * 1024 * 1024)
+    {
+        BOOST_THROW_EXCEPTION(InvalidParameter() << errinfo_comment(
+                                  "initP2PConfig: invalid fragment_size_kb or max_reassembly_mb, "
+                                  "fragment_size_kb=" +
+                                  std::to_string(fragmentSizeKB) +
+                                  ", max_reassembly_mb=" + std::to_string(maxReassemblyMB)));
+    }
+    m_fragmentConfig.fragmentSize = fragmentSizeKB * 1024;
+    m_fragmentConfig.maxReassemblyBytes = maxReassemblyMB * 1024 * 1024;
+
+    bool compression = _pt.get<bool>("p2p.compression", false);
+    int64_t compressThresholdKB = _pt.get<int64_t>("p2p.compress_threshold_kb", 16);
+    int compressLevel = _pt.get<int>("p2p.compress_level", 3);
+    if (compressThresholdKB < 0 || compressLevel <= 0 || compressLevel > c_maxCompressLevel)
+    {
+        BOOST_THROW_EXCEPTION(InvalidParameter() << errinfo_comment(
+                                  "initP2PConfig: invalid compress_threshold_kb or "
+                                  "compress_level, compress_threshold_kb=" +
+                                  std::to_string(compressThresholdKB) +
+                                  ", compress_level=" + std::to_string(compressLevel)));
+    }
+    m_compression = compression;
+    m_compressThreshold = compressThresholdKB * 1024;
+    m_compressLevel = compressLevel;
+
+    int64_t unicastTimeout = _pt.get<int64_t>("p2p.unicast_timeout_ms", m_unicastTimeout);
+    if (unicastTimeout <= 0 || unicastTimeout > c_maxUnicastTimeout)
+    {
+        BOOST_THROW_EXCEPTION(InvalidParameter() << errinfo_comment(
+                                  "initP2PConfig: invalid unicast_timeout_ms, value=" +
+                                  std::to_string(unicastTimeout)));
+    }
+    m_unicastTimeout = unicastTimeout;
+    m_hedgeRequests = _pt.get<bool>("p2p.hedge_requests", false);
+
     m_smSSL = smSSL;
     m_listenIP = listenIP;
     m_listenPort = (uint16_t)listenPort;
@@ -189,7 +337,64 @@ void GatewayConfig::initP2PConfig(const boost::property_tree::ptree& _pt)
     GATEWAY_CONFIG_LOG(INFO) << LOG_DESC("initP2PConfig ok!") << LOG_KV("listenIP", listenIP)
                              << LOG_KV("listenPort", listenPort) << LOG_KV("smSSL", smSSL)
                              << LOG_KV("nodePath", m_nodePath)
-                             << LOG_KV("nodeFileName", m_nodeFileName);
+                             << LOG_KV("nodeFileName", m_nodeFileName)
+                             << LOG_KV("ioThreadCount", m_ioThreadCount)
+                             << LOG_KV("dispatchLanes", dispatchLanes)
+                             << LOG_KV("writeQueueHighWatermarkMB", highWatermarkMB)
+                             << LOG_KV("writeQueueLowWatermarkMB", lowWatermarkMB)
+                             << LOG_KV("writeQueueHighWatermarkMsgs", highWatermarkMsgs)
+                             << LOG_KV("writeQueueLowWatermarkMsgs", lowWatermarkMsgs)
+                             << LOG_KV("sslSessionCacheSize", m_sslSessionCacheSize)
+                             << LOG_KV("plaintextNetworks", plaintextNetworks)
+                             << LOG_KV("connectionsPerPeer", m_connectionsPerPeer)
+                             << LOG_KV("fragmentSizeKB", fragmentSizeKB)
+                             << LOG_KV("maxReassemblyMB", maxReassemblyMB)
+                             << LOG_KV("compression", m_compression)
+                             << LOG_KV("compressThresholdKB", compressThresholdKB)
+                             << LOG_KV("compressLevel", m_compressLevel)
+                             << LOG_KV("unicastTimeout", m_unicastTimeout)
+                             << LOG_KV("hedgeRequests", m_hedgeRequests);
+}
+
+void GatewayConfig::parseDispatchLanes(
+    std::string const& _value, DispatchLanes::Config& _config)
+{
+    std::vector<std::string> lanes;
+    boost::split(lanes, _value, boost::is_any_of(","), boost::token_compress_on);
+    for (auto& lane : lanes)
+    {
+        boost::trim(lane);
+        if (lane.empty())
+        {
+            continue;
+        }
+        // lane:threads:queue_limit
+        std::vector<std::string> fields;
+        boost::split(fields, lane, boost::is_any_of(":"));
+        auto index = fields.size() == 3 ? DispatchLanes::lane(boost::trim_copy(fields[0])) :
+                                          DispatchLane::Count;
+        if (index == DispatchLane::Count)
+        {
+            BOOST_THROW_EXCEPTION(InvalidParameter() << errinfo_comment(
+                                      "initP2PConfig: invalid dispatch_lanes, lane=" + lane));
+        }
+        int64_t threads = -1;
+        int64_t queueLimit = -1;
+        try
+        {
+            threads = boost::lexical_cast<int64_t>(boost::trim_copy(fields[1]));
+            queueLimit = boost::lexical_cast<int64_t>(boost::trim_copy(fields[2]));
+        }
+        catch (boost::bad_lexical_cast const&)
+        {
+        }
+        if (threads < 0 || threads > c_maxDispatchThreads || queueLimit < 0)
+        {
+            BOOST_THROW_EXCEPTION(InvalidParameter() << errinfo_comment(
+                                      "initP2PConfig: invalid dispatch_lanes, lane=" + lane));
+        }
+        _config[(size_t)index] = DispatchLaneConfig{(size_t)threads, (size_t)queueLimit};
+    }
 }
 
 // load p2p connected peers
@@ -6,6 +6,10 @@
 #pragma once
 #include <bcos-gateway/Common.h>
 #include <bcos-gateway/libnetwork/Common.h>
+#include <bcos-gateway/libnetwork/DispatchLanes.h>
+#include <bcos-gateway/libnetwork/MessageFragment.h>
+#include <bcos-gateway/libnetwork/PlaintextHandshake.h>
+#include <bcos-gateway/libnetwork/WriteQueue.h>
 #include <boost/algorithm/string.hpp>
 #include <boost/property_tree/ini_parser.hpp>
 #include <boost/property_tree/ptree.hpp>
@@ -62,6 +66,8 @@ public:
     bool isValidPort(int port);
     void hostAndPort2Endpoint(const std::string& _host, NodeIPEndpoint& _endpoint);
     void parseConnectedJson(const std::string& _json, std::set<NodeIPEndpoint>& _nodeIPEndpointSet);
+    // parse the lanes configured by lane:threads:queue_limit separated by comma into _config
+    void parseDispatchLanes(std::string const& _value, DispatchLanes::Config& _config);
     // loads p2p configuration items from the configuration file
     void initP2PConfig(const boost::property_tree::ptree& _pt);
     // loads ca configuration items from the configuration file
@@ -77,6 +83,18 @@ public:
     std::string listenIP() const { return m_listenIP; }
     uint16_t listenPort() const { return m_listenPort; }
     uint32_t threadPoolSize() { return m_threadPoolSize; }
+    uint32_t ioThreadCount() const { return m_ioThreadCount; }
+    DispatchLanes::Config const& dispatchLanes() const { return m_dispatchLanes; }
+    WriteQueueWatermark const& writeQueueWatermark() const { return m_writeQueueWatermark; }
+    uint32_t sslSessionCacheSize() const { return m_sslSessionCacheSize; }
+    std::vector<std::string> const& plaintextNetworks() const { return m_plaintextNetworks; }
+    uint32_t connectionsPerPeer() const { return m_connectionsPerPeer; }
+    MessageFragmentConfig const& fragmentConfig() const { return m_fragmentConfig; }
+    bool compression() const { return m_compression; }
+    size_t compressThreshold() const { return m_compressThreshold; }
+    int compressLevel() const { return m_compressLevel; }
+    uint32_t unicastTimeout() const { return m_unicastTimeout; }
+    bool hedgeRequests() const { return m_hedgeRequests; }
     bool smSSL() const { return m_smSSL; }
 
     CertConfig certConfig() const { return m_certConfig; }
@@ -92,6 +110,33 @@ private:
     uint16_t m_listenPort;
     // threadPool size
     uint32_t m_threadPoolSize{16};
+    // the number of io threads that drive the sessions io
+    uint32_t m_ioThreadCount{1};
+    // the threads and the queue limit of the lanes dispatching the messages received
+    DispatchLanes::Config m_dispatchLanes = DispatchLanes::defaultConfig();
+    const int64_t c_maxDispatchThreads = 256;
+    // the watermarks of the write queue of every session
+    WriteQueueWatermark m_writeQueueWatermark;
+    // the number of the cached ssl sessions to resume, 0 means disable the session resumption
+    uint32_t m_sslSessionCacheSize{1024};
+    // the trusted networks connected without tls, in cidr notation
+    std::vector<std::string> m_plaintextNetworks;
+    // the number of the parallel sessions with every peer
+    uint32_t m_connectionsPerPeer{1};
+    const uint32_t c_maxConnectionsPerPeer = 16;
+    // the fragment size of the large messages and the reassembly memory limit of the gateway
+    MessageFragmentConfig m_fragmentConfig;
+    // compress the payloads larger than m_compressThreshold sent to the peers supporting it
+    bool m_compression{false};
+    size_t m_compressThreshold{16 * 1024};
+    // the zstd compression level
+    int m_compressLevel{3};
+    const int c_maxCompressLevel = 19;
+    // the deadline of the unicast messages in milliseconds, including the retries
+    uint32_t m_unicastTimeout{10000};
+    const int64_t c_maxUnicastTimeout = 24 * 3600 * 1000;
+    // hedge the unicast messages after the p95 latency of the gateway sent to
+    bool m_hedgeRequests{false};
     // p2p connected nodes host list
     std::set<NodeIPEndpoint> m_connectedNodes;
     // cert config for ssl connection
@@ -261,6 +261,7 @@ std::shared_ptr<Gateway> GatewayFactory::buildGateway(GatewayConfig::Ptr _config
         // init ASIOInterface
         auto asioInterface = std::make_shared<ASIOInterface>();
         asioInterface->setIOService(std::make_shared<ba::io_service>());
+        asioInterface->setIOServicePool(std::make_shared<IOServicePool>(_config->ioThreadCount()));
         asioInterface->setSSLContext(sslContext);
         asioInterface->setType(ASIOInterface::ASIO_TYPE::SSL);
 
@@ -268,6 +269,8 @@ std::shared_ptr<Gateway> GatewayFactory::buildGateway(GatewayConfig::Ptr _config
         auto messageFactory = std::make_shared<P2PMessageFactory>();
         // Session Factory
         auto sessionFactory = std::make_shared<SessionFactory>();
+        sessionFactory->setWriteQueueWatermark(_config->writeQueueWatermark());
+        sessionFactory->setFragmentConfig(_config->fragmentConfig());
         // KeyFactory
         auto keyFactory = std::make_shared<bcos::crypto::KeyFactoryImpl>();
 
@@ -276,12 +279,33 @@ std::shared_ptr<Gateway> GatewayFactory::buildGateway(GatewayConfig::Ptr _config
 
         host->setHostPort(_config->listenIP(), _config->listenPort());
         host->setThreadPool(std::make_shared<ThreadPool>("P2P", _config->threadPoolSize()));
+        host->setDispatchLanes(std::make_shared<DispatchLanes>(_config->dispatchLanes()));
         host->setSSLContextPubHandler(m_sslContextPubHandler);
+        if (_config->sslSessionCacheSize() > 0)
+        {
+            auto sslSessionCache =
+                std::make_shared<SSLSessionCache>(_config->sslSessionCacheSize());
+            sslSessionCache->attach(sslContext->native_handle());
+            host->setSSLSessionCache(sslSessionCache);
+        }
+        // the ssl context still provides the certificate and the key to authenticate the
+        // plaintext connections
+        if (!_config->plaintextNetworks().empty())
+        {
+            host->setPlaintextNetworks(
+                std::make_shared<PlaintextNetworks>(_config->plaintextNetworks()));
+        }
 
         // init Service
         auto service = std::make_shared<Service>();
         service->setHost(host);
         service->setStaticNodes(_config->connectedNodes());
+        service->setConnectionsPerPeer(_config->connectionsPerPeer());
+        if (_config->compression())
+        {
+            service->setMessageCompressor(std::make_shared<MessageCompressor>(
+                _config->compressThreshold(), _config->compressLevel()));
+        }
 
         GATEWAY_FACTORY_LOG(INFO) << LOG_DESC("GatewayFactory::init")
                                   << LOG_KV("myself pub id", pubHex)
@@ -306,6 +330,8 @@ std::shared_ptr<Gateway> GatewayFactory::buildGateway(GatewayConfig::Ptr _config
         }
         // init Gateway
         auto gateway = std::make_shared<Gateway>(m_chainID, service, gatewayNodeManager, amop);
+        gateway->setUnicastTimeout(_config->unicastTimeout());
+        gateway->setHedgeRequests(_config->hedgeRequests());
         auto weakptrGatewayNodeManager = std::weak_ptr<GatewayNodeManager>(gatewayNodeManager);
         service->setGateway(std::weak_ptr<Gateway>(gateway));
         // register disconnect handler
@@ -356,11 +356,20 @@ void AMOPImpl::asyncSendMessageByTopic(const std::string& _topic, bcos::bytesCon
 
                 return;
             }
-            auto choosedNodeID = randomChoose(m_nodeIDs);
+            // the congested nodes are chosen at last
+            std::vector<P2pID> candidates;
+            for (auto const& nodeID : m_nodeIDs)
+            {
+                if (!m_network->isCongested(nodeID))
+                {
+                    candidates.push_back(nodeID);
+                }
+            }
+            auto choosedNodeID = randomChoose(candidates.empty() ? m_nodeIDs : candidates);
             AMOP_LOG(INFO) << LOG_DESC("asyncSendMessageByTopic")
                            << LOG_KV("choosedNodeID", choosedNodeID);
             // erase in case of select the same node when retry
-            m_nodeIDs.erase(m_nodeIDs.begin());
+            m_nodeIDs.erase(std::find(m_nodeIDs.begin(), m_nodeIDs.end(), choosedNodeID));
             // try to send message to node
             Options option(0);
             auto self = shared_from_this();
@@ -500,7 +509,7 @@ void AMOPImpl::dispatcherAMOPMessage(
     {
         return;
     }
-    auto amopMessage = m_messageFactory->buildMessage(ref(*_message->payload()));
+    auto amopMessage = m_messageFactory->buildMessage(_message->payloadRef());
     auto amopMsgType = amopMessage->type();
     auto fromNodeID = _session->p2pID();
     switch (amopMsgType)
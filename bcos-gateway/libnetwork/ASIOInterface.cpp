@@ -21,8 +21,12 @@ void ASIOInterface::asyncResolveConnect(std::shared_ptr<SocketFace> socket, Hand
         [=](const boost::system::error_code& ec, bi::tcp::resolver::results_type results) {
             if (!ec)
             {
-                // results is a iterator, but only use first endpoint.
-                socket->ref().async_connect(results->endpoint(), handler);
+                // results is a iterator, but only use first endpoint. connect in the io_service
+                // of the socket, where the connect timer closes it
+                auto endpoint = results->endpoint();
+                ba::post(socket->ref().get_executor(), [socket, endpoint, handler]() {
+                    socket->ref().async_connect(endpoint, handler);
+                });
                 ASIO_LOG(INFO) << LOG_DESC("asyncResolveConnect")
                                << LOG_KV("endpoint", results->endpoint());
             }
@@ -34,3 +38,67 @@ void ASIOInterface::asyncResolveConnect(std::shared_ptr<SocketFace> socket, Hand
             }
         });
 }
+
+std::vector<boost::asio::const_buffer> ASIOInterface::writeBuffers(int _type,
+    std::vector<boost::asio::const_buffer> const& _buffers,
+    std::vector<std::shared_ptr<bytes>>& _packedBuffers)
+{
+    if (_type != SSL || _buffers.size() <= 1)
+    {
+        return _buffers;
+    }
+    std::vector<boost::asio::const_buffer> writeBuffers;
+    std::shared_ptr<bytes> packed;
+    for (auto const& buffer : _buffers)
+    {
+        if (buffer.size() >= c_packThreshold)
+        {
+            packed = nullptr;
+            writeBuffers.push_back(buffer);
+            continue;
+        }
+        if (!packed || packed->size() + buffer.size() > c_maxTLSRecordSize)
+        {
+            packed = std::make_shared<bytes>();
+            packed->reserve(c_maxTLSRecordSize);
+            _packedBuffers.push_back(packed);
+            writeBuffers.push_back(boost::asio::const_buffer());
+        }
+        auto data = static_cast<const byte*>(buffer.data());
+        packed->insert(packed->end(), data, data + buffer.size());
+        writeBuffers.back() = boost::asio::buffer(*packed);
+    }
+    return writeBuffers;
+}
+
+void ASIOInterface::asyncWrite(std::shared_ptr<SocketFace> socket,
+    std::vector<boost::asio::const_buffer> const& buffers, ReadWriteHandler handler)
+{
+    auto type = socketType(socket);
+    auto packedBuffers = std::make_shared<std::vector<std::shared_ptr<bytes>>>();
+    auto writeBuffers = ASIOInterface::writeBuffers(type, buffers, *packedBuffers);
+
+    socketPost(socket, [type, socket, writeBuffers, packedBuffers, handler]() {
+        if (socket->isConnected())
+        {
+            // the packedBuffers must be alive until the write completed
+            auto writeHandler = [packedBuffers, handler](
+                                    const boost::system::error_code _error, std::size_t _size) {
+                handler(_error, _size);
+            };
+            switch (type)
+            {
+            case TCP_ONLY:
+            {
+                ba::async_write(socket->ref(), writeBuffers, writeHandler);
+                break;
+            }
+            case SSL:
+            {
+                ba::async_write(socket->sslref(), writeBuffers, writeHandler);
+                break;
+            }
+            }
+        }
+    });
+}
@@ -6,6 +6,7 @@
  * @date 2018-09-13
  */
 #pragma once
+#include <bcos-gateway/libnetwork/IOServicePool.h>
 #include <bcos-gateway/libnetwork/Socket.h>
 #include <boost/asio.hpp>
 #include <boost/asio/ip/tcp.hpp>
@@ -42,6 +43,16 @@ public:
     virtual void setIOService(std::shared_ptr<ba::io_service> ioService)
     {
         m_ioService = ioService;
+        m_timerWheel = std::make_shared<TimerWheel>(ioService);
+        m_idleSweeper = std::make_shared<IdleSweeper>(ioService);
+    }
+
+    virtual IOServicePool::Ptr ioServicePool() { return m_ioServicePool; }
+    /// the sessions sockets are spread across the io_services of the pool, the acceptor, resolver
+    /// and timers still work on the ioService
+    virtual void setIOServicePool(IOServicePool::Ptr _ioServicePool)
+    {
+        m_ioServicePool = _ioServicePool;
     }
 
     virtual std::shared_ptr<ba::ssl::context> sslContext() { return m_sslContext; }
@@ -58,8 +69,9 @@ public:
 
     virtual std::shared_ptr<SocketFace> newSocket(NodeIPEndpoint nodeIPEndpoint = NodeIPEndpoint())
     {
+        auto ioService = m_ioServicePool ? m_ioServicePool->getIOService() : m_ioService;
         std::shared_ptr<SocketFace> m_socket =
-            std::make_shared<Socket>(*m_ioService, *m_sslContext, nodeIPEndpoint);
+            std::make_shared<Socket>(*ioService, *m_sslContext, nodeIPEndpoint);
         return m_socket;
     }
 
@@ -73,6 +85,10 @@ public:
             *m_ioService, bi::tcp::endpoint(bi::make_address(listenHost), listenPort));
         boost::asio::socket_base::reuse_address optionReuseAddress(true);
         m_acceptor->set_option(optionReuseAddress);
+        if (m_ioServicePool)
+        {
+            m_ioServicePool->start();
+        }
     }
 
     virtual void run() { m_ioService->run(); }
@@ -87,6 +103,18 @@ public:
         }
 
         m_ioService->stop();
+        if (m_timerWheel)
+        {
+            m_timerWheel->stop();
+        }
+        if (m_idleSweeper)
+        {
+            m_idleSweeper->stop();
+        }
+        if (m_ioServicePool)
+        {
+            m_ioServicePool->stop();
+        }
     }
 
     virtual void reset()
@@ -108,8 +136,9 @@ public:
     virtual void asyncWrite(std::shared_ptr<SocketFace> socket,
         boost::asio::mutable_buffers_1 buffers, ReadWriteHandler handler)
     {
-        auto type = m_type;
-        m_ioService->post([type, socket, buffers, handler]() {
+        auto type = socketType(socket);
+        // all the operations of the socket should be called in the io_service the socket bound to
+        socketPost(socket, [type, socket, buffers, handler]() {
             if (socket->isConnected())
             {
                 switch (type)
@@ -129,10 +158,21 @@ public:
         });
     }
 
+    /// write all the buffers with one gather-write, for ssl the small buffers are packed together
+    /// so that they can be sent in full-size tls records
+    virtual void asyncWrite(std::shared_ptr<SocketFace> socket,
+        std::vector<boost::asio::const_buffer> const& buffers, ReadWriteHandler handler);
+    /// the buffers written by asyncWrite to the socket of _type: for ssl the consecutive buffers
+    /// smaller than c_packThreshold are copied into the _packedBuffers of one tls record at most,
+    /// the others are referenced as is
+    static std::vector<boost::asio::const_buffer> writeBuffers(int _type,
+        std::vector<boost::asio::const_buffer> const& _buffers,
+        std::vector<std::shared_ptr<bytes>>& _packedBuffers);
+
     virtual void asyncRead(std::shared_ptr<SocketFace> socket,
         boost::asio::mutable_buffers_1 buffers, ReadWriteHandler handler)
     {
-        switch (m_type)
+        switch (socketType(socket))
         {
         case TCP_ONLY:
         {
@@ -150,7 +190,7 @@ public:
     virtual void asyncReadSome(std::shared_ptr<SocketFace> socket,
         boost::asio::mutable_buffers_1 buffers, ReadWriteHandler handler)
     {
-        switch (m_type)
+        switch (socketType(socket))
         {
         case TCP_ONLY:
         {
@@ -187,13 +227,64 @@ public:
 
     virtual void strandPost(Base_Handler handler) { m_strand->post(handler); }
 
+    /// post the handler to the io_service the socket bound to
+    virtual void socketPost(std::shared_ptr<SocketFace> socket, Base_Handler handler)
+    {
+        ba::post(socket->ref().get_executor(), handler);
+    }
+
+    /// the timer wheel driven by the io_service the socket bound to
+    virtual TimerWheel::Ptr timerWheel(std::shared_ptr<SocketFace> socket)
+    {
+        if (m_ioServicePool)
+        {
+            auto timerWheel = m_ioServicePool->timerWheel(socket->ref().get_executor().context());
+            if (timerWheel)
+            {
+                return timerWheel;
+            }
+        }
+        return m_timerWheel;
+    }
+
+    /// the idle sweeper driven by the io_service the socket bound to
+    virtual IdleSweeper::Ptr idleSweeper(std::shared_ptr<SocketFace> socket)
+    {
+        if (m_ioServicePool)
+        {
+            auto idleSweeper = m_ioServicePool->idleSweeper(socket->ref().get_executor().context());
+            if (idleSweeper)
+            {
+                return idleSweeper;
+            }
+        }
+        return m_idleSweeper;
+    }
+
 protected:
+    // the plaintext sockets of the trusted networks bypass the ssl stream
+    int socketType(std::shared_ptr<SocketFace> const& socket) const
+    {
+        return socket->plaintext() ? TCP_ONLY : m_type;
+    }
+
     std::shared_ptr<ba::io_service> m_ioService;
+    IOServicePool::Ptr m_ioServicePool;
+    // the timer wheel of m_ioService
+    TimerWheel::Ptr m_timerWheel;
+    // the idle sweeper of m_ioService
+    IdleSweeper::Ptr m_idleSweeper;
     std::shared_ptr<ba::io_service::strand> m_strand;
     std::shared_ptr<bi::tcp::acceptor> m_acceptor;
     std::shared_ptr<bi::tcp::resolver> m_resolver;
     std::shared_ptr<ba::ssl::context> m_sslContext;
     int m_type = 0;
+
+public:
+    // the ssl stream encrypts at most one buffer each write_some, the small buffers are packed
+    // into full records before write, the buffers near the record size are not worth the copy
+    constexpr static size_t c_maxTLSRecordSize = 16 * 1024;
+    constexpr static size_t c_packThreshold = 4 * 1024;
 };
 }  // namespace gateway
 }  // namespace bcos
@@ -25,6 +25,7 @@ namespace bi = boost::asio::ip;
 #define HOST_LOG(LEVEL) BCOS_LOG(LEVEL) << "[NETWORK][Host]"
 #define SESSION_LOG(LEVEL) BCOS_LOG(LEVEL) << "[SESSION][Session]"
 #define ASIO_LOG(LEVEL) BCOS_LOG(LEVEL) << "[ASIO][ASIO]"
+#define EXECUTOR_LOG(LEVEL) BCOS_LOG(LEVEL) << "[NETWORK][Executor]"
 
 namespace bcos
 {
@@ -33,6 +34,10 @@ namespace gateway
 enum MessageExtFieldFlag
 {
     Response = 0x0001,
+    Fragment = 0x0002,
+    Compress = 0x0004,
+    CompactOptions = 0x0008,
+    Deadline = 0x0010,
 };
 
 enum MessageDecodeStatus
@@ -70,9 +75,41 @@ enum P2PExceptionType
     ConnectError,
     DuplicateSession,
     NotInWhitelist,
+    SessionCongested,
     ALL,
 };
 
+///< the priority classes of the messages waiting to be sent, the smaller the higher
+enum class MessagePriority : int8_t
+{
+    Auto = -1,  ///< chosen by the packet type and the size of the message
+    Control = 0,
+    Consensus,
+    Response,  ///< the responses not large enough to be bulk, weighted to not starve the others
+    Normal,
+    AMOP,
+    Bulk,
+    Count,
+};
+
+/// the version of the p2p protocol, the frames are encoded in the version negotiated by the
+/// handshake of the session, the legacy gateways(without the handshake) use version 0
+const uint16_t c_legacyProtocolVersion = 0;
+const uint16_t c_minProtocolVersion = 0;
+const uint16_t c_maxProtocolVersion = 2;
+/// the options of the frames sent are encoded in the compact version(flagged by
+/// MessageExtFieldFlag::CompactOptions) since this version
+const uint16_t c_compactOptionsVersion = 2;
+
+///< the features negotiated by the handshake, used only if both sides support
+enum P2PFeature : uint32_t
+{
+    Compression = 0x0001,      ///< the payload compressed by zstd
+    Fragmentation = 0x0002,    ///< the large frames sent in fragments
+    HeartbeatEcho = 0x0004,    ///< the heartbeat echoes the send time of the peer's heartbeat
+    RequestDeadline = 0x0008,  ///< the request carries its remaining time, dropped if expired
+};
+
 //
 using P2pID = std::string;
 using P2pIDs = std::set<std::string>;
@@ -80,7 +117,10 @@ struct Options
 {
     Options() {}
     Options(uint32_t _timeout) : timeout(_timeout) {}
+    Options(uint32_t _timeout, MessagePriority _priority) : timeout(_timeout), priority(_priority)
+    {}
     uint32_t timeout = 0;  ///< The timeout value of async function, in milliseconds.
+    MessagePriority priority = MessagePriority::Auto;  ///< The priority to send the message.
 };
 
 class NetworkException : public std::exception
@@ -0,0 +1,130 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: the lanes dispatching the received messages by packet type
+ * @file DispatchLanes.cpp
+ */
+#include <bcos-gateway/libnetwork/Common.h>
+#include <bcos-gateway/libnetwork/DispatchLanes.h>
+#include <sstream>
+
+using namespace bcos;
+using namespace bcos::gateway;
+
+namespace
+{
+const std::array<std::string, DispatchLanes::c_laneCount> c_laneNames = {
+    "control", "p2p", "broadcast", "amop"};
+}  // namespace
+
+DispatchLanes::Config DispatchLanes::defaultConfig()
+{
+    Config config;
+    config[(size_t)DispatchLane::Control] = DispatchLaneConfig{2, 0};
+    config[(size_t)DispatchLane::P2P] = DispatchLaneConfig{16, 100000};
+    config[(size_t)DispatchLane::Broadcast] = DispatchLaneConfig{4, 100000};
+    config[(size_t)DispatchLane::AMOP] = DispatchLaneConfig{4, 10000};
+    return config;
+}
+
+std::string const& DispatchLanes::name(DispatchLane _lane)
+{
+    static const std::string unknown = "unknown";
+    return _lane < DispatchLane::Count ? c_laneNames[(size_t)_lane] : unknown;
+}
+
+DispatchLane DispatchLanes::lane(std::string const& _name)
+{
+    for (size_t i = 0; i < c_laneCount; ++i)
+    {
+        if (c_laneNames[i] == _name)
+        {
+            return (DispatchLane)i;
+        }
+    }
+    return DispatchLane::Count;
+}
+
+DispatchLane DispatchLanes::classify(int16_t _packetType)
+{
+    switch (_packetType)
+    {
+    case MessageType::Handshake:
+    case MessageType::Heartbeat:
+    case MessageType::RequestNodeIDs:
+    case MessageType::ResponseNodeIDs:
+        return DispatchLane::Control;
+    case MessageType::BroadcastMessage:
+        return DispatchLane::Broadcast;
+    case MessageType::AMOPMessageType:
+        return DispatchLane::AMOP;
+    default:
+        return DispatchLane::P2P;
+    }
+}
+
+DispatchLanes::DispatchLanes(Config const& _config) : m_config(_config)
+{
+    for (size_t i = 0; i < c_laneCount; ++i)
+    {
+        m_dropped[i] = 0;
+        if (m_config[i].threads > 0)
+        {
+            m_executors[i] = std::make_shared<OrderedExecutor>(
+                "dispatch_" + c_laneNames[i], m_config[i].threads);
+        }
+    }
+}
+
+void DispatchLanes::start()
+{
+    for (auto const& executor : m_executors)
+    {
+        if (executor)
+        {
+            executor->start();
+        }
+    }
+}
+
+void DispatchLanes::stop()
+{
+    for (auto const& executor : m_executors)
+    {
+        if (executor)
+        {
+            executor->stop();
+        }
+    }
+}
+
+std::string DispatchLanes::toString()
+{
+    std::stringstream stream;
+    for (size_t i = 0; i < c_laneCount; ++i)
+    {
+        stream << (i == 0 ? "" : ",") << c_laneNames[i] << ":{";
+        if (m_executors[i])
+        {
+            stream << m_executors[i]->toString();
+        }
+        else
+        {
+            stream << "threadPool";
+        }
+        stream << ",dropped:" << m_dropped[i] << "}";
+    }
+    return stream.str();
+}
@@ -0,0 +1,91 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: the lanes dispatching the received messages by packet type
+ * @file DispatchLanes.h
+ */
+#pragma once
+#include <bcos-gateway/libnetwork/OrderedExecutor.h>
+#include <array>
+
+namespace bcos
+{
+namespace gateway
+{
+///< the lanes of the received messages, chosen by the packet type
+enum class DispatchLane : uint8_t
+{
+    Control = 0,  ///< Handshake, Heartbeat, RequestNodeIDs, ResponseNodeIDs
+    P2P,          ///< PeerToPeerMessage and the types without their own lane
+    Broadcast,    ///< BroadcastMessage
+    AMOP,         ///< AMOPMessageType
+    Count,
+};
+
+struct DispatchLaneConfig
+{
+    // the threads of the lane, 0 means dispatched by the thread pool of the host without order
+    size_t threads = 0;
+    // the max messages of every session waiting in the lane, the messages over it are dropped,
+    // 0 means no limit
+    size_t queueLimit = 0;
+};
+
+/**
+ * @brief: every lane has its own OrderedExecutor, so the control messages never wait behind the
+ * data messages and a burst of one packet type only delays its own lane. every session has one
+ * queue in each lane, the messages of the same session and lane are handled in the received order
+ */
+class DispatchLanes
+{
+public:
+    using Ptr = std::shared_ptr<DispatchLanes>;
+    const static size_t c_laneCount = (size_t)DispatchLane::Count;
+    using Config = std::array<DispatchLaneConfig, c_laneCount>;
+
+    static Config defaultConfig();
+    static std::string const& name(DispatchLane _lane);
+    /// the lane of the name, DispatchLane::Count if unknown
+    static DispatchLane lane(std::string const& _name);
+    static DispatchLane classify(int16_t _packetType);
+
+    explicit DispatchLanes(Config const& _config = defaultConfig());
+    virtual ~DispatchLanes() { stop(); }
+
+    virtual void start();
+    virtual void stop();
+
+    Config const& config() const { return m_config; }
+    /// the executor of the lane, nullptr if the lane is dispatched by the thread pool
+    OrderedExecutor::Ptr const& executor(DispatchLane _lane) const
+    {
+        return m_executors[(size_t)_lane];
+    }
+    size_t queueLimit(DispatchLane _lane) const { return m_config[(size_t)_lane].queueLimit; }
+
+    /// the message of the lane dropped for exceeding the queue limit
+    void onDropped(DispatchLane _lane) { m_dropped[(size_t)_lane]++; }
+    size_t dropped(DispatchLane _lane) const { return m_dropped[(size_t)_lane]; }
+
+    /// the latency and the dropped messages of every lane
+    std::string toString();
+
+private:
+    Config m_config;
+    std::array<OrderedExecutor::Ptr, c_laneCount> m_executors;
+    std::array<std::atomic<size_t>, c_laneCount> m_dropped;
+};
+}  // namespace gateway
+}  // namespace bcos
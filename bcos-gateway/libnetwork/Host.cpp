@@ -76,12 +76,15 @@ void Host::startAccept(boost::system::error_code boost_error)
                 /// if the connected peer over the limitation, drop socket
                 socket->setNodeIPEndpoint(endpoint);
                 HOST_LOG(INFO) << LOG_DESC("P2P Recv Connect, From=") << endpoint;
-                /// register ssl callback to get the NodeID of peers
-                std::shared_ptr<std::string> endpointPublicKey = std::make_shared<std::string>();
-                m_asioInterface->setVerifyCallback(socket, newVerifyCallback(endpointPublicKey));
-                m_asioInterface->asyncHandshake(socket, ba::ssl::stream_base::server,
-                    boost::bind(&Host::handshakeServer, shared_from_this(), ba::placeholders::error,
-                        endpointPublicKey, socket));
+                /// the peers of the trusted networks may start the plaintext handshake
+                if (m_plaintextNetworks && m_plaintextNetworks->contains(endpoint.address()))
+                {
+                    acceptPlaintextOrSSL(socket);
+                }
+                else
+                {
+                    startSSLServerHandshake(socket);
+                }
 
                 startAccept();
             },
@@ -89,6 +92,109 @@ void Host::startAccept(boost::system::error_code boost_error)
     }
 }
 
+void Host::startSSLServerHandshake(std::shared_ptr<SocketFace> socket)
+{
+    /// register ssl callback to get the NodeID of peers
+    std::shared_ptr<std::string> endpointPublicKey = std::make_shared<std::string>();
+    m_asioInterface->setVerifyCallback(socket, newVerifyCallback(endpointPublicKey));
+    m_asioInterface->asyncHandshake(socket, ba::ssl::stream_base::server,
+        boost::bind(&Host::handshakeServer, shared_from_this(), ba::placeholders::error,
+            endpointPublicKey, socket, SSLSessionCache::steadyTimeUs()));
+}
+
+/**
+ * @brief: the peer of the trusted networks starts either the plaintext handshake or the ssl
+ *         handshake, peek the first byte to tell the plaintext hello from the tls client hello
+ */
+void Host::acceptPlaintextOrSSL(std::shared_ptr<SocketFace> socket)
+{
+    auto firstByte = std::make_shared<byte>(0);
+    auto host = std::weak_ptr<Host>(shared_from_this());
+    socket->ref().async_receive(ba::buffer(firstByte.get(), 1), bi::tcp::socket::message_peek,
+        [host, socket, firstByte](boost::system::error_code const& _error, std::size_t _size) {
+            auto hostPtr = host.lock();
+            if (!hostPtr || _error || _size == 0)
+            {
+                HOST_LOG(WARNING) << LOG_DESC("acceptPlaintextOrSSL: receive failed")
+                                  << LOG_KV("message", _error.message())
+                                  << LOG_KV("endpoint", socket->nodeIPEndpoint());
+                socket->close();
+                return;
+            }
+            if (PlaintextHandshake::isHello(*firstByte))
+            {
+                hostPtr->startPlaintextHandshake(socket, false, nullptr, socket->nodeIPEndpoint(),
+                    std::shared_ptr<boost::asio::deadline_timer>());
+                return;
+            }
+            hostPtr->startSSLServerHandshake(socket);
+        });
+}
+
+void Host::startPlaintextHandshake(std::shared_ptr<SocketFace> socket, bool _client,
+    std::function<void(NetworkException, P2PInfo const&, std::shared_ptr<SessionFace>)> callback,
+    NodeIPEndpoint _nodeIPEndpoint, std::shared_ptr<boost::asio::deadline_timer> timerPtr)
+{
+    socket->setPlaintext(true);
+    auto handshake =
+        std::make_shared<PlaintextHandshake>(socket, m_asioInterface->sslContext(), _client);
+    handshake->start(boost::bind(&Host::handshakePlaintext, shared_from_this(),
+        boost::placeholders::_1, boost::placeholders::_2, socket, _client, callback,
+        _nodeIPEndpoint, timerPtr));
+}
+
+/**
+ * @brief: called after the plaintext handshake, the node info is obtained from the verified
+ *         certificate of the peer in the same format with the ssl verify callback
+ */
+void Host::handshakePlaintext(const boost::system::error_code& error,
+    std::shared_ptr<X509> peerCert, std::shared_ptr<SocketFace> socket, bool _client,
+    std::function<void(NetworkException, P2PInfo const&, std::shared_ptr<SessionFace>)> callback,
+    NodeIPEndpoint _nodeIPEndpoint, std::shared_ptr<boost::asio::deadline_timer> timerPtr)
+{
+    if (_client)
+    {
+        timerPtr->cancel();
+        erasePendingConns(_nodeIPEndpoint);
+    }
+    std::string nodeInfo;
+    if (error || !certNodeInfo(peerCert.get(), nodeInfo))
+    {
+        HOST_LOG(WARNING) << LOG_DESC("handshakePlaintext failed")
+                          << LOG_KV("endpoint", _nodeIPEndpoint) << LOG_KV("client", _client)
+                          << LOG_KV("errorValue", error.value())
+                          << LOG_KV("message", error.message());
+        socket->close();
+        return;
+    }
+    if (m_run)
+    {
+        P2PInfo info;
+        obtainNodeInfo(info, nodeInfo);
+        HOST_LOG(INFO) << LOG_DESC("handshakePlaintext succ") << LOG_KV("endpoint", _nodeIPEndpoint)
+                       << LOG_KV("client", _client) << LOG_KV("nodeid", info.p2pID);
+        startPeerSession(info, socket, _client ? callback : m_connectionHandler);
+    }
+}
+
+/// the node info of the node certificate: {nodeID}#{issuer-name}#{cert-name}
+bool Host::certNodeInfo(X509* cert, std::string& nodeInfo)
+{
+    if (!cert || !m_sslContextPubHandler(cert, nodeInfo))
+    {
+        return false;
+    }
+    const char* certName = X509_NAME_oneline(X509_get_subject_name(cert), NULL, 0);
+    const char* issuerName = X509_NAME_oneline(X509_get_issuer_name(cert), NULL, 0);
+    nodeInfo.append("#");
+    nodeInfo.append(issuerName);
+    nodeInfo.append("#");
+    nodeInfo.append(certName);
+    OPENSSL_free((void*)certName);
+    OPENSSL_free((void*)issuerName);
+    return true;
+}
+
 /**
  * @brief : functions called after openssl handshake,
  *          maily to get node id and verify whether the certificate has been
@@ -283,8 +389,22 @@ void Host::obtainNodeInfo(P2PInfo& info, std::string const& node_info)
  * @param socket: socket related to the endpoint of the connected client
  */
 void Host::handshakeServer(const boost::system::error_code& error,
-    std::shared_ptr<std::string> endpointPublicKey, std::shared_ptr<SocketFace> socket)
+    std::shared_ptr<std::string> endpointPublicKey, std::shared_ptr<SocketFace> socket,
+    uint64_t _handshakeStartTime)
 {
+    auto ssl = socket->sslref().native_handle();
+    bool resumed = (!error && SSL_session_reused(ssl));
+    if (m_sslSessionCache)
+    {
+        m_sslSessionCache->reportHandshake(
+            resumed, !error, SSLSessionCache::steadyTimeUs() - _handshakeStartTime);
+    }
+    // the certificate is not verified again by the resumed session, use the cached node info
+    if (resumed && !SSLSessionCache::resumedNodeInfo(ssl, *endpointPublicKey))
+    {
+        HOST_LOG(WARNING) << LOG_DESC("handshakeServer no node info of the resumed session")
+                          << LOG_KV("remote endpoint", socket->remoteEndpoint());
+    }
     if (error)
     {
         HOST_LOG(WARNING) << LOG_DESC("handshakeServer Handshake failed")
@@ -308,9 +428,14 @@ void Host::handshakeServer(const boost::system::error_code& error,
         std::string node_info(*endpointPublicKey);
         P2PInfo info;
         obtainNodeInfo(info, node_info);
+        if (m_sslSessionCache && !resumed)
+        {
+            m_sslSessionCache->onHandshakeSucceed(
+                ssl, socket->nodeIPEndpoint(), false, *endpointPublicKey);
+        }
         HOST_LOG(INFO) << LOG_DESC("handshakeServer succ")
                        << LOG_KV("remote endpoint", socket->remoteEndpoint())
-                       << LOG_KV("nodeid", info.p2pID);
+                       << LOG_KV("nodeid", info.p2pID) << LOG_KV("resumed", resumed);
         startPeerSession(info, socket, m_connectionHandler);
     }
 }
@@ -363,6 +488,10 @@ void Host::start()
     if (!haveNetwork())
     {
         m_run = true;
+        if (m_dispatchLanes)
+        {
+            m_dispatchLanes->start();
+        }
         m_asioInterface->init(m_listenHost, m_listenPort);
         m_hostThread = std::make_shared<std::thread>([&] {
             bcos::pthread_setThreadName("io_service");
@@ -401,6 +530,7 @@ void Host::asyncConnect(NodeIPEndpoint const& _nodeIPEndpoint,
     {
         return;
     }
+    auto connectStartTime = SSLSessionCache::steadyTimeUs();
     HOST_LOG(INFO) << LOG_DESC("Connecting to node") << LOG_KV("endpoint", _nodeIPEndpoint);
     {
         Guard l(x_pendingConns);
@@ -413,9 +543,10 @@ void Host::asyncConnect(NodeIPEndpoint const& _nodeIPEndpoint,
     }
 
     std::shared_ptr<SocketFace> socket = m_asioInterface->newSocket(_nodeIPEndpoint);
-    /// if async connect timeout, close the socket directly
+    /// if async connect timeout, close the socket directly, the timer runs in the io_service of
+    /// the socket, so the socket is never closed while connecting in another thread
     auto connect_timer = std::make_shared<boost::asio::deadline_timer>(
-        *(m_asioInterface->ioService()), boost::posix_time::milliseconds(m_connectTimeThre));
+        socket->ref().get_executor(), boost::posix_time::milliseconds(m_connectTimeThre));
     connect_timer->async_wait([=](const boost::system::error_code& error) {
         /// return when cancel has been called
         if (error == boost::asio::error::operation_aborted)
@@ -456,13 +587,27 @@ void Host::asyncConnect(NodeIPEndpoint const& _nodeIPEndpoint,
         else
         {
             insertPendingConns(_nodeIPEndpoint);
+            /// the peers of the trusted networks are connected in plaintext
+            if (m_plaintextNetworks &&
+                m_plaintextNetworks->contains(socket->remoteEndpoint().address()))
+            {
+                startPlaintextHandshake(socket, true, callback, _nodeIPEndpoint, connect_timer);
+                return;
+            }
             /// get the public key of the server during handshake
             std::shared_ptr<std::string> endpointPublicKey = std::make_shared<std::string>();
             m_asioInterface->setVerifyCallback(socket, newVerifyCallback(endpointPublicKey));
+            /// resume the last session with the node to skip the certificate verification
+            if (m_sslSessionCache)
+            {
+                m_sslSessionCache->setClientSession(
+                    socket->sslref().native_handle(), _nodeIPEndpoint);
+            }
             /// call handshakeClient after handshake succeed
             m_asioInterface->asyncHandshake(socket, ba::ssl::stream_base::client,
                 boost::bind(&Host::handshakeClient, shared_from_this(), ba::placeholders::error,
-                    socket, endpointPublicKey, callback, _nodeIPEndpoint, connect_timer));
+                    socket, endpointPublicKey, callback, _nodeIPEndpoint, connect_timer,
+                    connectStartTime, SSLSessionCache::steadyTimeUs()));
         }
     });
 }
@@ -478,10 +623,36 @@ void Host::asyncConnect(NodeIPEndpoint const& _nodeIPEndpoint,
 void Host::handshakeClient(const boost::system::error_code& error,
     std::shared_ptr<SocketFace> socket, std::shared_ptr<std::string> endpointPublicKey,
     std::function<void(NetworkException, P2PInfo const&, std::shared_ptr<SessionFace>)> callback,
-    NodeIPEndpoint _nodeIPEndpoint, std::shared_ptr<boost::asio::deadline_timer> timerPtr)
+    NodeIPEndpoint _nodeIPEndpoint, std::shared_ptr<boost::asio::deadline_timer> timerPtr,
+    uint64_t _connectStartTime, uint64_t _handshakeStartTime)
 {
     timerPtr->cancel();
     erasePendingConns(_nodeIPEndpoint);
+    auto ssl = socket->sslref().native_handle();
+    bool resumed = (!error && SSL_session_reused(ssl));
+    if (m_sslSessionCache)
+    {
+        auto now = SSLSessionCache::steadyTimeUs();
+        m_sslSessionCache->reportHandshake(resumed, !error, now - _handshakeStartTime);
+        if (error)
+        {
+            m_sslSessionCache->removeClientSession(_nodeIPEndpoint);
+        }
+        else
+        {
+            m_sslSessionCache->reportReconnect(now - _connectStartTime);
+        }
+    }
+    // the certificate is not verified again by the resumed session, use the cached node info
+    if (resumed && !SSLSessionCache::resumedNodeInfo(ssl, *endpointPublicKey))
+    {
+        HOST_LOG(WARNING) << LOG_DESC("handshakeClient no node info of the resumed session")
+                          << LOG_KV("endpoint", _nodeIPEndpoint);
+        if (m_sslSessionCache)
+        {
+            m_sslSessionCache->removeClientSession(_nodeIPEndpoint);
+        }
+    }
     if (error)
     {
         HOST_LOG(WARNING) << LOG_DESC("handshakeClient failed")
@@ -508,8 +679,13 @@ void Host::handshakeClient(const boost::system::error_code& error,
         std::string node_info(*endpointPublicKey);
         P2PInfo info;
         obtainNodeInfo(info, node_info);
+        if (m_sslSessionCache && !resumed)
+        {
+            m_sslSessionCache->onHandshakeSucceed(ssl, _nodeIPEndpoint, true, *endpointPublicKey);
+        }
         HOST_LOG(INFO) << LOG_DESC("handshakeClient succ")
-                       << LOG_KV("local endpoint", socket->localEndpoint());
+                       << LOG_KV("local endpoint", socket->localEndpoint())
+                       << LOG_KV("resumed", resumed);
         startPeerSession(info, socket, callback);
     }
 }
@@ -532,6 +708,10 @@ void Host::stop()
         m_hostThread->join();
     }
 
+    if (m_dispatchLanes)
+    {
+        m_dispatchLanes->stop();
+    }
     if (m_threadPool)
     {
         m_threadPool->stop();
@@ -8,6 +8,9 @@
 #include <bcos-framework/libutilities/ThreadPool.h>
 #include <bcos-gateway/libnetwork/Common.h>   // for  NodeIP...
 #include <bcos-gateway/libnetwork/Message.h>  // for Message
+#include <bcos-gateway/libnetwork/DispatchLanes.h>
+#include <bcos-gateway/libnetwork/PlaintextHandshake.h>
+#include <bcos-gateway/libnetwork/SSLSessionCache.h>
 #include <openssl/x509.h>
 #include <boost/asio/deadline_timer.hpp>  // for deadline_timer
 #include <boost/system/error_code.hpp>    // for error_code
@@ -100,11 +103,33 @@ public:
         m_threadPool = threadPool;
     }
 
+    /// dispatch the messages received by every session in order by the lanes of the packet types
+    virtual DispatchLanes::Ptr dispatchLanes() const { return m_dispatchLanes; }
+    virtual void setDispatchLanes(DispatchLanes::Ptr _dispatchLanes)
+    {
+        m_dispatchLanes = _dispatchLanes;
+    }
+
     virtual std::shared_ptr<ASIOInterface> asioInterface() const { return m_asioInterface; }
     virtual std::shared_ptr<SessionFactory> sessionFactory() const { return m_sessionFactory; }
     virtual MessageFactory::Ptr messageFactory() const { return m_messageFactory; }
     virtual P2PInfo p2pInfo();
 
+    virtual SSLSessionCache::Ptr sslSessionCache() const { return m_sslSessionCache; }
+    /// resume the ssl sessions of the reconnections, disabled if not set
+    virtual void setSSLSessionCache(SSLSessionCache::Ptr _sslSessionCache)
+    {
+        m_sslSessionCache = _sslSessionCache;
+    }
+
+    virtual PlaintextNetworks::Ptr plaintextNetworks() const { return m_plaintextNetworks; }
+    /// the connections with the peers of the trusted networks are not encrypted, the identity of
+    /// the peer is authenticated by the PlaintextHandshake
+    virtual void setPlaintextNetworks(PlaintextNetworks::Ptr _plaintextNetworks)
+    {
+        m_plaintextNetworks = _plaintextNetworks;
+    }
+
 private:
     /// obtain the common name from the subject:
     /// the subject format is: /CN=xx/O=xxx/OU=xxx/ commonly
@@ -125,7 +150,24 @@ private:
     /// RLPxHandshake to obtain informations(client version, caps, etc),start peer
     /// session and start accepting procedure repeatedly
     void handshakeServer(const boost::system::error_code& error,
-        std::shared_ptr<std::string> endpointPublicKey, std::shared_ptr<SocketFace> socket);
+        std::shared_ptr<std::string> endpointPublicKey, std::shared_ptr<SocketFace> socket,
+        uint64_t _handshakeStartTime);
+
+    /// the tls handshake of the accepted connection
+    void startSSLServerHandshake(std::shared_ptr<SocketFace> socket);
+    /// the accepted connection from the trusted networks, start the handshake chosen by the peer
+    void acceptPlaintextOrSSL(std::shared_ptr<SocketFace> socket);
+    void startPlaintextHandshake(std::shared_ptr<SocketFace> socket, bool _client,
+        std::function<void(NetworkException, P2PInfo const&, std::shared_ptr<SessionFace>)>
+            callback,
+        NodeIPEndpoint _nodeIPEndpoint, std::shared_ptr<boost::asio::deadline_timer> timerPtr);
+    void handshakePlaintext(const boost::system::error_code& error, std::shared_ptr<X509> peerCert,
+        std::shared_ptr<SocketFace> socket, bool _client,
+        std::function<void(NetworkException, P2PInfo const&, std::shared_ptr<SessionFace>)>
+            callback,
+        NodeIPEndpoint _nodeIPEndpoint, std::shared_ptr<boost::asio::deadline_timer> timerPtr);
+    /// the node info of the certificate: {nodeID}#{issuer-name}#{cert-name}
+    bool certNodeInfo(X509* cert, std::string& nodeInfo);
 
     void startPeerSession(P2PInfo const& p2pInfo, std::shared_ptr<SocketFace> const& socket,
         std::function<void(NetworkException, P2PInfo const&, std::shared_ptr<SessionFace>)>
@@ -135,7 +177,8 @@ private:
         std::shared_ptr<std::string> endpointPublicKey,
         std::function<void(NetworkException, P2PInfo const&, std::shared_ptr<SessionFace>)>
             callback,
-        NodeIPEndpoint _nodeIPEndpoint, std::shared_ptr<boost::asio::deadline_timer> timerPtr);
+        NodeIPEndpoint _nodeIPEndpoint, std::shared_ptr<boost::asio::deadline_timer> timerPtr,
+        uint64_t _connectStartTime, uint64_t _handshakeStartTime);
 
     void erasePendingConns(NodeIPEndpoint const& _nodeIPEndpoint)
     {
@@ -152,6 +195,7 @@ private:
     }
 
     std::shared_ptr<bcos::ThreadPool> m_threadPool;
+    DispatchLanes::Ptr m_dispatchLanes;
 
     /// representing to the network state
     std::shared_ptr<ASIOInterface> m_asioInterface;
@@ -161,6 +205,8 @@ private:
     bcos::Mutex x_pendingConns;
 
     MessageFactory::Ptr m_messageFactory;
+    SSLSessionCache::Ptr m_sslSessionCache;
+    PlaintextNetworks::Ptr m_plaintextNetworks;
 
     std::string m_listenHost = "";
     uint16_t m_listenPort = 0;
@@ -0,0 +1,145 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: pool of io_services, each of them driven by its own thread
+ * @file IOServicePool.cpp
+ */
+#include <bcos-gateway/libnetwork/Common.h>
+#include <bcos-gateway/libnetwork/IOServicePool.h>
+
+using namespace bcos;
+using namespace bcos::gateway;
+
+IOServicePool::IOServicePool(size_t _poolSize)
+{
+    if (_poolSize == 0)
+    {
+        _poolSize = 1;
+    }
+    for (size_t i = 0; i < _poolSize; ++i)
+    {
+        auto ioService = std::make_shared<IOService>(1);
+        m_ioServices.push_back(ioService);
+        m_timerWheels.push_back(std::make_shared<TimerWheel>(ioService));
+        m_idleSweepers.push_back(std::make_shared<IdleSweeper>(ioService));
+    }
+}
+
+void IOServicePool::start()
+{
+    if (m_running)
+    {
+        return;
+    }
+    m_running = true;
+    for (size_t i = 0; i < m_ioServices.size(); ++i)
+    {
+        auto ioService = m_ioServices[i];
+        if (ioService->stopped())
+        {
+            ioService->restart();
+        }
+        // keep the io_service running even if there are no pending handlers
+        m_works.push_back(std::make_shared<Work>(ioService->get_executor()));
+        m_threads.push_back(std::make_shared<std::thread>([this, ioService, i]() {
+            bcos::pthread_setThreadName("io_service_" + std::to_string(i));
+            while (m_running)
+            {
+                try
+                {
+                    ioService->run();
+                }
+                catch (std::exception& e)
+                {
+                    ASIO_LOG(WARNING) << LOG_DESC("Exception in IOServicePool Thread:")
+                                      << boost::diagnostic_information(e);
+                }
+                if (ioService->stopped())
+                {
+                    ioService->restart();
+                }
+            }
+            ASIO_LOG(INFO) << LOG_DESC("IOServicePool thread exit") << LOG_KV("index", i);
+        }));
+    }
+    ASIO_LOG(INFO) << LOG_DESC("IOServicePool started") << LOG_KV("size", m_ioServices.size());
+}
+
+void IOServicePool::stop()
+{
+    if (!m_running)
+    {
+        return;
+    }
+    m_running = false;
+    m_works.clear();
+    for (auto& timerWheel : m_timerWheels)
+    {
+        timerWheel->stop();
+    }
+    for (auto& idleSweeper : m_idleSweepers)
+    {
+        idleSweeper->stop();
+    }
+    for (auto& ioService : m_ioServices)
+    {
+        ioService->stop();
+    }
+    for (auto& thread : m_threads)
+    {
+        // the pool can be stopped by the handler running in the pool
+        if (thread->get_id() == std::this_thread::get_id())
+        {
+            thread->detach();
+            continue;
+        }
+        if (thread->joinable())
+        {
+            thread->join();
+        }
+    }
+    m_threads.clear();
+    ASIO_LOG(INFO) << LOG_DESC("IOServicePool stopped");
+}
+
+std::shared_ptr<IOServicePool::IOService> IOServicePool::getIOService()
+{
+    auto index = m_nextIOService.fetch_add(1) % m_ioServices.size();
+    return m_ioServices[index];
+}
+
+TimerWheel::Ptr IOServicePool::timerWheel(boost::asio::execution_context const& _ioService)
+{
+    for (size_t i = 0; i < m_ioServices.size(); ++i)
+    {
+        if (m_ioServices[i].get() == &_ioService)
+        {
+            return m_timerWheels[i];
+        }
+    }
+    return nullptr;
+}
+
+IdleSweeper::Ptr IOServicePool::idleSweeper(boost::asio::execution_context const& _ioService)
+{
+    for (size_t i = 0; i < m_ioServices.size(); ++i)
+    {
+        if (m_ioServices[i].get() == &_ioService)
+        {
+            return m_idleSweepers[i];
+        }
+    }
+    return nullptr;
+}
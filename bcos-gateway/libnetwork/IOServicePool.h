@@ -0,0 +1,72 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: pool of io_services, each of them driven by its own thread
+ * @file IOServicePool.h
+ */
+#pragma once
+#include <bcos-gateway/libnetwork/IdleSweeper.h>
+#include <bcos-gateway/libnetwork/TimerWheel.h>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_service.hpp>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace bcos
+{
+namespace gateway
+{
+/**
+ * @brief: every session socket is bound to one io_service of the pool, the io_service is run by
+ * exactly one thread, so all the handlers of a socket are serialized without strand, while the
+ * tls encryption and socket io of different sessions scale with the number of threads
+ */
+class IOServicePool
+{
+public:
+    using Ptr = std::shared_ptr<IOServicePool>;
+    using IOService = boost::asio::io_service;
+    using Work = boost::asio::executor_work_guard<IOService::executor_type>;
+
+    explicit IOServicePool(size_t _poolSize);
+    virtual ~IOServicePool() { stop(); }
+
+    virtual void start();
+    virtual void stop();
+
+    /// get the io_service in round-robin
+    virtual std::shared_ptr<IOService> getIOService();
+    /// the timer wheel driven by the given io_service of the pool, nullptr if not in the pool
+    virtual TimerWheel::Ptr timerWheel(boost::asio::execution_context const& _ioService);
+    /// the idle sweeper driven by the given io_service of the pool, nullptr if not in the pool
+    virtual IdleSweeper::Ptr idleSweeper(boost::asio::execution_context const& _ioService);
+
+    size_t size() const { return m_ioServices.size(); }
+
+private:
+    std::vector<std::shared_ptr<IOService>> m_ioServices;
+    // one timer wheel per io_service for the request timeouts
+    std::vector<TimerWheel::Ptr> m_timerWheels;
+    // one idle sweeper per io_service for the sessions bound to it
+    std::vector<IdleSweeper::Ptr> m_idleSweepers;
+    std::vector<std::shared_ptr<Work>> m_works;
+    std::vector<std::shared_ptr<std::thread>> m_threads;
+    std::atomic<size_t> m_nextIOService = {0};
+    std::atomic_bool m_running = {false};
+};
+}  // namespace gateway
+}  // namespace bcos
@@ -0,0 +1,127 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: periodic sweeper to close the idle sessions
+ * @file IdleSweeper.cpp
+ */
+#include <bcos-gateway/libnetwork/Common.h>
+#include <bcos-gateway/libnetwork/IdleSweeper.h>
+#include <boost/asio/post.hpp>
+
+using namespace bcos;
+using namespace bcos::gateway;
+
+IdleSweeper::IdleSweeper(std::shared_ptr<boost::asio::io_service> _ioService, uint64_t _intervalMs)
+  : m_ioService(_ioService), m_timer(*_ioService), m_intervalMs(std::max<uint64_t>(_intervalMs, 1))
+{}
+
+void IdleSweeper::add(std::weak_ptr<IdleCheckable> _checkable)
+{
+    {
+        Guard l(x_checkables);
+        m_checkables.push_back(std::move(_checkable));
+        if (m_sweeping)
+        {
+            return;
+        }
+        m_sweeping = true;
+    }
+    // the timer is only touched by the io_service thread
+    auto self = std::weak_ptr<IdleSweeper>(shared_from_this());
+    boost::asio::post(*m_ioService, [self]() {
+        auto sweeper = self.lock();
+        if (sweeper)
+        {
+            sweeper->schedule();
+        }
+    });
+}
+
+void IdleSweeper::schedule()
+{
+    m_timer.expires_from_now(boost::posix_time::milliseconds(m_intervalMs));
+    auto self = std::weak_ptr<IdleSweeper>(shared_from_this());
+    m_timer.async_wait([self](const boost::system::error_code& _error) {
+        auto sweeper = self.lock();
+        if (!sweeper || _error == boost::asio::error::operation_aborted)
+        {
+            return;
+        }
+        if (sweeper->sweep(utcSteadyTime()) == 0)
+        {
+            Guard l(sweeper->x_checkables);
+            // no session added during the sweep
+            if (sweeper->m_checkables.empty())
+            {
+                sweeper->m_sweeping = false;
+                return;
+            }
+        }
+        sweeper->schedule();
+    });
+}
+
+size_t IdleSweeper::sweep(uint64_t _now)
+{
+    std::vector<std::shared_ptr<IdleCheckable>> checkables;
+    {
+        Guard l(x_checkables);
+        checkables.reserve(m_checkables.size());
+        size_t kept = 0;
+        for (size_t i = 0; i < m_checkables.size(); ++i)
+        {
+            auto checkable = m_checkables[i].lock();
+            if (!checkable)
+            {
+                continue;
+            }
+            checkables.push_back(checkable);
+            if (kept != i)
+            {
+                m_checkables[kept] = std::move(m_checkables[i]);
+            }
+            kept++;
+        }
+        m_checkables.resize(kept);
+    }
+    // check without lock, the checkable may drop the session
+    std::vector<IdleCheckable*> finished;
+    for (auto& checkable : checkables)
+    {
+        if (!checkable->checkIdle(_now))
+        {
+            finished.push_back(checkable.get());
+        }
+    }
+    Guard l(x_checkables);
+    if (!finished.empty())
+    {
+        m_checkables.erase(std::remove_if(m_checkables.begin(), m_checkables.end(),
+                               [&finished](std::weak_ptr<IdleCheckable> const& _checkable) {
+                                   auto checkable = _checkable.lock();
+                                   return !checkable ||
+                                          std::find(finished.begin(), finished.end(),
+                                              checkable.get()) != finished.end();
+                               }),
+            m_checkables.end());
+    }
+    return m_checkables.size();
+}
+
+void IdleSweeper::stop()
+{
+    Guard l(x_checkables);
+    m_checkables.clear();
+}
@@ -0,0 +1,77 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: periodic sweeper to close the idle sessions
+ * @file IdleSweeper.h
+ */
+#pragma once
+#include <bcos-framework/libutilities/Common.h>
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/io_service.hpp>
+#include <memory>
+#include <vector>
+
+namespace bcos
+{
+namespace gateway
+{
+class IdleCheckable
+{
+public:
+    virtual ~IdleCheckable() {}
+    /// check the last io time and close the idle connection
+    /// @return false if no need to check any more
+    virtual bool checkIdle(uint64_t _now) = 0;
+};
+
+/**
+ * @brief: the sessions record the last read/write time on the data path, one timer per io_service
+ * checks all the sessions of the io_service every intervalMs, instead of re-arming two timers per
+ * session on every read and write
+ */
+class IdleSweeper : public std::enable_shared_from_this<IdleSweeper>
+{
+public:
+    using Ptr = std::shared_ptr<IdleSweeper>;
+
+    IdleSweeper(std::shared_ptr<boost::asio::io_service> _ioService, uint64_t _intervalMs = 1000);
+    virtual ~IdleSweeper() {}
+
+    virtual void add(std::weak_ptr<IdleCheckable> _checkable);
+    virtual void stop();
+
+    /// check all the sessions, return the number of the sessions still being checked
+    size_t sweep(uint64_t _now);
+
+    size_t size() const
+    {
+        Guard l(x_checkables);
+        return m_checkables.size();
+    }
+
+private:
+    void schedule();
+
+    std::shared_ptr<boost::asio::io_service> m_ioService;
+    boost::asio::deadline_timer m_timer;
+    uint64_t m_intervalMs;
+
+    mutable Mutex x_checkables;
+    std::vector<std::weak_ptr<IdleCheckable>> m_checkables;
+    // the sweep timer is armed only when there are sessions
+    bool m_sweeping = false;
+};
+}  // namespace gateway
+}  // namespace bcos
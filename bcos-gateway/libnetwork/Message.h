@@ -29,6 +29,31 @@ namespace bcos
 {
 namespace gateway
 {
+/**
+ * @brief: the encoded frame written by the gather-write, the buffer(the header and the options)
+ * followed by the payload referenced without copy, the payload is kept alive by the holder
+ */
+struct WriteBuffer
+{
+    std::shared_ptr<bytes> buffer;
+    bytesConstRef payload;
+    std::shared_ptr<const void> holder;
+
+    size_t size() const { return (buffer ? buffer->size() : 0) + payload.size(); }
+    /// the copy of the whole frame
+    bytes toBytes() const
+    {
+        bytes frame;
+        frame.reserve(size());
+        if (buffer)
+        {
+            frame.insert(frame.end(), buffer->begin(), buffer->end());
+        }
+        frame.insert(frame.end(), payload.begin(), payload.end());
+        return frame;
+    }
+};
+
 class Message
 {
 public:
@@ -44,7 +69,57 @@ public:
     virtual uint16_t ext() const = 0;
     virtual bool isRespPacket() const = 0;
     virtual bool encode(bcos::bytes& _buffer) = 0;
+    /// encode the frame for the gather-write, the message can reference the payload in _frame
+    /// without copy, the whole frame is encoded into _frame.buffer by default
+    virtual bool encode(WriteBuffer& _frame)
+    {
+        _frame.buffer = std::make_shared<bytes>();
+        _frame.payload = bytesConstRef();
+        _frame.holder = nullptr;
+        return encode(*_frame.buffer);
+    }
     virtual ssize_t decode(bytesConstRef _buffer) = 0;
+    /// decode the message from the _buffer owned by _holder, the message can reference the _buffer
+    /// without copy and keeps the _holder alive as long as the message is alive
+    virtual ssize_t decode(std::shared_ptr<bytes> _holder, bytesConstRef _buffer)
+    {
+        (void)_holder;
+        return decode(_buffer);
+    }
+};
+
+/**
+ * @brief: the message encoded once and shared by the write queues of all the sessions it is sent
+ * to(e.g. broadcast), neither the message nor the frame can be modified after encoded
+ */
+class EncodedMessage
+{
+public:
+    using Ptr = std::shared_ptr<const EncodedMessage>;
+
+    EncodedMessage(Message::Ptr _message, WriteBuffer _frame)
+      : m_message(std::move(_message)), m_frame(std::move(_frame))
+    {}
+
+    /// encode the _message, nullptr if failed
+    static Ptr encode(Message::Ptr _message)
+    {
+        WriteBuffer frame;
+        if (!_message->encode(frame))
+        {
+            return nullptr;
+        }
+        return std::make_shared<const EncodedMessage>(std::move(_message), std::move(frame));
+    }
+
+    Message::Ptr const& message() const { return m_message; }
+    /// the encoded frame, referenced by the write queues of the sessions without copy
+    WriteBuffer const& frame() const { return m_frame; }
+    size_t size() const { return m_frame.size(); }
+
+private:
+    Message::Ptr m_message;
+    WriteBuffer m_frame;
 };
 
 class MessageFactory
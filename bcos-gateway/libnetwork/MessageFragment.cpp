@@ -0,0 +1,230 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: split the large frames into fragments and reassemble them on the receiver
+ * @file MessageFragment.cpp
+ */
+#include <bcos-gateway/libnetwork/MessageFragment.h>
+#include <boost/asio/detail/socket_ops.hpp>
+
+using namespace bcos;
+using namespace bcos::gateway;
+
+namespace
+{
+uint32_t readUint32(bytesConstRef _buffer, size_t _offset)
+{
+    uint32_t value;
+    memcpy(&value, _buffer.data() + _offset, 4);
+    return boost::asio::detail::socket_ops::network_to_host_long(value);
+}
+
+uint16_t readUint16(bytesConstRef _buffer, size_t _offset)
+{
+    uint16_t value;
+    memcpy(&value, _buffer.data() + _offset, 2);
+    return boost::asio::detail::socket_ops::network_to_host_short(value);
+}
+
+void writeUint32(byte* _data, uint32_t _value)
+{
+    _value = boost::asio::detail::socket_ops::host_to_network_long(_value);
+    memcpy(_data, &_value, 4);
+}
+
+void writeUint16(byte* _data, uint16_t _value)
+{
+    _value = boost::asio::detail::socket_ops::host_to_network_short(_value);
+    memcpy(_data, &_value, 2);
+}
+}  // namespace
+
+std::vector<std::shared_ptr<bytes>> MessageFragmenter::split(
+    bytesConstRef _frame, uint32_t _fragmentID, size_t _fragmentSize)
+{
+    WriteBuffer frame;
+    frame.payload = _frame;
+    // the whole frame is referenced as the payload, copy the data into the fragments
+    auto fragments = split(frame, _fragmentID, _fragmentSize);
+    std::vector<std::shared_ptr<bytes>> buffers;
+    buffers.reserve(fragments.size());
+    for (auto& fragment : fragments)
+    {
+        fragment.buffer->insert(
+            fragment.buffer->end(), fragment.payload.begin(), fragment.payload.end());
+        buffers.push_back(std::move(fragment.buffer));
+    }
+    return buffers;
+}
+
+std::vector<WriteBuffer> MessageFragmenter::split(
+    WriteBuffer const& _frame, uint32_t _fragmentID, size_t _fragmentSize)
+{
+    std::vector<WriteBuffer> fragments;
+    auto header = _frame.buffer ? bytesConstRef(_frame.buffer->data(), _frame.buffer->size()) :
+                                  bytesConstRef();
+    // the frame header may be in the payload if the frame is not gathered
+    auto frameHeader = header.size() >= FRAME_HEADER_LENGTH ? header : _frame.payload;
+    auto frameSize = _frame.size();
+    if (frameHeader.size() < FRAME_HEADER_LENGTH || _fragmentSize == 0)
+    {
+        return fragments;
+    }
+    auto ext = readUint16(frameHeader, FRAME_EXT_OFFSET) | MessageExtFieldFlag::Fragment;
+    fragments.reserve((frameSize + _fragmentSize - 1) / _fragmentSize);
+    for (size_t offset = 0; offset < frameSize; offset += _fragmentSize)
+    {
+        auto dataSize = std::min(_fragmentSize, frameSize - offset);
+        // the part of the header(and the options) is copied, the part of the payload is
+        // referenced
+        auto headerSize = offset < header.size() ? std::min(dataSize, header.size() - offset) : 0;
+        WriteBuffer fragment;
+        fragment.buffer = std::make_shared<bytes>(FRAGMENT_HEADER_LENGTH + headerSize);
+        auto data = fragment.buffer->data();
+        writeUint32(data, (uint32_t)(FRAGMENT_HEADER_LENGTH + dataSize));
+        // version, packetType and seq of the frame
+        memcpy(data + 4, frameHeader.data() + 4, FRAME_EXT_OFFSET - 4);
+        writeUint16(data + FRAME_EXT_OFFSET, (uint16_t)ext);
+        writeUint32(data + FRAME_HEADER_LENGTH, _fragmentID);
+        writeUint32(data + FRAME_HEADER_LENGTH + 4, (uint32_t)frameSize);
+        writeUint32(data + FRAME_HEADER_LENGTH + 8, (uint32_t)offset);
+        if (headerSize > 0)
+        {
+            memcpy(data + FRAGMENT_HEADER_LENGTH, header.data() + offset, headerSize);
+        }
+        if (dataSize > headerSize)
+        {
+            fragment.payload = _frame.payload.getCroppedData(
+                offset + headerSize - header.size(), dataSize - headerSize);
+            fragment.holder = _frame.holder;
+        }
+        fragments.push_back(std::move(fragment));
+    }
+    return fragments;
+}
+
+bool MessageFragmenter::isFragment(bytesConstRef _buffer)
+{
+    if (_buffer.size() < FRAME_HEADER_LENGTH)
+    {
+        return false;
+    }
+    return (readUint16(_buffer, FRAME_EXT_OFFSET) & MessageExtFieldFlag::Fragment) != 0;
+}
+
+bool ReassemblyBudget::acquire(size_t _bytes)
+{
+    auto bytesSize = m_bytesSize.load(std::memory_order_relaxed);
+    do
+    {
+        if (bytesSize + _bytes > m_maxBytes)
+        {
+            return false;
+        }
+    } while (!m_bytesSize.compare_exchange_weak(bytesSize, bytesSize + _bytes,
+        std::memory_order_relaxed, std::memory_order_relaxed));
+    return true;
+}
+
+ssize_t MessageReassembler::decode(bytesConstRef _buffer, std::shared_ptr<bytes>& _frame)
+{
+    _frame = nullptr;
+    if (_buffer.size() < MessageFragmenter::FRAGMENT_HEADER_LENGTH)
+    {
+        return MessageDecodeStatus::MESSAGE_INCOMPLETE;
+    }
+    auto length = readUint32(_buffer, 0);
+    auto fragmentID = readUint32(_buffer, MessageFragmenter::FRAME_HEADER_LENGTH);
+    auto totalLength = readUint32(_buffer, MessageFragmenter::FRAME_HEADER_LENGTH + 4);
+    auto offset = readUint32(_buffer, MessageFragmenter::FRAME_HEADER_LENGTH + 8);
+    if (length <= MessageFragmenter::FRAGMENT_HEADER_LENGTH ||
+        totalLength < MessageFragmenter::FRAME_HEADER_LENGTH)
+    {
+        SESSION_LOG(ERROR) << LOG_DESC("invalid fragment") << LOG_KV("length", length)
+                           << LOG_KV("totalLength", totalLength);
+        return MessageDecodeStatus::MESSAGE_ERROR;
+    }
+    if (_buffer.size() < length)
+    {
+        return MessageDecodeStatus::MESSAGE_INCOMPLETE;
+    }
+    auto data = _buffer.getCroppedData(MessageFragmenter::FRAGMENT_HEADER_LENGTH,
+        length - MessageFragmenter::FRAGMENT_HEADER_LENGTH);
+
+    auto it = m_frames.find(fragmentID);
+    if (it == m_frames.end())
+    {
+        if (offset != 0)
+        {
+            SESSION_LOG(ERROR) << LOG_DESC("fragment received without the first fragment")
+                               << LOG_KV("fragmentID", fragmentID) << LOG_KV("offset", offset);
+            return MessageDecodeStatus::MESSAGE_ERROR;
+        }
+        if (totalLength > m_budget->maxBytes())
+        {
+            SESSION_LOG(ERROR) << LOG_DESC("fragmented frame exceeds the reassembly limit")
+                               << LOG_KV("fragmentID", fragmentID)
+                               << LOG_KV("totalLength", totalLength)
+                               << LOG_KV("maxBytes", m_budget->maxBytes());
+            return MessageDecodeStatus::MESSAGE_ERROR;
+        }
+    }
+    else
+    {
+        auto const& frame = it->second.buffer;
+        // the fragments of a frame are sent in order
+        if (offset != frame->size() || totalLength != it->second.totalLength)
+        {
+            SESSION_LOG(ERROR) << LOG_DESC("fragment out of order")
+                               << LOG_KV("fragmentID", fragmentID) << LOG_KV("offset", offset)
+                               << LOG_KV("received", frame->size())
+                               << LOG_KV("totalLength", totalLength);
+            return MessageDecodeStatus::MESSAGE_ERROR;
+        }
+    }
+    if (offset + data.size() > totalLength)
+    {
+        SESSION_LOG(ERROR) << LOG_DESC("fragment exceeds the frame")
+                           << LOG_KV("fragmentID", fragmentID) << LOG_KV("offset", offset)
+                           << LOG_KV("size", data.size()) << LOG_KV("totalLength", totalLength);
+        return MessageDecodeStatus::MESSAGE_ERROR;
+    }
+    // charge the bytes received only, the declared total length is not trusted
+    if (!m_budget->acquire(data.size()))
+    {
+        SESSION_LOG(ERROR) << LOG_DESC("reassembly memory exceeds the limit")
+                           << LOG_KV("fragmentID", fragmentID)
+                           << LOG_KV("totalLength", totalLength)
+                           << LOG_KV("reassemblingBytes", m_budget->bytesSize())
+                           << LOG_KV("maxBytes", m_budget->maxBytes());
+        return MessageDecodeStatus::MESSAGE_ERROR;
+    }
+    m_bytesSize += data.size();
+    if (it == m_frames.end())
+    {
+        it = m_frames.emplace(fragmentID, Frame{std::make_shared<bytes>(), totalLength}).first;
+    }
+    // the frame grows with the fragments instead of reserving the total length up front
+    auto& frame = it->second.buffer;
+    frame->insert(frame->end(), data.begin(), data.end());
+    if (frame->size() == totalLength)
+    {
+        _frame = frame;
+        m_budget->release(totalLength);
+        m_bytesSize -= totalLength;
+        m_frames.erase(it);
+    }
+    return length;
+}
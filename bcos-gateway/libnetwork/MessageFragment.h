@@ -0,0 +1,137 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: split the large frames into fragments and reassemble them on the receiver
+ * @file MessageFragment.h
+ */
+#pragma once
+#include <bcos-framework/libutilities/Common.h>
+#include <bcos-gateway/libnetwork/Common.h>
+#include <bcos-gateway/libnetwork/Message.h>
+#include <atomic>
+#include <unordered_map>
+
+namespace bcos
+{
+namespace gateway
+{
+struct MessageFragmentConfig
+{
+    // the frames larger than fragmentSize are sent in fragments to the peers supporting
+    // P2PFeature::Fragmentation, 0 means disable
+    size_t fragmentSize = 64 * 1024;
+    // the max bytes of the frames being reassembled from all the sessions of the host
+    size_t maxReassemblyBytes = 256 * 1024 * 1024;
+};
+
+/// Fragment format definition, the large frame is sent in fragments so that the other messages
+/// can be interleaved between them(by the priority classes of the write queue)
+///
+/// fields:
+///   length            :4 bytes
+///   version           :2 bytes, the same as the frame
+///   packet type       :2 bytes, the same as the frame
+///   seq               :4 bytes, the same as the frame
+///   ext               :2 bytes, the ext of the frame | MessageExtFieldFlag::Fragment
+///   fragment id       :4 bytes, unique in the session
+///   total length      :4 bytes, the length of the frame
+///   offset            :4 bytes, the offset of the data in the frame
+///   data              :X bytes
+/// the fragments of a frame are sent in order on the same session
+class MessageFragmenter
+{
+public:
+    /// the frame header shared by all the messages: length(4) + version(2) + packetType(2) +
+    /// seq(4) + ext(2)
+    const static size_t FRAME_HEADER_LENGTH = 14;
+    const static size_t FRAME_EXT_OFFSET = 12;
+    /// frame header + fragment id(4) + total length(4) + offset(4)
+    const static size_t FRAGMENT_HEADER_LENGTH = 26;
+
+    /// split the encoded _frame into the fragments carrying at most _fragmentSize bytes of it
+    static std::vector<std::shared_ptr<bytes>> split(
+        bytesConstRef _frame, uint32_t _fragmentID, size_t _fragmentSize);
+    /// split the _frame of the gather-write, the fragments reference the payload of it without
+    /// copy, only the header and the options are copied into the first fragments
+    static std::vector<WriteBuffer> split(
+        WriteBuffer const& _frame, uint32_t _fragmentID, size_t _fragmentSize);
+
+    /// the frame at the front of _buffer is a fragment, false if the header is incomplete
+    static bool isFragment(bytesConstRef _buffer);
+};
+
+/**
+ * @brief: the memory of the frames being reassembled, shared by all the sessions of the host so
+ * that the parallel connections with the peers can not multiply it, thread-safe
+ */
+class ReassemblyBudget
+{
+public:
+    using Ptr = std::shared_ptr<ReassemblyBudget>;
+    explicit ReassemblyBudget(size_t _maxBytes) : m_maxBytes(_maxBytes) {}
+
+    /// charge _bytes, false if the limit is exceeded
+    bool acquire(size_t _bytes);
+    void release(size_t _bytes) { m_bytesSize.fetch_sub(_bytes, std::memory_order_relaxed); }
+
+    size_t maxBytes() const { return m_maxBytes; }
+    size_t bytesSize() const { return m_bytesSize.load(std::memory_order_relaxed); }
+
+private:
+    const size_t m_maxBytes;
+    std::atomic<size_t> m_bytesSize = {0};
+};
+
+/**
+ * @brief: reassemble the fragments received by one session, the frames grow as the fragments
+ * arrive and the bytes received are charged to the ReassemblyBudget, not thread-safe, only
+ * accessed by the read handler of the session
+ */
+class MessageReassembler
+{
+public:
+    explicit MessageReassembler(ReassemblyBudget::Ptr _budget) : m_budget(std::move(_budget)) {}
+    explicit MessageReassembler(size_t _maxBytes)
+      : MessageReassembler(std::make_shared<ReassemblyBudget>(_maxBytes))
+    {}
+    ~MessageReassembler() { m_budget->release(m_bytesSize); }
+
+    /// decode the fragment at the front of _buffer, _frame is set to the reassembled frame when
+    /// the last fragment of it is received
+    /// @return the length of the fragment decoded, MESSAGE_INCOMPLETE if the fragment is not
+    /// fully received, MESSAGE_ERROR if the fragment is invalid or exceeds maxReassemblyBytes
+    ssize_t decode(bytesConstRef _buffer, std::shared_ptr<bytes>& _frame);
+
+    /// must be set before the first fragment decoded
+    void setBudget(ReassemblyBudget::Ptr _budget) { m_budget = std::move(_budget); }
+    ReassemblyBudget::Ptr const& budget() const { return m_budget; }
+    /// the bytes received of the frames being reassembled
+    size_t bytesSize() const { return m_bytesSize; }
+    size_t size() const { return m_frames.size(); }
+
+private:
+    struct Frame
+    {
+        // the data received so far
+        std::shared_ptr<bytes> buffer;
+        uint32_t totalLength;
+    };
+    ReassemblyBudget::Ptr m_budget;
+    size_t m_bytesSize = 0;
+    // fragment id => the frame being reassembled
+    std::unordered_map<uint32_t, Frame> m_frames;
+};
+}  // namespace gateway
+}  // namespace bcos
@@ -0,0 +1,215 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: the pool recycling the objects allocated per message
+ * @file ObjectPool.h
+ */
+#pragma once
+#include <bcos-framework/libutilities/Common.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace bcos
+{
+namespace gateway
+{
+/**
+ * @brief: the free list of the memory blocks of the same size, the blocks of the other sizes are
+ * allocated and freed directly
+ */
+class BlockCache
+{
+public:
+    explicit BlockCache(size_t _capacity) : m_capacity(_capacity) { m_blocks.reserve(_capacity); }
+    ~BlockCache()
+    {
+        for (auto block : m_blocks)
+        {
+            ::operator delete(block);
+        }
+    }
+
+    void* allocate(size_t _size)
+    {
+        {
+            Guard l(x_blocks);
+            if (_size == m_blockSize && !m_blocks.empty())
+            {
+                auto block = m_blocks.back();
+                m_blocks.pop_back();
+                return block;
+            }
+        }
+        return ::operator new(_size);
+    }
+
+    void deallocate(void* _block, size_t _size)
+    {
+        {
+            Guard l(x_blocks);
+            // the size of the first block freed is cached
+            if (m_blockSize == 0)
+            {
+                m_blockSize = _size;
+            }
+            if (_size == m_blockSize && m_blocks.size() < m_capacity)
+            {
+                m_blocks.push_back(_block);
+                return;
+            }
+        }
+        ::operator delete(_block);
+    }
+
+private:
+    size_t m_capacity;
+    mutable Mutex x_blocks;
+    size_t m_blockSize = 0;
+    std::vector<void*> m_blocks;
+};
+
+/// allocate the control blocks of the shared_ptrs from the BlockCache
+template <typename T>
+struct BlockAllocator
+{
+    using value_type = T;
+
+    explicit BlockAllocator(std::shared_ptr<BlockCache> _cache) : cache(std::move(_cache)) {}
+    template <typename U>
+    BlockAllocator(BlockAllocator<U> const& _other) : cache(_other.cache)
+    {}
+
+    T* allocate(size_t _n) { return static_cast<T*>(cache->allocate(_n * sizeof(T))); }
+    void deallocate(T* _p, size_t _n) { cache->deallocate(_p, _n * sizeof(T)); }
+
+    template <typename U>
+    bool operator==(BlockAllocator<U> const& _other) const
+    {
+        return cache == _other.cache;
+    }
+    template <typename U>
+    bool operator!=(BlockAllocator<U> const& _other) const
+    {
+        return cache != _other.cache;
+    }
+
+    std::shared_ptr<BlockCache> cache;
+};
+
+/**
+ * @brief: the objects acquired are returned to the pool when the last shared_ptr is released,
+ * reset() of the object is called to release the resources it references before reused.
+ * the control blocks of the shared_ptrs are recycled too, so acquire allocates nothing once the
+ * pool is warmed up. at most _capacity idle objects are kept, the others are deleted on release.
+ * the objects released after the pool destroyed are deleted.
+ */
+template <typename T>
+class ObjectPool : public std::enable_shared_from_this<ObjectPool<T>>
+{
+public:
+    using Ptr = std::shared_ptr<ObjectPool<T>>;
+
+    static Ptr create(size_t _capacity) { return Ptr(new ObjectPool<T>(_capacity)); }
+
+    ~ObjectPool()
+    {
+        for (auto object : m_objects)
+        {
+            delete object;
+        }
+    }
+
+    std::shared_ptr<T> acquire()
+    {
+        T* object = nullptr;
+        {
+            Guard l(x_objects);
+            if (!m_objects.empty())
+            {
+                object = m_objects.back();
+                m_objects.pop_back();
+            }
+        }
+        if (object)
+        {
+            m_reused.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            object = new T();
+            m_created.fetch_add(1, std::memory_order_relaxed);
+        }
+        return std::shared_ptr<T>(object, Recycler{this->weak_from_this()},
+            BlockAllocator<T>(m_blockCache));
+    }
+
+    size_t capacity() const { return m_capacity; }
+    /// the idle objects
+    size_t size() const
+    {
+        Guard l(x_objects);
+        return m_objects.size();
+    }
+    /// the objects allocated and the acquires served by the recycled objects
+    uint64_t created() const { return m_created.load(std::memory_order_relaxed); }
+    uint64_t reused() const { return m_reused.load(std::memory_order_relaxed); }
+
+private:
+    explicit ObjectPool(size_t _capacity)
+      : m_capacity(_capacity), m_blockCache(std::make_shared<BlockCache>(_capacity))
+    {
+        m_objects.reserve(_capacity);
+    }
+
+    struct Recycler
+    {
+        std::weak_ptr<ObjectPool<T>> pool;
+        void operator()(T* _object) const
+        {
+            auto objectPool = pool.lock();
+            if (!objectPool)
+            {
+                delete _object;
+                return;
+            }
+            objectPool->recycle(_object);
+        }
+    };
+
+    void recycle(T* _object)
+    {
+        // out of the lock, the resources released may be large
+        _object->reset();
+        {
+            Guard l(x_objects);
+            if (m_objects.size() < m_capacity)
+            {
+                m_objects.push_back(_object);
+                return;
+            }
+        }
+        delete _object;
+    }
+
+    size_t m_capacity;
+    std::shared_ptr<BlockCache> m_blockCache;
+    mutable Mutex x_objects;
+    std::vector<T*> m_objects;
+    std::atomic<uint64_t> m_created = {0};
+    std::atomic<uint64_t> m_reused = {0};
+};
+}  // namespace gateway
+}  // namespace bcos
@@ -0,0 +1,292 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: executor running the tasks of every queue in order, the queues in parallel
+ * @file OrderedExecutor.cpp
+ */
+#include <bcos-gateway/libnetwork/Common.h>
+#include <bcos-gateway/libnetwork/OrderedExecutor.h>
+#include <boost/exception/diagnostic_information.hpp>
+#include <chrono>
+#include <sstream>
+
+using namespace bcos;
+using namespace bcos::gateway;
+
+namespace
+{
+// the executor and the index of the worker running on the current thread
+thread_local OrderedExecutor const* t_executor = nullptr;
+thread_local size_t t_workerIndex = 0;
+
+void updateMax(std::atomic<uint64_t>& _max, uint64_t _value)
+{
+    auto current = _max.load(std::memory_order_relaxed);
+    while (_value > current &&
+           !_max.compare_exchange_weak(current, _value, std::memory_order_relaxed))
+    {
+    }
+}
+}  // namespace
+
+void ExecutorMetrics::onExecuted(uint64_t _waitTime, uint64_t _execTime)
+{
+    m_waitTime.fetch_add(_waitTime, std::memory_order_relaxed);
+    m_execTime.fetch_add(_execTime, std::memory_order_relaxed);
+    m_executed.fetch_add(1, std::memory_order_relaxed);
+    updateMax(m_maxWaitTime, _waitTime);
+    updateMax(m_maxExecTime, _execTime);
+}
+
+std::string ExecutorMetrics::toString()
+{
+    auto executed = m_executed.load(std::memory_order_relaxed);
+    auto waitTime = m_waitTime.load(std::memory_order_relaxed);
+    auto execTime = m_execTime.load(std::memory_order_relaxed);
+    auto count = executed - m_lastExecuted;
+    auto averageWaitTime = count > 0 ? (waitTime - m_lastWaitTime) / count : 0;
+    auto averageExecTime = count > 0 ? (execTime - m_lastExecTime) / count : 0;
+    m_lastExecuted = executed;
+    m_lastWaitTime = waitTime;
+    m_lastExecTime = execTime;
+
+    std::stringstream stream;
+    stream << "executed:" << count << ",wait:" << averageWaitTime << "/"
+           << m_maxWaitTime.exchange(0, std::memory_order_relaxed) << "us,exec:" << averageExecTime
+           << "/" << m_maxExecTime.exchange(0, std::memory_order_relaxed) << "us";
+    return stream.str();
+}
+
+bool OrderedExecutor::Queue::post(Task _task)
+{
+    auto executor = m_executor.lock();
+    if (!executor || !executor->running())
+    {
+        return false;
+    }
+    bool schedule = false;
+    {
+        Guard l(x_tasks);
+        m_tasks.push_back(Item{std::move(_task), steadyTimeUs()});
+        if (m_tasks.size() > m_maxDepth)
+        {
+            m_maxDepth = m_tasks.size();
+        }
+        if (!m_scheduled)
+        {
+            m_scheduled = true;
+            schedule = true;
+        }
+    }
+    if (schedule)
+    {
+        executor->schedule(shared_from_this());
+    }
+    return true;
+}
+
+std::string OrderedExecutor::Queue::toString()
+{
+    std::stringstream stream;
+    stream << "depth:" << depth() << ",maxDepth:" << m_maxDepth << "," << m_metrics.toString();
+    return stream.str();
+}
+
+OrderedExecutor::OrderedExecutor(std::string const& _name, size_t _threadNum, size_t _batchSize)
+  : m_name(_name), m_batchSize(std::max<size_t>(1, _batchSize))
+{
+    for (size_t i = 0; i < std::max<size_t>(1, _threadNum); ++i)
+    {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+}
+
+void OrderedExecutor::start()
+{
+    if (m_running || !m_threads.empty())
+    {
+        return;
+    }
+    m_running = true;
+    for (size_t i = 0; i < m_workers.size(); ++i)
+    {
+        m_threads.emplace_back([this, i]() {
+            bcos::pthread_setThreadName(m_name + "_" + std::to_string(i));
+            work(i);
+        });
+    }
+    EXECUTOR_LOG(INFO) << LOG_DESC("OrderedExecutor started") << LOG_KV("name", m_name)
+                       << LOG_KV("threads", m_workers.size()) << LOG_KV("batch", m_batchSize);
+}
+
+void OrderedExecutor::stop()
+{
+    if (!m_running)
+    {
+        return;
+    }
+    m_running = false;
+    {
+        Guard l(x_idle);
+    }
+    m_signal.notify_all();
+    for (auto& thread : m_threads)
+    {
+        // the task stopping the executor runs on one of the workers
+        if (thread.get_id() == std::this_thread::get_id())
+        {
+            thread.detach();
+        }
+        else if (thread.joinable())
+        {
+            thread.join();
+        }
+    }
+    for (auto& worker : m_workers)
+    {
+        Guard l(worker->x_queues);
+        worker->queues.clear();
+    }
+    EXECUTOR_LOG(INFO) << LOG_DESC("OrderedExecutor stopped") << LOG_KV("name", m_name);
+}
+
+std::string OrderedExecutor::toString()
+{
+    std::stringstream stream;
+    stream << "threads:" << m_workers.size() << ",pending:" << m_pending << ",steals:" << m_steals
+           << "," << m_metrics.toString();
+    return stream.str();
+}
+
+uint64_t OrderedExecutor::steadyTimeUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void OrderedExecutor::schedule(Queue::Ptr _queue)
+{
+    auto index = (t_executor == this) ? t_workerIndex :
+                                        (m_nextWorker.fetch_add(1) % m_workers.size());
+    {
+        Guard l(m_workers[index]->x_queues);
+        m_workers[index]->queues.push_back(std::move(_queue));
+    }
+    m_pending++;
+    // the worker waits only after checking m_pending with x_idle locked
+    if (m_idle > 0)
+    {
+        {
+            Guard l(x_idle);
+        }
+        m_signal.notify_one();
+    }
+}
+
+OrderedExecutor::Queue::Ptr OrderedExecutor::take(size_t _index)
+{
+    {
+        auto& worker = *m_workers[_index];
+        Guard l(worker.x_queues);
+        if (!worker.queues.empty())
+        {
+            auto queue = std::move(worker.queues.front());
+            worker.queues.pop_front();
+            m_pending--;
+            return queue;
+        }
+    }
+    // steal from the back, the front of the deque is the next to be run by its owner
+    for (size_t i = 1; i < m_workers.size(); ++i)
+    {
+        auto& worker = *m_workers[(_index + i) % m_workers.size()];
+        Guard l(worker.x_queues);
+        if (!worker.queues.empty())
+        {
+            auto queue = std::move(worker.queues.back());
+            worker.queues.pop_back();
+            m_pending--;
+            m_steals++;
+            return queue;
+        }
+    }
+    return nullptr;
+}
+
+void OrderedExecutor::work(size_t _index)
+{
+    t_executor = this;
+    t_workerIndex = _index;
+    while (m_running)
+    {
+        auto queue = take(_index);
+        if (!queue)
+        {
+            std::unique_lock<Mutex> l(x_idle);
+            m_idle++;
+            m_signal.wait_for(l, std::chrono::milliseconds(100),
+                [this]() { return m_pending > 0 || !m_running; });
+            m_idle--;
+            continue;
+        }
+        if (run(queue))
+        {
+            // behind the other queues of the worker
+            schedule(std::move(queue));
+        }
+    }
+    t_executor = nullptr;
+}
+
+bool OrderedExecutor::run(Queue::Ptr const& _queue)
+{
+    for (size_t i = 0; i < m_batchSize && m_running; ++i)
+    {
+        Queue::Item item;
+        {
+            Guard l(_queue->x_tasks);
+            if (_queue->m_tasks.empty())
+            {
+                _queue->m_scheduled = false;
+                return false;
+            }
+            item = std::move(_queue->m_tasks.front());
+            _queue->m_tasks.pop_front();
+        }
+        auto startTime = steadyTimeUs();
+        try
+        {
+            item.task();
+        }
+        catch (std::exception const& e)
+        {
+            EXECUTOR_LOG(WARNING) << LOG_DESC("OrderedExecutor task exception")
+                                  << LOG_KV("name", m_name)
+                                  << LOG_KV("error", boost::diagnostic_information(e));
+        }
+        auto endTime = steadyTimeUs();
+        auto waitTime = startTime > item.postTime ? startTime - item.postTime : 0;
+        _queue->m_metrics.onExecuted(waitTime, endTime - startTime);
+        m_metrics.onExecuted(waitTime, endTime - startTime);
+    }
+    Guard l(_queue->x_tasks);
+    if (_queue->m_tasks.empty())
+    {
+        _queue->m_scheduled = false;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,168 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: executor running the tasks of every queue in order, the queues in parallel
+ * @file OrderedExecutor.h
+ */
+#pragma once
+#include <bcos-framework/libutilities/Common.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bcos
+{
+namespace gateway
+{
+/**
+ * @brief: the statistics of the tasks executed, wait is the time from posted to started, exec is
+ * the time of running the task, in microseconds
+ */
+class ExecutorMetrics
+{
+public:
+    void onExecuted(uint64_t _waitTime, uint64_t _execTime);
+
+    uint64_t executed() const { return m_executed; }
+    uint64_t maxWaitTime() const { return m_maxWaitTime; }
+    uint64_t maxExecTime() const { return m_maxExecTime; }
+    /// the average and the max since the last call, the max are reset
+    std::string toString();
+
+private:
+    std::atomic<uint64_t> m_executed = {0};
+    std::atomic<uint64_t> m_waitTime = {0};
+    std::atomic<uint64_t> m_execTime = {0};
+    std::atomic<uint64_t> m_maxWaitTime = {0};
+    std::atomic<uint64_t> m_maxExecTime = {0};
+    // the executed count of the last toString, to report the average of the interval
+    uint64_t m_lastExecuted = 0;
+    uint64_t m_lastWaitTime = 0;
+    uint64_t m_lastExecTime = 0;
+};
+
+/**
+ * @brief: the tasks posted to the same queue run one by one in the posted order, the different
+ * queues run in parallel on the worker threads.
+ * the queue with tasks is scheduled on the deque of a worker as a whole, the worker runs at most
+ * batchSize tasks of it and then schedules it again behind the other queues, so one busy queue
+ * can not hold a worker. the idle workers steal the queues from the back of the busy workers'
+ * deques. a queue is owned by at most one worker at any time, which keeps the order of its tasks.
+ */
+class OrderedExecutor : public std::enable_shared_from_this<OrderedExecutor>
+{
+public:
+    using Ptr = std::shared_ptr<OrderedExecutor>;
+    using Task = std::function<void()>;
+
+    class Queue : public std::enable_shared_from_this<Queue>
+    {
+    public:
+        using Ptr = std::shared_ptr<Queue>;
+
+        explicit Queue(std::weak_ptr<OrderedExecutor> _executor) : m_executor(_executor) {}
+
+        /// run _task after all the tasks posted before, false if the executor has stopped
+        bool post(Task _task);
+
+        /// the tasks waiting
+        size_t depth() const
+        {
+            Guard l(x_tasks);
+            return m_tasks.size();
+        }
+        /// the max depth since created
+        size_t maxDepth() const { return m_maxDepth; }
+        ExecutorMetrics& metrics() { return m_metrics; }
+        /// depth, max depth and the latency of the tasks
+        std::string toString();
+
+    private:
+        friend class OrderedExecutor;
+        struct Item
+        {
+            Task task;
+            // steady time(us) of posted
+            uint64_t postTime;
+        };
+
+        std::weak_ptr<OrderedExecutor> m_executor;
+        mutable Mutex x_tasks;
+        std::deque<Item> m_tasks;
+        // on the deque of a worker or being run by a worker, protected by x_tasks
+        bool m_scheduled = false;
+        std::atomic<size_t> m_maxDepth = {0};
+        ExecutorMetrics m_metrics;
+    };
+
+    const static size_t c_defaultBatchSize = 32;
+
+    OrderedExecutor(std::string const& _name, size_t _threadNum,
+        size_t _batchSize = c_defaultBatchSize);
+    virtual ~OrderedExecutor() { stop(); }
+
+    virtual void start();
+    /// the tasks not started are dropped
+    virtual void stop();
+
+    /// a new queue, the tasks of the queue are run in order
+    virtual Queue::Ptr newQueue() { return std::make_shared<Queue>(shared_from_this()); }
+
+    size_t threadNum() const { return m_workers.size(); }
+    size_t steals() const { return m_steals; }
+    /// the latency of the tasks of all the queues
+    ExecutorMetrics& metrics() { return m_metrics; }
+    std::string toString();
+
+    static uint64_t steadyTimeUs();
+
+private:
+    struct Worker
+    {
+        Mutex x_queues;
+        std::deque<Queue::Ptr> queues;
+    };
+
+    bool running() const { return m_running; }
+    // push the queue to the deque of the current worker, or of the next worker if not called by
+    // the workers
+    void schedule(Queue::Ptr _queue);
+    void work(size_t _index);
+    Queue::Ptr take(size_t _index);
+    // run at most m_batchSize tasks of the queue, return true if the queue still has tasks
+    bool run(Queue::Ptr const& _queue);
+
+    std::string m_name;
+    size_t m_batchSize;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread> m_threads;
+    std::atomic_bool m_running = {false};
+    std::atomic<size_t> m_nextWorker = {0};
+    // the queues scheduled and not taken by the workers
+    std::atomic<size_t> m_pending = {0};
+    std::atomic<size_t> m_steals = {0};
+    // the workers waiting for the queues
+    std::atomic<size_t> m_idle = {0};
+    Mutex x_idle;
+    std::condition_variable m_signal;
+    ExecutorMetrics m_metrics;
+};
+}  // namespace gateway
+}  // namespace bcos
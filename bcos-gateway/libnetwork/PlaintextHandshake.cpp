@@ -0,0 +1,463 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: the plaintext transport for the trusted networks, authenticated by signed nonces
+ * @file PlaintextHandshake.cpp
+ */
+#include <bcos-gateway/libnetwork/PlaintextHandshake.h>
+#include <boost/algorithm/string.hpp>
+#include <boost/asio/placeholders.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/bind/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+
+using namespace bcos;
+using namespace bcos::gateway;
+
+namespace
+{
+// magic(8) + body length(4)
+const size_t c_helloHeaderSize = PlaintextHandshake::c_magicSize + 4;
+const size_t c_maxHelloSize = 64 * 1024;
+const size_t c_maxCertCount = 8;
+const size_t c_maxProofSize = 1024;
+const std::string c_proofDomain = "bcos-gateway plaintext handshake";
+
+boost::system::error_code protocolError()
+{
+    return boost::system::errc::make_error_code(boost::system::errc::protocol_error);
+}
+
+boost::system::error_code invalidArgument()
+{
+    return boost::system::errc::make_error_code(boost::system::errc::invalid_argument);
+}
+
+boost::system::error_code authError()
+{
+    return boost::system::errc::make_error_code(boost::system::errc::permission_denied);
+}
+
+void appendUint(bytes& _buffer, uint32_t _value, size_t _size)
+{
+    for (size_t i = 0; i < _size; ++i)
+    {
+        _buffer.push_back((byte)(_value >> (8 * (_size - 1 - i))));
+    }
+}
+
+uint32_t readUint(byte const* _data, size_t _size)
+{
+    uint32_t value = 0;
+    for (size_t i = 0; i < _size; ++i)
+    {
+        value = (value << 8) | _data[i];
+    }
+    return value;
+}
+
+bool appendCertificate(bytes& _buffer, X509* _cert)
+{
+    auto size = i2d_X509(_cert, nullptr);
+    if (size <= 0 || size > 0xffff)
+    {
+        return false;
+    }
+    appendUint(_buffer, size, 2);
+    auto offset = _buffer.size();
+    _buffer.resize(offset + size);
+    auto data = _buffer.data() + offset;
+    return i2d_X509(_cert, &data) == size;
+}
+}  // namespace
+
+PlaintextNetworks::PlaintextNetworks(std::vector<std::string> const& _networks)
+{
+    for (auto const& network : _networks)
+    {
+        auto notation = boost::trim_copy(network);
+        if (notation.empty())
+        {
+            continue;
+        }
+        auto pos = notation.find('/');
+        boost::system::error_code error;
+        auto address = bi::make_address(notation.substr(0, pos), error);
+        uint32_t maxPrefixLength = address.is_v4() ? 32 : 128;
+        uint32_t prefixLength = maxPrefixLength;
+        try
+        {
+            if (!error && pos != std::string::npos)
+            {
+                prefixLength = boost::lexical_cast<uint32_t>(notation.substr(pos + 1));
+            }
+        }
+        catch (std::exception const&)
+        {
+            prefixLength = maxPrefixLength + 1;
+        }
+        if (error || prefixLength > maxPrefixLength)
+        {
+            BOOST_THROW_EXCEPTION(InvalidParameter() << errinfo_comment(
+                                      "PlaintextNetworks: invalid network " + notation));
+        }
+        m_networks.push_back(Network{address, prefixLength});
+    }
+}
+
+bool PlaintextNetworks::contains(bi::address const& _address) const
+{
+    auto address = _address;
+    if (address.is_v6() && address.to_v6().is_v4_mapped())
+    {
+        address = address.to_v6().to_v4();
+    }
+    for (auto const& network : m_networks)
+    {
+        if (network.address.is_v4() != address.is_v4())
+        {
+            continue;
+        }
+        if (address.is_v4())
+        {
+            uint64_t mask = ~((1ull << (32 - network.prefixLength)) - 1) & 0xffffffff;
+            if ((address.to_v4().to_uint() & mask) == (network.address.to_v4().to_uint() & mask))
+            {
+                return true;
+            }
+            continue;
+        }
+        auto addressBytes = address.to_v6().to_bytes();
+        auto networkBytes = network.address.to_v6().to_bytes();
+        bool matched = true;
+        for (uint32_t bit = 0; bit < network.prefixLength && matched; bit += 8)
+        {
+            auto index = bit / 8;
+            byte mask = (network.prefixLength - bit >= 8) ?
+                            0xff :
+                            (byte)(0xff << (8 - (network.prefixLength - bit)));
+            matched = ((addressBytes[index] & mask) == (networkBytes[index] & mask));
+        }
+        if (matched)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+constexpr char PlaintextHandshake::c_magic[];
+
+PlaintextHandshake::PlaintextHandshake(std::shared_ptr<SocketFace> _socket,
+    std::shared_ptr<ba::ssl::context> _sslContext, bool _client, uint32_t _timeout)
+  : m_socket(_socket), m_sslContext(_sslContext), m_client(_client), m_timeout(_timeout)
+{}
+
+void PlaintextHandshake::start(Handler _handler)
+{
+    m_handler = _handler;
+    auto self = shared_from_this();
+    ba::post(m_socket->ref().get_executor(), [self]() {
+        self->m_timer = std::make_shared<ba::deadline_timer>(
+            self->m_socket->ref().get_executor(), boost::posix_time::milliseconds(self->m_timeout));
+        self->m_timer->async_wait([self](boost::system::error_code const& _error) {
+            if (_error != ba::error::operation_aborted)
+            {
+                self->finish(ba::error::timed_out);
+            }
+        });
+        if (!self->buildHello())
+        {
+            self->finish(invalidArgument());
+            return;
+        }
+        ba::async_write(self->m_socket->ref(), ba::buffer(self->m_sendBuffer),
+            boost::bind(&PlaintextHandshake::onHelloWritten, self, ba::placeholders::error));
+    });
+}
+
+bool PlaintextHandshake::buildHello()
+{
+    auto sslContext = m_sslContext->native_handle();
+    auto cert = SSL_CTX_get0_certificate(sslContext);
+    if (!cert || !SSL_CTX_get0_privatekey(sslContext))
+    {
+        ASIO_LOG(ERROR) << LOG_DESC("PlaintextHandshake: no certificate or key in the ssl context");
+        return false;
+    }
+    m_nonce.resize(c_nonceSize);
+    if (RAND_bytes(m_nonce.data(), m_nonce.size()) != 1)
+    {
+        return false;
+    }
+    STACK_OF(X509)* chain = nullptr;
+    SSL_CTX_get0_chain_certs(sslContext, &chain);
+    auto chainSize = chain ? sk_X509_num(chain) : 0;
+
+    bytes body(m_nonce);
+    body.push_back((byte)(1 + std::min<size_t>(chainSize, c_maxCertCount - 1)));
+    if (!appendCertificate(body, cert))
+    {
+        return false;
+    }
+    for (int i = 0; i < chainSize && i + 1 < (int)c_maxCertCount; ++i)
+    {
+        if (!appendCertificate(body, sk_X509_value(chain, i)))
+        {
+            return false;
+        }
+    }
+    if (body.size() > c_maxHelloSize)
+    {
+        return false;
+    }
+    m_sendBuffer.assign(c_magic, c_magic + c_magicSize);
+    appendUint(m_sendBuffer, body.size(), 4);
+    m_sendBuffer.insert(m_sendBuffer.end(), body.begin(), body.end());
+    return true;
+}
+
+void PlaintextHandshake::onHelloWritten(boost::system::error_code const& _error)
+{
+    if (_error)
+    {
+        finish(_error);
+        return;
+    }
+    m_recvBuffer.resize(c_helloHeaderSize);
+    ba::async_read(m_socket->ref(), ba::buffer(m_recvBuffer),
+        boost::bind(&PlaintextHandshake::onHelloHeader, shared_from_this(),
+            ba::placeholders::error));
+}
+
+void PlaintextHandshake::onHelloHeader(boost::system::error_code const& _error)
+{
+    if (_error)
+    {
+        finish(_error);
+        return;
+    }
+    auto bodySize = readUint(m_recvBuffer.data() + c_magicSize, 4);
+    if (memcmp(m_recvBuffer.data(), c_magic, c_magicSize) != 0 || bodySize > c_maxHelloSize ||
+        bodySize < c_nonceSize + 1)
+    {
+        finish(protocolError());
+        return;
+    }
+    m_recvBuffer.resize(bodySize);
+    ba::async_read(m_socket->ref(), ba::buffer(m_recvBuffer),
+        boost::bind(
+            &PlaintextHandshake::onHelloBody, shared_from_this(), ba::placeholders::error));
+}
+
+void PlaintextHandshake::onHelloBody(boost::system::error_code const& _error)
+{
+    if (_error)
+    {
+        finish(_error);
+        return;
+    }
+    if (!parseHello(ref(m_recvBuffer)))
+    {
+        finish(protocolError());
+        return;
+    }
+    if (!verifyPeerCertificate())
+    {
+        finish(authError());
+        return;
+    }
+    // sign the nonces with the node key
+    auto content = proofContent(m_client, m_nonce, m_peerNonce);
+    auto key = SSL_CTX_get0_privatekey(m_sslContext->native_handle());
+    std::shared_ptr<EVP_MD_CTX> mdContext(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+    size_t signatureSize = 0;
+    if (EVP_DigestSignInit(mdContext.get(), nullptr, EVP_sha256(), nullptr, key) != 1 ||
+        EVP_DigestSignUpdate(mdContext.get(), content.data(), content.size()) != 1 ||
+        EVP_DigestSignFinal(mdContext.get(), nullptr, &signatureSize) != 1 ||
+        signatureSize > c_maxProofSize)
+    {
+        finish(authError());
+        return;
+    }
+    m_sendBuffer.resize(2 + signatureSize);
+    if (EVP_DigestSignFinal(mdContext.get(), m_sendBuffer.data() + 2, &signatureSize) != 1)
+    {
+        finish(authError());
+        return;
+    }
+    m_sendBuffer.resize(2 + signatureSize);
+    m_sendBuffer[0] = (byte)(signatureSize >> 8);
+    m_sendBuffer[1] = (byte)signatureSize;
+    ba::async_write(m_socket->ref(), ba::buffer(m_sendBuffer),
+        boost::bind(
+            &PlaintextHandshake::onProofWritten, shared_from_this(), ba::placeholders::error));
+}
+
+void PlaintextHandshake::onProofWritten(boost::system::error_code const& _error)
+{
+    if (_error)
+    {
+        finish(_error);
+        return;
+    }
+    m_recvBuffer.resize(2);
+    ba::async_read(m_socket->ref(), ba::buffer(m_recvBuffer),
+        boost::bind(
+            &PlaintextHandshake::onProofHeader, shared_from_this(), ba::placeholders::error));
+}
+
+void PlaintextHandshake::onProofHeader(boost::system::error_code const& _error)
+{
+    if (_error)
+    {
+        finish(_error);
+        return;
+    }
+    auto signatureSize = readUint(m_recvBuffer.data(), 2);
+    if (signatureSize == 0 || signatureSize > c_maxProofSize)
+    {
+        finish(protocolError());
+        return;
+    }
+    m_recvBuffer.resize(signatureSize);
+    ba::async_read(m_socket->ref(), ba::buffer(m_recvBuffer),
+        boost::bind(
+            &PlaintextHandshake::onProofBody, shared_from_this(), ba::placeholders::error));
+}
+
+void PlaintextHandshake::onProofBody(boost::system::error_code const& _error)
+{
+    if (_error)
+    {
+        finish(_error);
+        return;
+    }
+    // the peer signed its nonce and ours with the opposite role
+    auto content = proofContent(!m_client, m_peerNonce, m_nonce);
+    std::shared_ptr<EVP_MD_CTX> mdContext(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+    if (EVP_DigestVerifyInit(mdContext.get(), nullptr, EVP_sha256(), nullptr,
+            X509_get0_pubkey(m_peerCert.get())) != 1 ||
+        EVP_DigestVerifyUpdate(mdContext.get(), content.data(), content.size()) != 1 ||
+        EVP_DigestVerifyFinal(mdContext.get(), m_recvBuffer.data(), m_recvBuffer.size()) != 1)
+    {
+        finish(authError());
+        return;
+    }
+    finish(boost::system::error_code());
+}
+
+bool PlaintextHandshake::parseHello(bytesConstRef _body)
+{
+    m_peerNonce.assign(_body.begin(), _body.begin() + c_nonceSize);
+    size_t offset = c_nonceSize;
+    size_t certCount = _body[offset++];
+    if (certCount == 0 || certCount > c_maxCertCount)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < certCount; ++i)
+    {
+        if (offset + 2 > _body.size())
+        {
+            return false;
+        }
+        auto certSize = readUint(_body.data() + offset, 2);
+        offset += 2;
+        if (offset + certSize > _body.size())
+        {
+            return false;
+        }
+        const byte* data = _body.data() + offset;
+        std::shared_ptr<X509> cert(d2i_X509(nullptr, &data, certSize), X509_free);
+        if (!cert || data != _body.data() + offset + certSize)
+        {
+            return false;
+        }
+        offset += certSize;
+        if (i == 0)
+        {
+            m_peerCert = cert;
+            continue;
+        }
+        m_peerChain.push_back(cert);
+    }
+    return (offset == _body.size());
+}
+
+bool PlaintextHandshake::verifyPeerCertificate()
+{
+    std::shared_ptr<STACK_OF(X509)> chain(sk_X509_new_null(), [](STACK_OF(X509) * _chain) {
+        sk_X509_free(_chain);
+    });
+    for (auto const& cert : m_peerChain)
+    {
+        sk_X509_push(chain.get(), cert.get());
+    }
+    std::shared_ptr<X509_STORE_CTX> storeContext(X509_STORE_CTX_new(), X509_STORE_CTX_free);
+    if (!storeContext ||
+        X509_STORE_CTX_init(storeContext.get(),
+            SSL_CTX_get_cert_store(m_sslContext->native_handle()), m_peerCert.get(),
+            chain.get()) != 1)
+    {
+        return false;
+    }
+    if (X509_verify_cert(storeContext.get()) != 1)
+    {
+        ASIO_LOG(WARNING) << LOG_DESC("PlaintextHandshake: verify the peer certificate failed")
+                          << LOG_KV("error", X509_verify_cert_error_string(
+                                                 X509_STORE_CTX_get_error(storeContext.get())))
+                          << LOG_KV("endpoint", m_socket->nodeIPEndpoint());
+        return false;
+    }
+    return true;
+}
+
+bytes PlaintextHandshake::proofContent(
+    bool _client, bytes const& _signerNonce, bytes const& _verifierNonce) const
+{
+    bytes content(c_proofDomain.begin(), c_proofDomain.end());
+    content.push_back(_client ? 0 : 1);
+    content.insert(content.end(), _signerNonce.begin(), _signerNonce.end());
+    content.insert(content.end(), _verifierNonce.begin(), _verifierNonce.end());
+    return content;
+}
+
+void PlaintextHandshake::finish(boost::system::error_code const& _error)
+{
+    if (m_finished)
+    {
+        return;
+    }
+    m_finished = true;
+    if (m_timer)
+    {
+        m_timer->cancel();
+    }
+    if (_error)
+    {
+        // abort the pending operations
+        m_socket->close();
+        m_handler(_error, nullptr);
+    }
+    else
+    {
+        m_handler(_error, m_peerCert);
+    }
+    m_handler = nullptr;
+}
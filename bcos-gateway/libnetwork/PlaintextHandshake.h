@@ -0,0 +1,117 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: the plaintext transport for the trusted networks, authenticated by signed nonces
+ * @file PlaintextHandshake.h
+ */
+#pragma once
+#include <bcos-framework/libutilities/Common.h>
+#include <bcos-gateway/libnetwork/Common.h>
+#include <bcos-gateway/libnetwork/SocketFace.h>
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/ssl.hpp>
+#include <openssl/x509.h>
+
+namespace bcos
+{
+namespace gateway
+{
+/**
+ * @brief: the networks trusted to transfer the messages in plaintext, e.g. the private vlan of the
+ * gateways in the same rack
+ */
+class PlaintextNetworks
+{
+public:
+    using Ptr = std::shared_ptr<PlaintextNetworks>;
+
+    /// _networks: cidr notations like 10.0.0.0/8 or fd00::/64, the address without the prefix
+    /// length is a single host, throws InvalidParameter if invalid
+    explicit PlaintextNetworks(std::vector<std::string> const& _networks);
+
+    bool contains(bi::address const& _address) const;
+    bool empty() const { return m_networks.empty(); }
+    size_t size() const { return m_networks.size(); }
+
+private:
+    struct Network
+    {
+        bi::address address;
+        uint32_t prefixLength;
+    };
+    std::vector<Network> m_networks;
+};
+
+/**
+ * @brief: authenticate the node identity of the plaintext connection with the certificates and
+ * the keys of the ssl context, without the cost of the tls record encryption
+ *  1. both sides send the hello: magic | length | nonce | certificate chain
+ *  2. both sides verify the certificate chain of the peer with the ca of the ssl context
+ *  3. both sides send the proof: the signature of (domain | role | own nonce | peer nonce) by the
+ *     node key, and verify the proof of the peer with the public key of the peer certificate
+ * the fresh nonces prevent the replay, the role prevents reflecting the proof back to the signer
+ */
+class PlaintextHandshake : public std::enable_shared_from_this<PlaintextHandshake>
+{
+public:
+    using Ptr = std::shared_ptr<PlaintextHandshake>;
+    /// the certificate of the peer is set if succeed
+    using Handler = std::function<void(boost::system::error_code const&, std::shared_ptr<X509>)>;
+
+    /// the magic of the hello, the first byte differs from the tls handshake record(0x16)
+    static constexpr char c_magic[] = "BCOSPTv1";
+    static const size_t c_magicSize = sizeof(c_magic) - 1;
+    static const size_t c_nonceSize = 32;
+
+    PlaintextHandshake(std::shared_ptr<SocketFace> _socket,
+        std::shared_ptr<ba::ssl::context> _sslContext, bool _client, uint32_t _timeout = 10000);
+
+    /// start the handshake, the _handler is called exactly once in the io_service of the socket
+    void start(Handler _handler);
+
+    /// the connection with the first byte starts the plaintext handshake
+    static bool isHello(byte _firstByte) { return _firstByte == (byte)c_magic[0]; }
+
+private:
+    bool buildHello();
+    void onHelloWritten(boost::system::error_code const& _error);
+    void onHelloHeader(boost::system::error_code const& _error);
+    void onHelloBody(boost::system::error_code const& _error);
+    void onProofWritten(boost::system::error_code const& _error);
+    void onProofHeader(boost::system::error_code const& _error);
+    void onProofBody(boost::system::error_code const& _error);
+
+    bool parseHello(bytesConstRef _body);
+    bool verifyPeerCertificate();
+    bytes proofContent(bool _client, bytes const& _signerNonce, bytes const& _verifierNonce) const;
+    void finish(boost::system::error_code const& _error);
+
+    std::shared_ptr<SocketFace> m_socket;
+    std::shared_ptr<ba::ssl::context> m_sslContext;
+    bool m_client;
+    uint32_t m_timeout;
+    std::shared_ptr<ba::deadline_timer> m_timer;
+    Handler m_handler;
+    bool m_finished = false;
+
+    bytes m_nonce;
+    bytes m_peerNonce;
+    bytes m_sendBuffer;
+    bytes m_recvBuffer;
+    std::shared_ptr<X509> m_peerCert;
+    std::vector<std::shared_ptr<X509>> m_peerChain;
+};
+}  // namespace gateway
+}  // namespace bcos
@@ -0,0 +1,135 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: receive buffer of the session
+ * @file RecvBuffer.h
+ */
+#pragma once
+#include <bcos-framework/libutilities/Common.h>
+#include <cstring>
+
+namespace bcos
+{
+namespace gateway
+{
+/**
+ * @brief: growable receive buffer with read and write cursors
+ *  [0, readPos): consumed data
+ *  [readPos, writePos): received data waiting to be decoded
+ *  [writePos, capacity): free space, the socket reads into it directly
+ * the decoded frames are consumed by advancing the read cursor, the pending data is moved to the
+ * front of the buffer only when the free space is not enough for the next read, so every byte
+ * is moved at most once per compaction instead of once per decoded frame.
+ * the messages decoded without copy reference the buffer and hold the chunk(), the referenced
+ * buffer is never overwritten: the pending data is copied to a new buffer instead of being
+ * moved to the front
+ */
+class RecvBuffer
+{
+public:
+    explicit RecvBuffer(size_t _minWritableSize = 4096)
+      : m_buffer(std::make_shared<bytes>(_minWritableSize)), m_minWritableSize(_minWritableSize)
+    {}
+
+    /// the buffer that owns the readableData
+    std::shared_ptr<bytes> const& chunk() const { return m_buffer; }
+
+    /// the received data waiting to be decoded
+    bytesConstRef readableData() const
+    {
+        return bytesConstRef(m_buffer->data() + m_readPos, m_writePos - m_readPos);
+    }
+    size_t readableSize() const { return m_writePos - m_readPos; }
+
+    /// the decoded data
+    void consume(size_t _size)
+    {
+        m_readPos += std::min(_size, readableSize());
+        // the consumed data may be referenced by the decoded messages, keep the cursors
+        if (m_readPos != m_writePos || !exclusive())
+        {
+            return;
+        }
+        m_readPos = 0;
+        m_writePos = 0;
+        // release the memory occupied by the large frames
+        if (m_buffer->size() > c_maxIdleCapacity)
+        {
+            m_buffer = std::make_shared<bytes>(m_minWritableSize);
+        }
+    }
+
+    /// the free space for the next read, at least minWritableSize bytes
+    bytesRef writableBuffer()
+    {
+        if (m_buffer->size() - m_writePos < m_minWritableSize)
+        {
+            compact();
+        }
+        return bytesRef(m_buffer->data() + m_writePos, m_buffer->size() - m_writePos);
+    }
+
+    /// the socket has written _size bytes into the writableBuffer
+    void commit(size_t _size) { m_writePos = std::min(m_writePos + _size, m_buffer->size()); }
+
+    size_t capacity() const { return m_buffer->size(); }
+
+private:
+    // no message references the buffer
+    bool exclusive() const { return m_buffer.use_count() == 1; }
+
+    void compact()
+    {
+        auto pendingSize = readableSize();
+        auto capacity = m_buffer->size();
+        // the pending data occupy more than half of the buffer, grow the buffer
+        bool grow = (pendingSize + m_minWritableSize > capacity / 2);
+        if (!grow && exclusive())
+        {
+            if (pendingSize > 0)
+            {
+                memmove(m_buffer->data(), m_buffer->data() + m_readPos, pendingSize);
+            }
+            m_readPos = 0;
+            m_writePos = pendingSize;
+            return;
+        }
+        size_t newCapacity = capacity;
+        if (grow)
+        {
+            newCapacity = std::max(capacity * 2, pendingSize + m_minWritableSize);
+        }
+        else if (capacity > c_maxIdleCapacity)
+        {
+            newCapacity = std::max(m_minWritableSize, (pendingSize + m_minWritableSize) * 2);
+        }
+        auto newBuffer = std::make_shared<bytes>(newCapacity);
+        if (pendingSize > 0)
+        {
+            memcpy(newBuffer->data(), m_buffer->data() + m_readPos, pendingSize);
+        }
+        m_buffer = newBuffer;
+        m_readPos = 0;
+        m_writePos = pendingSize;
+    }
+
+    std::shared_ptr<bytes> m_buffer;
+    size_t m_readPos = 0;
+    size_t m_writePos = 0;
+    size_t m_minWritableSize;
+    const size_t c_maxIdleCapacity = 1024 * 1024;
+};
+}  // namespace gateway
+}  // namespace bcos
@@ -0,0 +1,198 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: cache of the ssl sessions to resume the handshake of the reconnections
+ * @file SSLSessionCache.cpp
+ */
+#include <bcos-gateway/libnetwork/SSLSessionCache.h>
+#include <chrono>
+#include <sstream>
+
+using namespace bcos;
+using namespace bcos::gateway;
+
+namespace
+{
+const unsigned char c_sessionIDContext[] = "bcos-gateway";
+
+void freeNodeInfo(void*, void* _ptr, CRYPTO_EX_DATA*, int, long, void*)
+{
+    delete (std::string*)_ptr;
+}
+
+// the index of the node info attached to the SSL_SESSION
+int nodeInfoIndex()
+{
+    static int index = SSL_SESSION_get_ex_new_index(0, nullptr, nullptr, nullptr, freeNodeInfo);
+    return index;
+}
+}  // namespace
+
+SSLSessionCache::SSLSessionCache(size_t _capacity, uint32_t _timeoutSeconds)
+  : m_capacity(std::max<size_t>(_capacity, 1)), m_timeoutSeconds(_timeoutSeconds)
+{}
+
+SSLSessionCache::~SSLSessionCache()
+{
+    Guard l(x_clientSessions);
+    for (auto& it : m_clientSessions)
+    {
+        SSL_SESSION_free(it.second);
+    }
+    m_clientSessions.clear();
+}
+
+void SSLSessionCache::attach(SSL_CTX* _sslContext)
+{
+    SSL_CTX_set_session_cache_mode(_sslContext, SSL_SESS_CACHE_SERVER);
+    // the session id context is required to resume the session when verifying the peer
+    SSL_CTX_set_session_id_context(
+        _sslContext, c_sessionIDContext, sizeof(c_sessionIDContext) - 1);
+    SSL_CTX_sess_set_cache_size(_sslContext, m_capacity);
+    SSL_CTX_set_timeout(_sslContext, m_timeoutSeconds);
+    // the stateless tickets drop the node info attached to the session, use the session id
+    SSL_CTX_set_options(_sslContext, SSL_OP_NO_TICKET);
+}
+
+void SSLSessionCache::setClientSession(SSL* _ssl, NodeIPEndpoint const& _endpoint)
+{
+    Guard l(x_clientSessions);
+    auto it = m_clientSessions.find(_endpoint);
+    if (it == m_clientSessions.end())
+    {
+        return;
+    }
+    auto session = it->second;
+    auto now = (uint64_t)time(nullptr);
+    if (now > (uint64_t)SSL_SESSION_get_time(session) + SSL_SESSION_get_timeout(session))
+    {
+        SSL_SESSION_free(session);
+        m_clientSessions.erase(it);
+        return;
+    }
+    SSL_set_session(_ssl, session);
+}
+
+void SSLSessionCache::removeClientSession(NodeIPEndpoint const& _endpoint)
+{
+    Guard l(x_clientSessions);
+    auto it = m_clientSessions.find(_endpoint);
+    if (it != m_clientSessions.end())
+    {
+        SSL_SESSION_free(it->second);
+        m_clientSessions.erase(it);
+    }
+}
+
+void SSLSessionCache::onHandshakeSucceed(
+    SSL* _ssl, NodeIPEndpoint const& _endpoint, bool _client, std::string const& _nodeInfo)
+{
+    if (SSL_session_reused(_ssl))
+    {
+        return;
+    }
+    // the server cache and the client cache hold the same SSL_SESSION object
+    auto session = SSL_get_session(_ssl);
+    if (!session)
+    {
+        return;
+    }
+    auto nodeInfo = (std::string*)SSL_SESSION_get_ex_data(session, nodeInfoIndex());
+    delete nodeInfo;
+    SSL_SESSION_set_ex_data(session, nodeInfoIndex(), new std::string(_nodeInfo));
+    if (!_client)
+    {
+        return;
+    }
+    auto clientSession = SSL_get1_session(_ssl);
+    Guard l(x_clientSessions);
+    auto it = m_clientSessions.find(_endpoint);
+    if (it != m_clientSessions.end())
+    {
+        SSL_SESSION_free(it->second);
+        m_clientSessions.erase(it);
+    }
+    else if (m_clientSessions.size() >= m_capacity)
+    {
+        SSL_SESSION_free(m_clientSessions.begin()->second);
+        m_clientSessions.erase(m_clientSessions.begin());
+    }
+    m_clientSessions[_endpoint] = clientSession;
+}
+
+bool SSLSessionCache::resumedNodeInfo(SSL* _ssl, std::string& _nodeInfo)
+{
+    if (!SSL_session_reused(_ssl))
+    {
+        return false;
+    }
+    auto session = SSL_get_session(_ssl);
+    if (!session)
+    {
+        return false;
+    }
+    auto nodeInfo = (std::string*)SSL_SESSION_get_ex_data(session, nodeInfoIndex());
+    if (!nodeInfo || nodeInfo->empty())
+    {
+        return false;
+    }
+    _nodeInfo = *nodeInfo;
+    return true;
+}
+
+void SSLSessionCache::reportHandshake(bool _resumed, bool _succeed, uint64_t _timeCostUs)
+{
+    if (!_succeed)
+    {
+        m_failedHandshakes++;
+        return;
+    }
+    if (_resumed)
+    {
+        m_resumedHandshakes++;
+        m_resumedHandshakeTimeUs += _timeCostUs;
+        return;
+    }
+    m_fullHandshakes++;
+    m_fullHandshakeTimeUs += _timeCostUs;
+}
+
+void SSLSessionCache::reportReconnect(uint64_t _timeCostUs)
+{
+    m_reconnects++;
+    m_reconnectTimeUs += _timeCostUs;
+}
+
+std::string SSLSessionCache::metrics() const
+{
+    auto average = [](uint64_t _total, uint64_t _count) {
+        return _count == 0 ? 0 : _total / _count;
+    };
+    std::stringstream stream;
+    stream << "fullHandshakes:" << m_fullHandshakes << ",fullAvgUs:"
+           << average(m_fullHandshakeTimeUs, m_fullHandshakes)
+           << ",resumedHandshakes:" << m_resumedHandshakes
+           << ",resumedAvgUs:" << average(m_resumedHandshakeTimeUs, m_resumedHandshakes)
+           << ",failedHandshakes:" << m_failedHandshakes << ",connects:" << m_reconnects
+           << ",connectAvgUs:" << average(m_reconnectTimeUs, m_reconnects);
+    return stream.str();
+}
+
+uint64_t SSLSessionCache::steadyTimeUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
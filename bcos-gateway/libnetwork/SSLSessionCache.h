@@ -0,0 +1,89 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: cache of the ssl sessions to resume the handshake of the reconnections
+ * @file SSLSessionCache.h
+ */
+#pragma once
+#include <bcos-framework/libutilities/Common.h>
+#include <bcos-gateway/libnetwork/Common.h>
+#include <openssl/ssl.h>
+#include <atomic>
+#include <map>
+
+namespace bcos
+{
+namespace gateway
+{
+/**
+ * @brief: resume the ssl sessions by session id to skip the certificate verification
+ *  server side: the sessions are kept in the session cache of the SSL_CTX
+ *  client side: the last session of every endpoint is kept and reused by the reconnection
+ * the identity of the peer(the node info parsed from the certificate by the verify callback) is
+ * attached to the SSL_SESSION, so the resumed handshake gets it without the certificate
+ */
+class SSLSessionCache
+{
+public:
+    using Ptr = std::shared_ptr<SSLSessionCache>;
+
+    SSLSessionCache(size_t _capacity = 1024, uint32_t _timeoutSeconds = 3600);
+    virtual ~SSLSessionCache();
+
+    /// enable the session cache of the ssl context, must be called before any connection
+    virtual void attach(SSL_CTX* _sslContext);
+
+    /// reuse the cached session of _endpoint by the client handshake
+    virtual void setClientSession(SSL* _ssl, NodeIPEndpoint const& _endpoint);
+    /// the resumed handshake failed, do the full handshake next time
+    virtual void removeClientSession(NodeIPEndpoint const& _endpoint);
+
+    /// cache the session and the node info of the peer after the handshake succeed
+    virtual void onHandshakeSucceed(
+        SSL* _ssl, NodeIPEndpoint const& _endpoint, bool _client, std::string const& _nodeInfo);
+
+    /// get the node info of the peer if the session is resumed
+    static bool resumedNodeInfo(SSL* _ssl, std::string& _nodeInfo);
+
+    /// the handshake metrics
+    void reportHandshake(bool _resumed, bool _succeed, uint64_t _timeCostUs);
+    void reportReconnect(uint64_t _timeCostUs);
+    std::string metrics() const;
+
+    size_t clientSessionSize() const
+    {
+        Guard l(x_clientSessions);
+        return m_clientSessions.size();
+    }
+
+    static uint64_t steadyTimeUs();
+
+private:
+    size_t m_capacity;
+    uint32_t m_timeoutSeconds;
+
+    mutable Mutex x_clientSessions;
+    std::map<NodeIPEndpoint, SSL_SESSION*> m_clientSessions;
+
+    std::atomic<uint64_t> m_fullHandshakes = {0};
+    std::atomic<uint64_t> m_fullHandshakeTimeUs = {0};
+    std::atomic<uint64_t> m_resumedHandshakes = {0};
+    std::atomic<uint64_t> m_resumedHandshakeTimeUs = {0};
+    std::atomic<uint64_t> m_failedHandshakes = {0};
+    std::atomic<uint64_t> m_reconnects = {0};
+    std::atomic<uint64_t> m_reconnectTimeUs = {0};
+};
+}  // namespace gateway
+}  // namespace bcos
@@ -0,0 +1,172 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: concurrent table of the response callbacks indexed by seq
+ * @file SeqCallbackTable.cpp
+ */
+#include <bcos-gateway/libnetwork/SeqCallbackTable.h>
+
+using namespace bcos;
+using namespace bcos::gateway;
+
+namespace
+{
+// round up to the power of 2
+size_t slotCount(size_t _capacity)
+{
+    size_t count = 1;
+    while (count < _capacity)
+    {
+        count <<= 1;
+    }
+    return count;
+}
+}  // namespace
+
+SeqCallbackTable::SeqCallbackTable(size_t _capacity)
+  : m_head(slotCount(std::max<size_t>(_capacity, 1)))
+{}
+
+SeqCallbackTable::~SeqCallbackTable()
+{
+    auto level = m_head.next.load(std::memory_order_acquire);
+    while (level)
+    {
+        auto next = level->next.load(std::memory_order_acquire);
+        delete level;
+        level = next;
+    }
+}
+
+SeqCallbackTable::Level* SeqCallbackTable::nextLevel(Level* _level)
+{
+    auto next = _level->next.load(std::memory_order_acquire);
+    if (next)
+    {
+        return next;
+    }
+    auto level = new Level(_level->slots.size() * 2);
+    if (_level->next.compare_exchange_strong(
+            next, level, std::memory_order_acq_rel, std::memory_order_acquire))
+    {
+        return level;
+    }
+    // allocated by another inserter
+    delete level;
+    return next;
+}
+
+bool SeqCallbackTable::insert(uint32_t _seq, ResponseCallback::Ptr _callback)
+{
+    for (auto level = &m_head;; level = nextLevel(level))
+    {
+        auto probe = std::min(c_maxProbe, level->slots.size());
+        for (size_t i = 0; i < probe; ++i)
+        {
+            auto& slot = level->slots[(_seq + i) & level->mask];
+            uint64_t expected = Empty;
+            if (!slot.state.compare_exchange_strong(expected, makeState(_seq, Busy),
+                    std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                continue;
+            }
+            slot.callback = std::move(_callback);
+            slot.state.store(makeState(_seq, Full), std::memory_order_release);
+            m_size.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+}
+
+bool SeqCallbackTable::enter(Slot& _slot, uint32_t _seq, bool _take)
+{
+    auto state = _slot.state.load(std::memory_order_acquire);
+    while (stateSeq(state) == _seq && (state & c_statusMask) == Full)
+    {
+        auto desired = _take ? state - Full + Taken + c_user : state + c_user;
+        if (_slot.state.compare_exchange_weak(
+                state, desired, std::memory_order_acquire, std::memory_order_acquire))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void SeqCallbackTable::leave(Slot& _slot)
+{
+    auto state = _slot.state.fetch_sub(c_user, std::memory_order_acq_rel);
+    // the last user of the taken slot, no one else can access the slot
+    if ((state & c_statusMask) == Taken && (state & c_usersMask) == c_user)
+    {
+        _slot.callback.reset();
+        _slot.state.store(Empty, std::memory_order_release);
+    }
+}
+
+ResponseCallback::Ptr SeqCallbackTable::find(uint32_t _seq, bool _take)
+{
+    for (auto level = &m_head; level; level = level->next.load(std::memory_order_acquire))
+    {
+        auto probe = std::min(c_maxProbe, level->slots.size());
+        for (size_t i = 0; i < probe; ++i)
+        {
+            auto& slot = level->slots[(_seq + i) & level->mask];
+            if (!enter(slot, _seq, _take))
+            {
+                continue;
+            }
+            auto callback = slot.callback;
+            if (_take)
+            {
+                m_size.fetch_sub(1, std::memory_order_relaxed);
+            }
+            leave(slot);
+            return callback;
+        }
+    }
+    return nullptr;
+}
+
+ResponseCallback::Ptr SeqCallbackTable::get(uint32_t _seq)
+{
+    return find(_seq, false);
+}
+
+ResponseCallback::Ptr SeqCallbackTable::take(uint32_t _seq)
+{
+    // return nullptr if another thread has taken it
+    return find(_seq, true);
+}
+
+std::vector<std::pair<uint32_t, ResponseCallback::Ptr>> SeqCallbackTable::takeAll()
+{
+    std::vector<std::pair<uint32_t, ResponseCallback::Ptr>> callbacks;
+    for (auto level = &m_head; level; level = level->next.load(std::memory_order_acquire))
+    {
+        for (auto& slot : level->slots)
+        {
+            auto seq = stateSeq(slot.state.load(std::memory_order_acquire));
+            if (!enter(slot, seq, true))
+            {
+                continue;
+            }
+            callbacks.emplace_back(seq, slot.callback);
+            m_size.fetch_sub(1, std::memory_order_relaxed);
+            leave(slot);
+        }
+    }
+    return callbacks;
+}
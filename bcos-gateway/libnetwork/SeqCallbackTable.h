@@ -0,0 +1,108 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: concurrent table of the response callbacks indexed by seq
+ * @file SeqCallbackTable.h
+ */
+#pragma once
+#include <bcos-gateway/libnetwork/SessionFace.h>
+#include <atomic>
+#include <vector>
+
+namespace bcos
+{
+namespace gateway
+{
+/**
+ * @brief: open addressing table of the response callbacks, indexed by seq & mask
+ * every slot has an atomic state word [seq:32][users:30][status:2], all the operations are CAS on
+ * the state word, no mutex is taken(the callback is copied by the refcount of shared_ptr only):
+ * - insert claims an Empty slot as Busy, writes the callback and publishes it as Full
+ * - get registers itself as a user of the Full slot of the seq, copies the callback and leaves
+ * - take turns the Full slot into Taken as a user, so only one of the concurrent takers gets it
+ * the last user leaving a Taken slot releases the callback and empties the slot, so take never
+ * waits for the readers, the slot is reused once the readers in progress leave.
+ * the whole 32-bit seq is compared, so the seqs with the same index (including the wrapped seqs)
+ * never collide.
+ * the seq is probed in at most c_maxProbe slots of a level, the callbacks can not be placed in
+ * the level go to the next level(twice the slots), which is allocated by CAS when first needed
+ * and kept until the table is destroyed.
+ */
+class SeqCallbackTable
+{
+public:
+    explicit SeqCallbackTable(size_t _capacity = 4096);
+    ~SeqCallbackTable();
+
+    SeqCallbackTable(SeqCallbackTable const&) = delete;
+    SeqCallbackTable& operator=(SeqCallbackTable const&) = delete;
+
+    /// the seq must not be in the table, it is unique by construction(allocated by newSeq of the
+    /// message factory), insert does not search the slots for it
+    bool insert(uint32_t _seq, ResponseCallback::Ptr _callback);
+    ResponseCallback::Ptr get(uint32_t _seq);
+    /// get and remove the callback of _seq, only one of the concurrent callers gets the callback
+    ResponseCallback::Ptr take(uint32_t _seq);
+    /// remove all the callbacks, return them with their seqs
+    std::vector<std::pair<uint32_t, ResponseCallback::Ptr>> takeAll();
+
+    size_t size() const { return m_size.load(std::memory_order_relaxed); }
+
+private:
+    enum Status : uint64_t
+    {
+        Empty = 0,
+        Busy = 1,  // the callback is being written by the inserter
+        Full = 2,
+        Taken = 3,  // removed, the callback is released by the last user leaving
+    };
+    static const uint64_t c_statusMask = 0x3;
+    static const uint64_t c_user = 0x4;
+    static const uint64_t c_usersMask = 0xFFFFFFFC;
+    static uint64_t makeState(uint32_t _seq, Status _status)
+    {
+        return ((uint64_t)_seq << 32) | _status;
+    }
+    static uint32_t stateSeq(uint64_t _state) { return (uint32_t)(_state >> 32); }
+
+    struct Slot
+    {
+        std::atomic<uint64_t> state = {Empty};
+        // written by the inserter of the Busy slot, copied by the users of the Full/Taken slot,
+        // released by the last user of the Taken slot
+        ResponseCallback::Ptr callback;
+    };
+
+    struct Level
+    {
+        explicit Level(size_t _size) : slots(_size), mask(_size - 1) {}
+        std::vector<Slot> slots;
+        size_t mask;
+        std::atomic<Level*> next = {nullptr};
+    };
+
+    /// the next level of _level, allocated if not exists
+    Level* nextLevel(Level* _level);
+    /// register as a user of the Full slot of _seq, and mark it Taken if _take
+    bool enter(Slot& _slot, uint32_t _seq, bool _take);
+    void leave(Slot& _slot);
+    ResponseCallback::Ptr find(uint32_t _seq, bool _take);
+
+    const size_t c_maxProbe = 32;
+    Level m_head;
+    std::atomic<size_t> m_size = {0};
+};
+}  // namespace gateway
+}  // namespace bcos
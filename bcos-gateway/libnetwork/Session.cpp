@@ -14,15 +14,18 @@
 #include <bcos-gateway/libnetwork/SessionFace.h>  // for Respon...
 #include <bcos-gateway/libnetwork/SocketFace.h>   // for Socket...
 #include <chrono>
+#include <sstream>
 
 using namespace bcos;
 using namespace bcos::gateway;
 
-Session::Session(size_t _bufferSize) : bufferSize(_bufferSize)
+Session::Session(size_t _bufferSize)
+  : bufferSize(_bufferSize),
+    m_recvBuffer(_bufferSize),
+    m_reassembler(MessageFragmentConfig().maxReassemblyBytes),
+    m_callbackPool(ObjectPool<ResponseCallback>::create(c_callbackPoolCapacity))
 {
     SESSION_LOG(INFO) << "[Session::Session] this=" << this;
-    m_recvBuffer.resize(bufferSize);
-    m_seq2Callback = std::make_shared<std::unordered_map<uint32_t, ResponseCallback::Ptr>>();
 }
 
 Session::~Session()
@@ -57,6 +60,28 @@ bool Session::actived() const
 }
 
 void Session::asyncSendMessage(Message::Ptr message, Options options, SessionCallbackFunc callback)
+{
+    auto encodedMessage = EncodedMessage::encode(message);
+    if (!encodedMessage)
+    {
+        SESSION_LOG(ERROR) << LOG_DESC("Session encode message failed")
+                           << LOG_KV("seq", message->seq())
+                           << LOG_KV("packetType", message->packetType())
+                           << LOG_KV("endpoint", nodeIPEndpoint());
+        auto server = m_server.lock();
+        if (callback && server)
+        {
+            server->threadPool()->enqueue([callback] {
+                callback(NetworkException(-1, "encode message failed"), Message::Ptr());
+            });
+        }
+        return;
+    }
+    asyncSendEncodedMessage(encodedMessage, options, callback);
+}
+
+void Session::asyncSendEncodedMessage(
+    EncodedMessage::Ptr encodedMessage, Options options, SessionCallbackFunc callback)
 {
     auto server = m_server.lock();
     if (!actived())
@@ -70,47 +95,66 @@ void Session::asyncSendMessage(Message::Ptr message, Options options, SessionCal
         }
         return;
     }
+    auto const& message = encodedMessage->message();
+    auto priority = options.priority;
+    if (priority == MessagePriority::Auto)
+    {
+        priority = WriteQueue::classify(message, encodedMessage->size());
+    }
+    // backpressure: the peer is too slow to receive the messages, let the sender shed or reroute
+    if (m_congested && priority != MessagePriority::Control)
+    {
+        SESSION_LOG(WARNING) << LOG_DESC("Session congested, reject the message")
+                             << LOG_KV("seq", message->seq())
+                             << LOG_KV("packetType", message->packetType())
+                             << LOG_KV("endpoint", nodeIPEndpoint());
+        if (callback)
+        {
+            server->threadPool()->enqueue([callback] {
+                callback(NetworkException(P2PExceptionType::SessionCongested, "SessionCongested"),
+                    Message::Ptr());
+            });
+        }
+        return;
+    }
     if (callback)
     {
-        auto handler = std::make_shared<ResponseCallback>();
+        auto handler = m_callbackPool->acquire();
         handler->callback = callback;
+        handler->m_startTime = utcSteadyTime();
+        addSeqCallback(message->seq(), handler);
         if (options.timeout > 0)
         {
-            std::shared_ptr<boost::asio::deadline_timer> timeoutHandler =
-                server->asioInterface()->newTimer(options.timeout);
-
-            auto session = std::weak_ptr<Session>(shared_from_this());
-            auto seq = message->seq();
-            timeoutHandler->async_wait([session, seq](const boost::system::error_code& _error) {
-                try
-                {
-                    auto s = session.lock();
-                    if (!s)
-                    {
-                        return;
-                    }
-                    s->onTimeout(_error, seq);
-                }
-                catch (std::exception const& e)
-                {
-                    SESSION_LOG(WARNING) << LOG_DESC("async_wait exception")
-                                         << LOG_KV("error", boost::diagnostic_information(e));
-                }
-            });
-            handler->timeoutHandler = timeoutHandler;
-            handler->m_startTime = utcSteadyTime();
+            m_timerWheel->add(shared_from_this(), message->seq(), options.timeout);
         }
-        addSeqCallback(message->seq(), handler);
     }
     SESSION_LOG(TRACE) << LOG_DESC("Session asyncSendMessage")
-                       << LOG_KV("seq2Callback.size", m_seq2Callback->size())
+                       << LOG_KV("seq2Callback.size", m_seq2Callback.size())
                        << LOG_KV("endpoint", nodeIPEndpoint());
-    std::shared_ptr<bytes> p_buffer = std::make_shared<bytes>();
-    message->encode(*p_buffer);
-    send(p_buffer);
+    send(encodedMessage->frame(), priority);
 }
 
-void Session::send(std::shared_ptr<bytes> _msg)
+std::string Session::writeQueueMetrics() const
+{
+    Guard l(x_writeQueue);
+    return m_writeQueue.metrics();
+}
+
+std::string Session::dispatchMetrics()
+{
+    std::stringstream stream;
+    for (size_t i = 0; i < m_dispatchQueues.size(); ++i)
+    {
+        if (m_dispatchQueues[i])
+        {
+            stream << (stream.tellp() > 0 ? "," : "") << DispatchLanes::name((DispatchLane)i)
+                   << ":{" << m_dispatchQueues[i]->toString() << "}";
+        }
+    }
+    return stream.str();
+}
+
+void Session::send(WriteBuffer const& _frame, MessagePriority _priority)
 {
     if (!actived())
     {
@@ -120,17 +164,37 @@ void Session::send(std::shared_ptr<bytes> _msg)
     if (!m_socket->isConnected())
         return;
 
-    SESSION_LOG(TRACE) << "send" << LOG_KV("writeQueue size", m_writeQueue.size());
+    // split the large message, so that the messages of the higher priority classes can be sent
+    // between the fragments of it
+    std::vector<WriteBuffer> fragments;
+    if (m_fragmentSize > 0 && _frame.size() > m_fragmentSize &&
+        supports(P2PFeature::Fragmentation))
+    {
+        fragments = MessageFragmenter::split(_frame, ++m_fragmentID, m_fragmentSize);
+    }
+
+    SESSION_LOG(TRACE) << "send" << LOG_KV("writeQueue size", m_writeQueue.size())
+                       << LOG_KV("fragments", fragments.size());
     {
         Guard l(x_writeQueue);
 
-        m_writeQueue.push(make_pair(_msg, u256(utcTime())));
+        if (fragments.empty())
+        {
+            m_writeQueue.push(_frame, _priority);
+        }
+        // the fragments of the message are queued in order in the same class
+        for (auto& fragment : fragments)
+        {
+            m_writeQueue.push(std::move(fragment), _priority);
+        }
+        updateCongestion();
     }
 
     write();
 }
 
-void Session::onWrite(boost::system::error_code ec, std::size_t, std::shared_ptr<bytes>)
+void Session::onWrite(
+    boost::system::error_code ec, std::size_t, std::shared_ptr<std::vector<WriteBuffer>>)
 {
     if (!actived())
     {
@@ -139,7 +203,7 @@ void Session::onWrite(boost::system::error_code ec, std::size_t, std::shared_ptr
 
     try
     {
-        updateIdleTimer(m_writeIdleTimer);
+        m_lastWriteTime.store(utcSteadyTime(), std::memory_order_relaxed);
         if (ec)
         {
             SESSION_LOG(WARNING) << LOG_DESC("onWrite error sending")
@@ -184,32 +248,42 @@ void Session::write()
 
         m_writing = true;
 
-        std::pair<std::shared_ptr<bytes>, u256> task;
-        u256 enter_time = u256(0);
-
         if (m_writeQueue.empty())
         {
             m_writing = false;
             return;
         }
 
-        task = m_writeQueue.top();
-        m_writeQueue.pop();
-
-        enter_time = task.second;
+        // drain the queued messages(up to m_maxWriteBatchSize) into one gather-write, in the order
+        // scheduled by the priority classes, the payloads are written without copy
+        auto buffers = std::make_shared<std::vector<WriteBuffer>>();
+        std::vector<boost::asio::const_buffer> writeBuffers;
+        size_t writeSize = 0;
+        while (!m_writeQueue.empty() && writeSize < m_maxWriteBatchSize)
+        {
+            auto buffer = m_writeQueue.pop();
+            writeSize += buffer.size();
+            writeBuffers.push_back(boost::asio::buffer(*buffer.buffer));
+            if (!buffer.payload.empty())
+            {
+                writeBuffers.push_back(
+                    boost::asio::buffer(buffer.payload.data(), buffer.payload.size()));
+            }
+            buffers->push_back(std::move(buffer));
+        }
+        updateCongestion();
         auto session = shared_from_this();
-        auto buffer = task.first;
 
         auto server = m_server.lock();
         if (server && server->haveNetwork())
         {
             if (m_socket->isConnected())
             {
-                // asio::buffer referecne buffer, so buffer need alive before
+                // asio::buffer referecne buffer, so buffers need alive before
                 // asio::buffer be used
-                server->asioInterface()->asyncWrite(m_socket, boost::asio::buffer(*buffer),
+                server->asioInterface()->asyncWrite(m_socket, writeBuffers,
                     boost::bind(&Session::onWrite, session, boost::asio::placeholders::error,
-                        boost::asio::placeholders::bytes_transferred, buffer));
+                        boost::asio::placeholders::bytes_transferred, buffers));
             }
             else
             {
@@ -235,20 +309,32 @@ void Session::write()
     }
 }
 
+void Session::updateCongestion()
+{
+    if (!m_congested && m_writeQueue.aboveHighWatermark(m_writeQueueWatermark))
+    {
+        m_congested = true;
+        SESSION_LOG(WARNING) << LOG_DESC("Session congested")
+                             << LOG_KV("queuedMsgs", m_writeQueue.size())
+                             << LOG_KV("queuedBytes", m_writeQueue.bytesSize())
+                             << LOG_KV("endpoint", nodeIPEndpoint());
+    }
+    else if (m_congested && m_writeQueue.belowLowWatermark(m_writeQueueWatermark))
+    {
+        m_congested = false;
+        SESSION_LOG(INFO) << LOG_DESC("Session congestion relieved")
+                          << LOG_KV("queuedMsgs", m_writeQueue.size())
+                          << LOG_KV("queuedBytes", m_writeQueue.bytesSize())
+                          << LOG_KV("endpoint", nodeIPEndpoint());
+    }
+}
+
 void Session::drop(DisconnectReason _reason)
 {
     auto server = m_server.lock();
     if (!m_actived)
         return;
 
-    if (m_readIdleTimer)
-    {
-        m_readIdleTimer->cancel();
-    }
-    if (m_writeIdleTimer)
-    {
-        m_writeIdleTimer->cancel();
-    }
     m_actived = false;
 
     int errorCode = P2PExceptionType::Disconnect;
@@ -261,13 +347,8 @@ void Session::drop(DisconnectReason _reason)
 
     SESSION_LOG(INFO) << "drop, call and erase all callback in this session!"
                       << LOG_KV("endpoint", nodeIPEndpoint());
-    RecursiveGuard l(x_seq2Callback);
-    for (auto& it : *m_seq2Callback)
+    for (auto& it : m_seq2Callback.takeAll())
     {
-        if (it.second->timeoutHandler)
-        {
-            it.second->timeoutHandler->cancel();
-        }
         if (it.second->callback)
         {
             SESSION_LOG(TRACE) << "drop, call callback by seq" << LOG_KV("seq", it.first);
@@ -280,15 +361,18 @@ void Session::drop(DisconnectReason _reason)
             }
         }
     }
-    clearSeqCallback();
 
     if (server && m_messageHandler)
     {
+        // after the control messages received before the disconnection, never dropped
         auto handler = m_messageHandler;
         auto self = shared_from_this();
-        server->threadPool()->enqueue([handler, self, errorCode, errorMsg]() {
-            handler(NetworkException(errorCode, errorMsg), self, Message::Ptr());
-        });
+        dispatch(
+            server, DispatchLane::Control,
+            [handler, self, errorCode, errorMsg]() {
+                handler(NetworkException(errorCode, errorMsg), self, Message::Ptr());
+            },
+            false);
     }
 
     if (m_socket->isConnected())
@@ -312,57 +396,72 @@ void Session::drop(DisconnectReason _reason)
             /// if get Host object failed, close the socket directly
             auto socket = m_socket;
             auto server = m_server.lock();
-            if (server && socket->isConnected())
+            if (!server)
             {
                 socket->close();
+                return;
             }
-            auto shutdown_timer =
-                std::make_shared<boost::asio::deadline_timer>(*server->asioInterface()->ioService(),
-                    boost::posix_time::milliseconds(m_shutDownTimeThres));
-            /// async wait for shutdown
-            shutdown_timer->async_wait([socket](const boost::system::error_code& error) {
-                /// drop operation has been aborted
-                if (error == boost::asio::error::operation_aborted)
+            auto shutDownTimeThres = m_shutDownTimeThres;
+            // close the socket in the io_service the socket bound to
+            server->asioInterface()->socketPost(socket, [socket, server, shutDownTimeThres]() {
+                if (socket->isConnected())
                 {
-                    SESSION_LOG(DEBUG) << "[drop] operation aborted  by async_shutdown"
-                                       << LOG_KV("errorValue", error.value())
-                                       << LOG_KV("message", error.message());
-                    return;
-                }
-                /// shutdown timer error
-                if (error && error != boost::asio::error::operation_aborted)
-                {
-                    SESSION_LOG(WARNING)
-                        << "[drop] shutdown timer error" << LOG_KV("errorValue", error.value())
-                        << LOG_KV("message", error.message());
+                    socket->close();
                 }
-                /// force to shutdown when timeout
-                if (socket->ref().is_open())
+                // no close_notify for the plaintext socket
+                if (socket->plaintext())
                 {
-                    SESSION_LOG(WARNING) << "[drop] timeout, force close the socket"
-                                         << LOG_KV("remote endpoint", socket->nodeIPEndpoint());
-                    socket->close();
+                    return;
                 }
-            });
-
-            /// async shutdown normally
-            socket->sslref().async_shutdown(
-                [socket, shutdown_timer](const boost::system::error_code& error) {
-                    shutdown_timer->cancel();
-                    if (error)
+                // in the io_service of the socket, the socket is never touched by two threads
+                auto shutdown_timer = std::make_shared<boost::asio::deadline_timer>(
+                    socket->ref().get_executor(),
+                    boost::posix_time::milliseconds(shutDownTimeThres));
+                /// async wait for shutdown
+                shutdown_timer->async_wait([socket](const boost::system::error_code& error) {
+                    /// drop operation has been aborted
+                    if (error == boost::asio::error::operation_aborted)
+                    {
+                        SESSION_LOG(DEBUG) << "[drop] operation aborted  by async_shutdown"
+                                           << LOG_KV("errorValue", error.value())
+                                           << LOG_KV("message", error.message());
+                        return;
+                    }
+                    /// shutdown timer error
+                    if (error && error != boost::asio::error::operation_aborted)
                     {
                         SESSION_LOG(WARNING)
-                            << "[drop] shutdown failed " << LOG_KV("errorValue", error.value())
+                            << "[drop] shutdown timer error" << LOG_KV("errorValue", error.value())
                             << LOG_KV("message", error.message());
                     }
-                    /// force to close the socket
+                    /// force to shutdown when timeout
                     if (socket->ref().is_open())
                     {
-                        SESSION_LOG(WARNING) << LOG_DESC("force to shutdown session")
-                                             << LOG_KV("endpoint", socket->nodeIPEndpoint());
+                        SESSION_LOG(WARNING) << "[drop] timeout, force close the socket"
+                                             << LOG_KV("remote endpoint", socket->nodeIPEndpoint());
                         socket->close();
                     }
                 });
+
+                /// async shutdown normally
+                socket->sslref().async_shutdown(
+                    [socket, shutdown_timer](const boost::system::error_code& error) {
+                        shutdown_timer->cancel();
+                        if (error)
+                        {
+                            SESSION_LOG(WARNING)
+                                << "[drop] shutdown failed " << LOG_KV("errorValue", error.value())
+                                << LOG_KV("message", error.message());
+                        }
+                        /// force to close the socket
+                        if (socket->ref().is_open())
+                        {
+                            SESSION_LOG(WARNING) << LOG_DESC("force to shutdown session")
+                                                 << LOG_KV("endpoint", socket->nodeIPEndpoint());
+                            socket->close();
+                        }
+                    });
+            });
         }
         catch (...)
         {
@@ -382,11 +481,15 @@ void Session::start()
         auto server = m_server.lock();
         if (server && server->haveNetwork())
         {
+            m_timerWheel = server->asioInterface()->timerWheel(m_socket);
+            auto now = utcSteadyTime();
+            m_lastReadTime = now;
+            m_lastWriteTime = now;
             m_actived = true;
-            updateIdleTimer(m_writeIdleTimer);
-            updateIdleTimer(m_readIdleTimer);
-            server->asioInterface()->strandPost(
-                boost::bind(&Session::doRead, shared_from_this()));  // doRead();
+            server->asioInterface()->idleSweeper(m_socket)->add(shared_from_this());
+            // the socket is bound to one io_service of the pool, read in the io_service
+            server->asioInterface()->socketPost(
+                m_socket, boost::bind(&Session::doRead, shared_from_this()));  // doRead();
         }
     }
 }
@@ -409,21 +512,34 @@ void Session::doRead()
                     s->drop(TCPError);
                     return;
                 }
-                s->updateIdleTimer(s->m_readIdleTimer);
-                s->m_data.insert(s->m_data.end(), s->m_recvBuffer.begin(),
-                    s->m_recvBuffer.begin() + bytesTransferred);
+                s->m_lastReadTime.store(utcSteadyTime(), std::memory_order_relaxed);
+                s->m_recvBuffer.commit(bytesTransferred);
 
                 while (true)
                 {
-                    Message::Ptr message = s->m_messageFactory->buildMessage();
-                    ssize_t result =
-                        message->decode(bytesConstRef(s->m_data.data(), s->m_data.size()));
+                    Message::Ptr message;
+                    ssize_t result = 0;
+                    if (MessageFragmenter::isFragment(s->m_recvBuffer.readableData()))
+                    {
+                        result = s->decodeFragment(message);
+                    }
+                    else
+                    {
+                        message = s->m_messageFactory->buildMessage();
+                        // decode without copy, the message references the receive buffer
+                        result = message->decode(
+                            s->m_recvBuffer.chunk(), s->m_recvBuffer.readableData());
+                    }
                     if (result > 0)
                     {
                         /// SESSION_LOG(TRACE) << "Decode success: " << result;
-                        NetworkException e(P2PExceptionType::Success, "Success");
-                        s->onMessage(e, message);
-                        s->m_data.erase(s->m_data.begin(), s->m_data.begin() + result);
+                        // no message until the last fragment received
+                        if (message)
+                        {
+                            NetworkException e(P2PExceptionType::Success, "Success");
+                            s->onMessage(e, message);
+                        }
+                        s->m_recvBuffer.consume(result);
                     }
                     else if (result == 0)
                     {
@@ -445,8 +561,10 @@ void Session::doRead()
 
         if (m_socket->isConnected())
         {
+            // read into the free space of the receive buffer directly
+            auto buffer = m_recvBuffer.writableBuffer();
             server->asioInterface()->asyncReadSome(
-                m_socket, boost::asio::buffer(m_recvBuffer, m_recvBuffer.size()), asyncRead);
+                m_socket, boost::asio::buffer(buffer.data(), buffer.size()), asyncRead);
         }
         else
         {
@@ -463,6 +581,32 @@ void Session::doRead()
     }
 }
 
+ssize_t Session::decodeFragment(Message::Ptr& _message)
+{
+    std::shared_ptr<bytes> frame;
+    auto result = m_reassembler.decode(m_recvBuffer.readableData(), frame);
+    if (result < 0)
+    {
+        // the protocol error is reported with an empty message
+        _message = m_messageFactory->buildMessage();
+        return result;
+    }
+    if (result == 0 || !frame)
+    {
+        return result;
+    }
+    _message = m_messageFactory->buildMessage();
+    // the message references the reassembled frame without copy
+    auto frameResult = _message->decode(frame, bytesConstRef(frame->data(), frame->size()));
+    if (frameResult != (ssize_t)frame->size())
+    {
+        SESSION_LOG(ERROR) << LOG_DESC("Decode reassembled message error")
+                           << LOG_KV("result", frameResult) << LOG_KV("size", frame->size());
+        return MessageDecodeStatus::MESSAGE_ERROR;
+    }
+    return result;
+}
+
 bool Session::checkRead(boost::system::error_code _ec)
 {
     if (_ec && _ec.category() != boost::asio::error::get_misc_category() &&
@@ -482,32 +626,18 @@ void Session::onMessage(NetworkException const& e, Message::Ptr message)
     auto server = m_server.lock();
     if (m_actived && server && server->haveNetwork())
     {
-        ResponseCallback::Ptr callbackPtr = getCallbackBySeq(message->seq());
-        if (callbackPtr && message->isRespPacket())
+        // take the callback out, the timeout of the request is ignored after then
+        ResponseCallback::Ptr callbackPtr =
+            message->isRespPacket() ? takeCallbackBySeq(message->seq()) : nullptr;
+        if (callbackPtr)
         {
             /// SESSION_LOG(TRACE) << "Found callbackPtr: " << message->seq();
-
-            if (callbackPtr->timeoutHandler)
-            {
-                callbackPtr->timeoutHandler->cancel();
-            }
-
+            // not queued behind the messages of the session: the handler of a message may be
+            // waiting for this response
             if (callbackPtr->callback)
             {
                 auto callback = callbackPtr->callback;
-                if (callback)
-                {
-                    auto self = std::weak_ptr<Session>(shared_from_this());
-                    server->threadPool()->enqueue([e, callback, self, message]() {
-                        callback(e, message);
-
-                        auto s = self.lock();
-                        if (s)
-                        {
-                            s->removeSeqCallback(message->seq());
-                        }
-                    });
-                }
+                server->threadPool()->enqueue([e, callback, message]() { callback(e, message); });
             }
         }
         else
@@ -518,8 +648,7 @@ void Session::onMessage(NetworkException const& e, Message::Ptr message)
                                    << LOG_KV("message.seq", message->seq());
                 auto session = shared_from_this();
                 auto handler = m_messageHandler;
-
-                server->threadPool()->enqueue(
+                dispatch(server, DispatchLanes::classify(message->packetType()),
                     [session, handler, e, message]() { handler(e, session, message); });
             }
             else
@@ -530,87 +659,90 @@ void Session::onMessage(NetworkException const& e, Message::Ptr message)
     }
 }
 
-void Session::onTimeout(const boost::system::error_code& error, uint32_t seq)
+bool Session::dispatch(std::shared_ptr<Host> const& _server, DispatchLane _lane,
+    std::function<void()> _task, bool _limited)
 {
-    if (error)
+    auto const& queue = m_dispatchQueues[(size_t)_lane];
+    if (queue)
     {
-        SESSION_LOG(TRACE) << "timer cancel" << error;
-        return;
+        auto const& lanes = _server->dispatchLanes();
+        auto queueLimit = lanes->queueLimit(_lane);
+        if (_limited && queueLimit > 0 && queue->depth() >= queueLimit)
+        {
+            lanes->onDropped(_lane);
+            SESSION_LOG(WARNING) << LOG_DESC("drop the message exceeding the dispatch queue limit")
+                                 << LOG_KV("lane", DispatchLanes::name(_lane))
+                                 << LOG_KV("queueLimit", queueLimit)
+                                 << LOG_KV("endpoint", nodeIPEndpoint());
+            return false;
+        }
+        if (queue->post(_task))
+        {
+            return true;
+        }
     }
+    _server->threadPool()->enqueue(std::move(_task));
+    return true;
+}
 
+void Session::onExpired(uint32_t seq)
+{
     auto server = m_server.lock();
     if (!server)
         return;
-    ResponseCallback::Ptr callbackPtr = getCallbackBySeq(seq);
+    // the request has been responded if the callback has been taken
+    ResponseCallback::Ptr callbackPtr = takeCallbackBySeq(seq);
     if (!callbackPtr)
         return;
-    server->threadPool()->enqueue([=]() {
+    server->threadPool()->enqueue([callbackPtr]() {
         NetworkException e(P2PExceptionType::NetworkTimeout, "NetworkTimeout");
         callbackPtr->callback(e, Message::Ptr());
-        removeSeqCallback(seq);
     });
 }
 
-void Session::updateIdleTimer(std::shared_ptr<boost::asio::deadline_timer> _idleTimer)
+bool Session::checkIdle(uint64_t _now)
 {
     if (!m_actived)
     {
-        SESSION_LOG(ERROR) << LOG_DESC("Session inactived");
-
-        return;
-    }
-    if (_idleTimer)
-    {
-        _idleTimer->expires_from_now(boost::posix_time::seconds(m_idleTimeInterval));
-
-        auto session = std::weak_ptr<Session>(shared_from_this());
-        _idleTimer->async_wait([session](const boost::system::error_code& error) {
-            auto s = session.lock();
-            if (s)
-            {
-                s->onIdle(error);
-            }
-        });
+        return false;
     }
-}
-
-void Session::onIdle(const boost::system::error_code& error)
-{
     try
     {
-        if (!m_actived)
-        {
-            SESSION_LOG(ERROR) << LOG_DESC("Session inactived");
-
-            return;
-        }
-        if (error != boost::asio::error::operation_aborted)
+        auto idleTime = m_idleTimeInterval * 1000;
+        auto lastReadTime = m_lastReadTime.load(std::memory_order_relaxed);
+        auto lastWriteTime = m_lastWriteTime.load(std::memory_order_relaxed);
+        if (_now > lastReadTime + idleTime || _now > lastWriteTime + idleTime)
         {
             SESSION_LOG(ERROR) << LOG_DESC("Idle connection, disconnect ")
-                               << LOG_KV("endpoint", m_socket->nodeIPEndpoint());
+                               << LOG_KV("endpoint", m_socket->nodeIPEndpoint())
+                               << LOG_KV("lastReadTime", lastReadTime)
+                               << LOG_KV("lastWriteTime", lastWriteTime);
             drop(IdleWaitTimeout);
+            return false;
         }
     }
     catch (std::exception& e)
     {
-        SESSION_LOG(ERROR) << LOG_DESC("onIdle error")
+        SESSION_LOG(ERROR) << LOG_DESC("checkIdle error")
                            << LOG_KV("errorMessage", boost::diagnostic_information(e));
     }
+    return true;
 }
 
 void Session::setHost(std::weak_ptr<Host> host)
 {
     m_server = host;
-    auto server = m_server.lock();
-    if (server && server->haveNetwork())
+    auto server = host.lock();
+    if (!server || !server->dispatchLanes())
     {
-        m_readIdleTimer =
-            std::make_shared<boost::asio::deadline_timer>(*server->asioInterface()->ioService());
-        m_writeIdleTimer =
-            std::make_shared<boost::asio::deadline_timer>(*server->asioInterface()->ioService());
+        return;
     }
-    else
+    for (size_t i = 0; i < m_dispatchQueues.size(); ++i)
     {
-        SESSION_LOG(ERROR) << LOG_DESC("create idleTimer failed for the host has no network");
+        auto const& executor = server->dispatchLanes()->executor((DispatchLane)i);
+        if (executor)
+        {
+            m_dispatchQueues[i] = executor->newQueue();
+        }
     }
 }
@@ -7,7 +7,6 @@
 #pragma once
 
 #include <bcos-framework/libutilities/Common.h>
-#include <boost/heap/priority_queue.hpp>
 #include <array>
 #include <deque>
 #include <memory>
@@ -16,7 +15,15 @@
 #include <utility>
 
 #include <bcos-gateway/libnetwork/Common.h>
+#include <bcos-gateway/libnetwork/IdleSweeper.h>
+#include <bcos-gateway/libnetwork/MessageFragment.h>
+#include <bcos-gateway/libnetwork/ObjectPool.h>
+#include <bcos-gateway/libnetwork/DispatchLanes.h>
+#include <bcos-gateway/libnetwork/RecvBuffer.h>
+#include <bcos-gateway/libnetwork/SeqCallbackTable.h>
 #include <bcos-gateway/libnetwork/SessionFace.h>
+#include <bcos-gateway/libnetwork/TimerWheel.h>
+#include <bcos-gateway/libnetwork/WriteQueue.h>
 
 namespace bcos
 {
@@ -25,24 +32,55 @@ namespace gateway
 class Host;
 class SocketFace;
 
-class Session : public SessionFace, public std::enable_shared_from_this<Session>
+class Session : public SessionFace,
+                public TimerWheelHandler,
+                public IdleCheckable,
+                public std::enable_shared_from_this<Session>
 {
 public:
     Session(size_t _bufferSize = 4096);
     virtual ~Session();
 
     using Ptr = std::shared_ptr<Session>;
+    /// the idle response callbacks kept for reuse by each session
+    const static size_t c_callbackPoolCapacity = 256;
 
     void start() override;
     void disconnect(DisconnectReason _reason) override;
 
     void asyncSendMessage(
         Message::Ptr, Options = Options(), SessionCallbackFunc = SessionCallbackFunc()) override;
+    void asyncSendEncodedMessage(EncodedMessage::Ptr, Options = Options(),
+        SessionCallbackFunc = SessionCallbackFunc()) override;
 
     NodeIPEndpoint nodeIPEndpoint() const override;
 
     bool actived() const override;
 
+    std::string writeQueueMetrics() const override;
+    std::string dispatchMetrics() override;
+    bool congested() const override { return m_congested; }
+
+    uint16_t protocolVersion() const override { return m_protocolVersion; }
+    uint32_t features() const override { return m_features; }
+    void setProtocol(uint16_t _version, uint32_t _features) override
+    {
+        m_protocolVersion = _version;
+        m_features = _features;
+    }
+
+    virtual void setWriteQueueWatermark(WriteQueueWatermark const& _watermark)
+    {
+        m_writeQueueWatermark = _watermark;
+    }
+    /// must be set before the session started, _budget is shared by the sessions of the host
+    virtual void setFragmentConfig(
+        MessageFragmentConfig const& _config, ReassemblyBudget::Ptr _budget)
+    {
+        m_fragmentSize = _config.fragmentSize;
+        m_reassembler.setBudget(std::move(_budget));
+    }
+
     virtual std::weak_ptr<Host> host() { return m_server; }
     virtual void setHost(std::weak_ptr<Host> host);
 
@@ -68,41 +106,38 @@ public:
 
     virtual void addSeqCallback(uint32_t seq, ResponseCallback::Ptr callback)
     {
-        RecursiveGuard l(x_seq2Callback);
-        m_seq2Callback->insert(std::make_pair(seq, callback));
-    }
-    virtual void removeSeqCallback(uint32_t seq)
-    {
-        RecursiveGuard l(x_seq2Callback);
-        m_seq2Callback->erase(seq);
-    }
-    virtual void clearSeqCallback()
-    {
-        RecursiveGuard l(x_seq2Callback);
-        m_seq2Callback->clear();
+        m_seq2Callback.insert(seq, callback);
     }
+    virtual void removeSeqCallback(uint32_t seq) { m_seq2Callback.take(seq); }
+    virtual void clearSeqCallback() { m_seq2Callback.takeAll(); }
 
-    ResponseCallback::Ptr getCallbackBySeq(uint32_t seq)
-    {
-        RecursiveGuard l(x_seq2Callback);
-        auto it = m_seq2Callback->find(seq);
-        if (it != m_seq2Callback->end())
-        {
-            return it->second;
-        }
-        else
-        {
-            return NULL;
-        }
-    }
+    ResponseCallback::Ptr getCallbackBySeq(uint32_t seq) { return m_seq2Callback.get(seq); }
+
+    /// get and remove the callback, only one of the response and the timeout gets the callback
+    ResponseCallback::Ptr takeCallbackBySeq(uint32_t seq) { return m_seq2Callback.take(seq); }
+
+    /// the request of seq timed out
+    void onExpired(uint32_t seq) override;
+
+    /// drop the session if no data read or written in m_idleTimeInterval
+    bool checkIdle(uint64_t _now) override;
 
 private:
-    void send(std::shared_ptr<bytes> _msg);
+    void send(WriteBuffer const& _frame, MessagePriority _priority);
 
     void doRead();
-    std::vector<byte> m_data;  ///< Buffer for ingress packet data.
-    std::vector<byte> m_recvBuffer;
+    // decode the fragment at the front of the receive buffer, _message is set when the last
+    // fragment of the message is received
+    ssize_t decodeFragment(Message::Ptr& _message);
     const size_t bufferSize;
+    ///< Buffer for ingress packet data.
+    RecvBuffer m_recvBuffer;
+    // the messages larger than m_fragmentSize are sent in fragments if the peer supports, 0 means
+    // disable
+    size_t m_fragmentSize = 0;
+    std::atomic<uint32_t> m_fragmentID = {0};
+    // reassemble the fragments received, only accessed by the read handler
+    MessageReassembler m_reassembler;
 
     /// Drop the connection for the reason @a _r.
     void drop(DisconnectReason _r);
@@ -110,55 +145,59 @@ private:
     /// Check error code after reading and drop peer if error code.
     bool checkRead(boost::system::error_code _ec);
 
-    void onTimeout(const boost::system::error_code& error, uint32_t seq);
-    void updateIdleTimer(std::shared_ptr<boost::asio::deadline_timer> _idleTimer);
-    void onIdle(const boost::system::error_code& error);
 
     /// Perform a single round of the write operation. This could end up calling
     /// itself asynchronously.
-    void onWrite(boost::system::error_code ec, std::size_t length, std::shared_ptr<bytes> buffer);
+    void onWrite(boost::system::error_code ec, std::size_t length,
+        std::shared_ptr<std::vector<WriteBuffer>> buffers);
     void write();
+    // update the congestion state by the watermarks, called with x_writeQueue locked
+    void updateCongestion();
 
     /// call by doRead() to deal with mesage
     void onMessage(NetworkException const& e, Message::Ptr message);
+    /// run the task after the messages dispatched to the lane before, in the thread pool if the
+    /// lane has no executor, false if dropped for exceeding the queue limit of the lane
+    bool dispatch(std::shared_ptr<Host> const& _server, DispatchLane _lane,
+        std::function<void()> _task, bool _limited = true);
 
     std::weak_ptr<Host> m_server;          ///< The host that owns us. Never null.
     std::shared_ptr<SocketFace> m_socket;  ///< Socket of peer's connection.
 
     MessageFactory::Ptr m_messageFactory;
 
-    class QueueCompare
-    {
-    public:
-        bool operator()(const std::pair<std::shared_ptr<bytes>, u256>&,
-            const std::pair<std::shared_ptr<bytes>, u256>&) const
-        {
-            return false;
-        }
-    };
-
-    boost::heap::priority_queue<std::pair<std::shared_ptr<bytes>, u256>,
-        boost::heap::compare<QueueCompare>, boost::heap::stable<true>>
-        m_writeQueue;
+    WriteQueue m_writeQueue;
     std::atomic_bool m_writing = {false};
-    bcos::Mutex x_writeQueue;
+    mutable bcos::Mutex x_writeQueue;
+    WriteQueueWatermark m_writeQueueWatermark;
+    std::atomic_bool m_congested = {false};
+    // negotiated by the handshake
+    std::atomic<uint16_t> m_protocolVersion = {c_legacyProtocolVersion};
+    std::atomic<uint32_t> m_features = {0};
+    // the max size of the messages sent by one write
+    size_t m_maxWriteBatchSize = 1024 * 1024;
 
     mutable bcos::Mutex x_info;
 
     bool m_actived = false;
 
     ///< A call B, the function to call after the response is received by A.
-    mutable bcos::RecursiveMutex x_seq2Callback;
-    std::shared_ptr<std::unordered_map<uint32_t, ResponseCallback::Ptr>> m_seq2Callback;
+    SeqCallbackTable m_seq2Callback;
+    // the response callbacks recycled when taken out of m_seq2Callback and released
+    ObjectPool<ResponseCallback>::Ptr m_callbackPool;
 
     std::function<void(NetworkException, SessionFace::Ptr, Message::Ptr)> m_messageHandler;
+    // the messages handled by m_messageHandler in the received order, one queue per lane
+    std::array<OrderedExecutor::Queue::Ptr, DispatchLanes::c_laneCount> m_dispatchQueues;
+    // expire the requests timeout, shared by the sessions of the same io_service
+    TimerWheel::Ptr m_timerWheel;
     uint64_t m_shutDownTimeThres = 50000;
     // 1min
     uint64_t m_idleTimeInterval = 60;
 
-    // timer to check the connection
-    std::shared_ptr<boost::asio::deadline_timer> m_readIdleTimer;
-    std::shared_ptr<boost::asio::deadline_timer> m_writeIdleTimer;
+    // the last time(steady, ms) of reading and writing data, checked by the idle sweeper
+    std::atomic<uint64_t> m_lastReadTime = {0};
+    std::atomic<uint64_t> m_lastWriteTime = {0};
 };
 
 class SessionFactory
@@ -173,8 +212,28 @@ public:
         session->setHost(_server);
         session->setSocket(_socket);
         session->setMessageFactory(_messageFactory);
+        session->setWriteQueueWatermark(m_writeQueueWatermark);
+        session->setFragmentConfig(m_fragmentConfig, m_reassemblyBudget);
         return session;
     }
+
+    virtual void setWriteQueueWatermark(WriteQueueWatermark const& _watermark)
+    {
+        m_writeQueueWatermark = _watermark;
+    }
+
+    virtual void setFragmentConfig(MessageFragmentConfig const& _config)
+    {
+        m_fragmentConfig = _config;
+        m_reassemblyBudget = std::make_shared<ReassemblyBudget>(_config.maxReassemblyBytes);
+    }
+
+private:
+    WriteQueueWatermark m_writeQueueWatermark;
+    MessageFragmentConfig m_fragmentConfig;
+    // the reassembly memory of all the sessions created by the factory(one factory per host)
+    ReassemblyBudget::Ptr m_reassemblyBudget =
+        std::make_shared<ReassemblyBudget>(MessageFragmentConfig().maxReassemblyBytes);
 };
 
 }  // namespace gateway
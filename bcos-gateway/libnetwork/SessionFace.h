@@ -31,7 +31,13 @@ struct ResponseCallback : public std::enable_shared_from_this<ResponseCallback>
 
     uint64_t m_startTime;
     SessionCallbackFunc callback;
-    std::shared_ptr<boost::asio::deadline_timer> timeoutHandler;
+
+    /// release the callback to be reused by the ObjectPool
+    void reset()
+    {
+        m_startTime = 0;
+        callback = nullptr;
+    }
 };
 
 class SessionFace
@@ -46,6 +52,9 @@ public:
 
     virtual void asyncSendMessage(
         Message::Ptr, Options = Options(), SessionCallbackFunc = SessionCallbackFunc()) = 0;
+    /// send the message encoded in advance, the encoded message can be shared by many sessions
+    virtual void asyncSendEncodedMessage(EncodedMessage::Ptr, Options = Options(),
+        SessionCallbackFunc = SessionCallbackFunc()) = 0;
 
     virtual std::shared_ptr<SocketFace> socket() = 0;
 
@@ -56,6 +65,20 @@ public:
     virtual NodeIPEndpoint nodeIPEndpoint() const = 0;
 
     virtual bool actived() const = 0;
+
+    /// the depth of the priority classes of the write queue
+    virtual std::string writeQueueMetrics() const = 0;
+    /// the depth and the latency of the messages dispatched, the max are reset by every call
+    virtual std::string dispatchMetrics() = 0;
+    /// the write queue exceeds the high watermark, only the control messages are accepted
+    virtual bool congested() const = 0;
+
+    /// the protocol version and the P2PFeature negotiated with the peer by the handshake, the
+    /// legacy version without any feature until negotiated
+    virtual uint16_t protocolVersion() const = 0;
+    virtual uint32_t features() const = 0;
+    virtual void setProtocol(uint16_t _version, uint32_t _features) = 0;
+    bool supports(P2PFeature _feature) const { return (features() & _feature) == _feature; }
 };
 }  // namespace gateway
 }  // namespace bcos
@@ -44,6 +44,13 @@ public:
         try
         {
             boost::system::error_code ec;
+            // openssl drops the session of the connection closed without close_notify from the
+            // session cache, mark the established connection shutdown to keep it resumable
+            auto ssl = m_sslSocket->native_handle();
+            if (SSL_is_init_finished(ssl))
+            {
+                SSL_set_shutdown(ssl, SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+            }
             m_sslSocket->lowest_layer().shutdown(bi::tcp::socket::shutdown_both, ec);
             if (m_sslSocket->lowest_layer().is_open())
                 m_sslSocket->lowest_layer().close();
@@ -68,6 +75,9 @@ public:
     bi::tcp::socket& ref() override { return m_sslSocket->next_layer(); }
     ba::ssl::stream<bi::tcp::socket>& sslref() override { return *m_sslSocket; }
 
+    bool plaintext() const override { return m_plaintext; }
+    void setPlaintext(bool _plaintext) override { m_plaintext = _plaintext; }
+
     const NodeIPEndpoint& nodeIPEndpoint() const override { return m_nodeIPEndpoint; }
     void setNodeIPEndpoint(NodeIPEndpoint _nodeIPEndpoint) override
     {
@@ -77,6 +87,7 @@ public:
 protected:
     NodeIPEndpoint m_nodeIPEndpoint;
     std::shared_ptr<ba::ssl::stream<bi::tcp::socket>> m_sslSocket;
+    bool m_plaintext = false;
 };
 
 }  // namespace gateway
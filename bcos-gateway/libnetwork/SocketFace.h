@@ -30,6 +30,10 @@ public:
     virtual bi::tcp::socket& ref() = 0;
     virtual ba::ssl::stream<bi::tcp::socket>& sslref() = 0;
 
+    /// the plaintext socket transfers the messages through ref() instead of sslref()
+    virtual bool plaintext() const = 0;
+    virtual void setPlaintext(bool _plaintext) = 0;
+
     virtual const NodeIPEndpoint& nodeIPEndpoint() const = 0;
     virtual void setNodeIPEndpoint(NodeIPEndpoint _nodeIPEndpoint) = 0;
 };
@@ -0,0 +1,143 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: timer wheel to expire the request timeouts in bulk
+ * @file TimerWheel.cpp
+ */
+#include <bcos-gateway/libnetwork/Common.h>
+#include <bcos-gateway/libnetwork/TimerWheel.h>
+#include <boost/asio/post.hpp>
+
+using namespace bcos;
+using namespace bcos::gateway;
+
+TimerWheel::TimerWheel(
+    std::shared_ptr<boost::asio::io_service> _ioService, uint64_t _tickMs, size_t _slotCount)
+  : m_ioService(_ioService),
+    m_timer(*_ioService),
+    m_tickMs(std::max<uint64_t>(_tickMs, 1)),
+    m_slots(std::max<size_t>(_slotCount, 1)),
+    m_currentTick(utcSteadyTime() / m_tickMs)
+{}
+
+void TimerWheel::add(std::weak_ptr<TimerWheelHandler> _handler, uint32_t _seq, uint64_t _timeout)
+{
+    auto deadline = utcSteadyTime() + _timeout;
+    bool startTicking = false;
+    {
+        Guard l(x_slots);
+        // round up, never expire before the deadline
+        auto tick = std::max((deadline + m_tickMs - 1) / m_tickMs, m_currentTick + 1);
+        m_slots[tick % m_slots.size()].push_back(Entry{std::move(_handler), _seq, deadline});
+        m_size++;
+        if (!m_ticking)
+        {
+            m_ticking = true;
+            startTicking = true;
+        }
+    }
+    if (startTicking)
+    {
+        // the timer is only touched by the io_service thread
+        auto self = std::weak_ptr<TimerWheel>(shared_from_this());
+        boost::asio::post(*m_ioService, [self]() {
+            auto wheel = self.lock();
+            if (wheel)
+            {
+                wheel->schedule();
+            }
+        });
+    }
+}
+
+void TimerWheel::schedule()
+{
+    m_timer.expires_from_now(boost::posix_time::milliseconds(m_tickMs));
+    auto self = std::weak_ptr<TimerWheel>(shared_from_this());
+    m_timer.async_wait([self](const boost::system::error_code& _error) {
+        auto wheel = self.lock();
+        if (!wheel || _error == boost::asio::error::operation_aborted)
+        {
+            return;
+        }
+        wheel->expire(utcSteadyTime());
+        {
+            Guard l(wheel->x_slots);
+            if (wheel->m_size == 0)
+            {
+                wheel->m_ticking = false;
+                return;
+            }
+        }
+        wheel->schedule();
+    });
+}
+
+size_t TimerWheel::expire(uint64_t _now)
+{
+    Guard expireGuard(x_expire);
+    {
+        Guard l(x_slots);
+        auto nowTick = _now / m_tickMs;
+        if (nowTick <= m_currentTick)
+        {
+            return 0;
+        }
+        // visit every slot at most once even if the wheel has been stopped for a long time
+        auto ticks = std::min<uint64_t>(nowTick - m_currentTick, m_slots.size());
+        for (uint64_t i = 1; i <= ticks; ++i)
+        {
+            auto& slot = m_slots[(m_currentTick + i) % m_slots.size()];
+            size_t kept = 0;
+            for (size_t j = 0; j < slot.size(); ++j)
+            {
+                if (slot[j].deadline <= _now)
+                {
+                    m_expired.push_back(std::move(slot[j]));
+                    continue;
+                }
+                if (kept != j)
+                {
+                    slot[kept] = std::move(slot[j]);
+                }
+                kept++;
+            }
+            slot.resize(kept);
+        }
+        m_currentTick = nowTick;
+        m_size -= m_expired.size();
+    }
+    auto expiredCount = m_expired.size();
+    for (auto& entry : m_expired)
+    {
+        auto handler = entry.handler.lock();
+        if (handler)
+        {
+            handler->onExpired(entry.seq);
+        }
+    }
+    m_expired.clear();
+    return expiredCount;
+}
+
+void TimerWheel::stop()
+{
+    Guard l(x_slots);
+    for (auto& slot : m_slots)
+    {
+        slot.clear();
+    }
+    m_size = 0;
+}
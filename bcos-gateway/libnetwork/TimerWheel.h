@@ -0,0 +1,96 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: timer wheel to expire the request timeouts in bulk
+ * @file TimerWheel.h
+ */
+#pragma once
+#include <bcos-framework/libutilities/Common.h>
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/io_service.hpp>
+#include <memory>
+#include <vector>
+
+namespace bcos
+{
+namespace gateway
+{
+class TimerWheelHandler
+{
+public:
+    virtual ~TimerWheelHandler() {}
+    /// the request identified by _seq timed out
+    virtual void onExpired(uint32_t _seq) = 0;
+};
+
+/**
+ * @brief: hashed timer wheel driven by one deadline_timer of the io_service
+ * every request with timeout adds an entry(handler, seq, deadline) into the slot of its deadline,
+ * the slots are reused vectors, so no timer and no allocation per request. the entry is not
+ * removed when the response arrives, the expired entry whose request has been responded is just
+ * ignored by the handler.
+ * the wheel covers tickMs * slotCount milliseconds, the entries with longer timeout stay in the
+ * slot until their deadline reached.
+ */
+class TimerWheel : public std::enable_shared_from_this<TimerWheel>
+{
+public:
+    using Ptr = std::shared_ptr<TimerWheel>;
+
+    TimerWheel(std::shared_ptr<boost::asio::io_service> _ioService, uint64_t _tickMs = 10,
+        size_t _slotCount = 1024);
+    virtual ~TimerWheel() {}
+
+    /// _handler->onExpired(_seq) is called in the io_service after _timeout milliseconds
+    virtual void add(std::weak_ptr<TimerWheelHandler> _handler, uint32_t _seq, uint64_t _timeout);
+    /// drop all the entries
+    virtual void stop();
+
+    /// expire the entries whose deadline is no later than _now, return the number of them
+    size_t expire(uint64_t _now);
+
+    size_t size() const
+    {
+        Guard l(x_slots);
+        return m_size;
+    }
+
+private:
+    struct Entry
+    {
+        std::weak_ptr<TimerWheelHandler> handler;
+        uint32_t seq;
+        uint64_t deadline;
+    };
+
+    void schedule();
+
+    std::shared_ptr<boost::asio::io_service> m_ioService;
+    boost::asio::deadline_timer m_timer;
+    uint64_t m_tickMs;
+
+    mutable Mutex x_slots;
+    std::vector<std::vector<Entry>> m_slots;
+    // all the ticks no later than m_currentTick have been expired
+    uint64_t m_currentTick;
+    size_t m_size = 0;
+    // the tick timer is armed only when there are entries
+    bool m_ticking = false;
+    // reused to collect the expired entries, only accessed by expire
+    std::vector<Entry> m_expired;
+    Mutex x_expire;
+};
+}  // namespace gateway
+}  // namespace bcos
@@ -0,0 +1,152 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: write queue of the session, schedule the messages by priority class
+ * @file WriteQueue.cpp
+ */
+#include <bcos-gateway/libnetwork/WriteQueue.h>
+#include <sstream>
+
+using namespace bcos;
+using namespace bcos::gateway;
+
+WriteQueue::WriteQueue(size_t _quantum) : m_quantum(std::max<size_t>(_quantum, 1))
+{
+    m_bytesSizes.fill(0);
+    m_deficits.fill(0);
+}
+
+MessagePriority WriteQueue::classify(Message::Ptr const& _message, size_t _encodedSize)
+{
+    switch (_message->packetType())
+    {
+    case MessageType::Handshake:
+    case MessageType::Heartbeat:
+    case MessageType::RequestNodeIDs:
+    case MessageType::ResponseNodeIDs:
+        return MessagePriority::Control;
+    default:
+        break;
+    }
+    if (_encodedSize >= c_bulkMinSize)
+    {
+        return MessagePriority::Bulk;
+    }
+    // the peer is waiting for the response, but a flood of responses must not starve consensus
+    if (_message->isRespPacket())
+    {
+        return MessagePriority::Response;
+    }
+    if (_message->packetType() == MessageType::AMOPMessageType)
+    {
+        return MessagePriority::AMOP;
+    }
+    if (_encodedSize <= c_consensusMaxSize)
+    {
+        return MessagePriority::Consensus;
+    }
+    return MessagePriority::Normal;
+}
+
+void WriteQueue::push(WriteBuffer _buffer, MessagePriority _priority)
+{
+    auto i = index(_priority);
+    m_bytesSizes[i] += _buffer.size();
+    m_bytesSize += _buffer.size();
+    m_size++;
+    m_queues[i].push_back(Item{std::move(_buffer), utcSteadyTime()});
+}
+
+WriteBuffer WriteQueue::popFront(size_t _index)
+{
+    auto& queue = m_queues[_index];
+    auto buffer = std::move(queue.front().buffer);
+    queue.pop_front();
+    m_bytesSizes[_index] -= buffer.size();
+    m_bytesSize -= buffer.size();
+    m_size--;
+    return buffer;
+}
+
+WriteBuffer WriteQueue::pop()
+{
+    if (m_size == 0)
+    {
+        return WriteBuffer();
+    }
+    auto control = (size_t)MessagePriority::Control;
+    if (!m_queues[control].empty())
+    {
+        return popFront(control);
+    }
+    // only one class is waiting, no need to wait for the deficit accumulating
+    for (size_t i = control + 1; i < c_classCount; ++i)
+    {
+        if (m_queues[i].size() == m_size)
+        {
+            m_deficits[i] = 0;
+            return popFront(i);
+        }
+    }
+    while (true)
+    {
+        auto& queue = m_queues[m_current];
+        if (!queue.empty())
+        {
+            if (!m_inTurn)
+            {
+                m_deficits[m_current] += m_quantum * m_weights[m_current];
+                m_inTurn = true;
+            }
+            auto frontSize = queue.front().buffer.size();
+            if (m_deficits[m_current] >= frontSize)
+            {
+                m_deficits[m_current] -= frontSize;
+                auto buffer = popFront(m_current);
+                if (queue.empty())
+                {
+                    m_deficits[m_current] = 0;
+                }
+                return buffer;
+            }
+        }
+        else
+        {
+            m_deficits[m_current] = 0;
+        }
+        // the turn of the current class is over
+        m_inTurn = false;
+        m_current = (m_current + 1 < c_classCount) ? (m_current + 1) : (control + 1);
+    }
+}
+
+std::string WriteQueue::metrics() const
+{
+    static const std::array<std::string, c_classCount> names = {
+        "control", "consensus", "response", "normal", "amop", "bulk"};
+    auto now = utcSteadyTime();
+    std::stringstream stream;
+    for (size_t i = 0; i < c_classCount; ++i)
+    {
+        uint64_t waitTime = 0;
+        if (!m_queues[i].empty() && now > m_queues[i].front().enqueueTime)
+        {
+            waitTime = now - m_queues[i].front().enqueueTime;
+        }
+        stream << (i == 0 ? "" : ",") << names[i] << ":" << m_queues[i].size() << "/"
+               << m_bytesSizes[i] << "B/" << waitTime << "ms";
+    }
+    return stream.str();
+}
@@ -0,0 +1,121 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: write queue of the session, schedule the messages by priority class
+ * @file WriteQueue.h
+ */
+#pragma once
+#include <bcos-framework/libutilities/Common.h>
+#include <bcos-gateway/libnetwork/Common.h>
+#include <bcos-gateway/libnetwork/Message.h>
+#include <array>
+#include <deque>
+
+namespace bcos
+{
+namespace gateway
+{
+/**
+ * @brief: the session is congested when the queued messages or bytes exceed the high watermark,
+ * and the non-control messages are rejected until the queue drains below the low watermarks
+ */
+struct WriteQueueWatermark
+{
+    size_t highBytes = 64 * 1024 * 1024;
+    size_t lowBytes = 32 * 1024 * 1024;
+    size_t highMessages = 100000;
+    size_t lowMessages = 50000;
+};
+
+/**
+ * @brief: the messages waiting to be sent are queued by MessagePriority
+ *  Control: handshake, heartbeat and node discovery, always sent first
+ *  Consensus/Response/Normal/AMOP/Bulk: scheduled by deficit round robin, every class gets at least
+ *  weight * quantum bytes per round, so the bulk messages(e.g. block sync) never starve and never
+ *  block the consensus messages for more than one message
+ * the WriteQueue is not thread-safe, the session protects it with x_writeQueue
+ */
+class WriteQueue
+{
+public:
+    // the messages no larger than c_consensusMaxSize are treated as the consensus messages
+    const static size_t c_consensusMaxSize = 64 * 1024;
+    // the messages no smaller than c_bulkMinSize are treated as the bulk messages
+    const static size_t c_bulkMinSize = 1024 * 1024;
+
+    explicit WriteQueue(size_t _quantum = 16 * 1024);
+
+    /// choose the priority class by the packet type and the encoded size of the message
+    static MessagePriority classify(Message::Ptr const& _message, size_t _encodedSize);
+
+    void push(WriteBuffer _buffer, MessagePriority _priority);
+    void push(std::shared_ptr<bytes> _buffer, MessagePriority _priority)
+    {
+        push(WriteBuffer{std::move(_buffer), bytesConstRef(), nullptr}, _priority);
+    }
+    /// pop the next message to be sent, the buffer is nullptr when the queue is empty
+    WriteBuffer pop();
+
+    bool empty() const { return m_size == 0; }
+    size_t size() const { return m_size; }
+    size_t bytesSize() const { return m_bytesSize; }
+    size_t size(MessagePriority _priority) const { return m_queues[index(_priority)].size(); }
+    size_t bytesSize(MessagePriority _priority) const { return m_bytesSizes[index(_priority)]; }
+
+    bool aboveHighWatermark(WriteQueueWatermark const& _watermark) const
+    {
+        return m_bytesSize > _watermark.highBytes || m_size > _watermark.highMessages;
+    }
+    bool belowLowWatermark(WriteQueueWatermark const& _watermark) const
+    {
+        return m_bytesSize <= _watermark.lowBytes && m_size <= _watermark.lowMessages;
+    }
+
+    /// the depth, bytes and the waiting time(ms) of the oldest message of every class
+    std::string metrics() const;
+
+private:
+    struct Item
+    {
+        WriteBuffer buffer;
+        uint64_t enqueueTime;
+    };
+    const static size_t c_classCount = (size_t)MessagePriority::Count;
+
+    static size_t index(MessagePriority _priority)
+    {
+        if (_priority < MessagePriority::Control || _priority >= MessagePriority::Count)
+        {
+            return (size_t)MessagePriority::Normal;
+        }
+        return (size_t)_priority;
+    }
+    WriteBuffer popFront(size_t _index);
+
+    std::array<std::deque<Item>, c_classCount> m_queues;
+    std::array<size_t, c_classCount> m_bytesSizes;
+    // weight of the classes scheduled by deficit round robin, Control is not included
+    std::array<size_t, c_classCount> m_weights = {0, 8, 4, 4, 2, 1};
+    std::array<size_t, c_classCount> m_deficits;
+    size_t m_quantum;
+    // the class of the current round robin turn
+    size_t m_current = (size_t)MessagePriority::Consensus;
+    bool m_inTurn = false;
+
+    size_t m_size = 0;
+    size_t m_bytesSize = 0;
+};
+}  // namespace gateway
+}  // namespace bcos
@@ -0,0 +1,256 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: the rtt, loss and load of the link with one peer gateway
+ * @file LinkQuality.cpp
+ */
+#include <bcos-gateway/libp2p/LinkQuality.h>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <random>
+#include <sstream>
+
+using namespace bcos;
+using namespace bcos::gateway;
+
+namespace
+{
+void appendUint64(bytes& _payload, uint64_t _value)
+{
+    for (int shift = 56; shift >= 0; shift -= 8)
+    {
+        _payload.push_back((byte)(_value >> shift));
+    }
+}
+
+uint64_t readUint64(byte const* _data)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < 8; ++i)
+    {
+        value = (value << 8) | _data[i];
+    }
+    return value;
+}
+}  // namespace
+
+void LinkQuality::encodeEcho(bytes& _payload, uint64_t _now)
+{
+    uint64_t echoTime = 0;
+    uint64_t holdTime = 0;
+    {
+        Guard l(x_quality);
+        if (m_peerSendTime > 0)
+        {
+            echoTime = m_peerSendTime;
+            holdTime = _now > m_peerReceiveTime ? _now - m_peerReceiveTime : 0;
+        }
+    }
+    appendUint64(_payload, _now);
+    appendUint64(_payload, echoTime);
+    appendUint64(_payload, holdTime);
+    onHeartbeatSent(_now);
+}
+
+bool LinkQuality::decodeEcho(bytesConstRef _echo, uint64_t _now)
+{
+    if (_echo.size() < c_echoSize)
+    {
+        return false;
+    }
+    onHeartbeatReceived(readUint64(_echo.data()), readUint64(_echo.data() + 8),
+        readUint64(_echo.data() + 16), _now);
+    return true;
+}
+
+void LinkQuality::onHeartbeatSent(uint64_t _now)
+{
+    Guard l(x_quality);
+    // the peer echoes the heartbeat in its next heartbeat, the heartbeat sent before the last one
+    // should have been echoed
+    if (m_previousSent > 0)
+    {
+        updateLoss(m_lastEchoed >= m_previousSent ? 0 : 1);
+    }
+    m_previousSent = m_lastSent;
+    m_lastSent = _now;
+}
+
+void LinkQuality::onHeartbeatReceived(
+    uint64_t _peerSendTime, uint64_t _echoTime, uint64_t _holdTime, uint64_t _now)
+{
+    Guard l(x_quality);
+    m_peerSendTime = _peerSendTime;
+    m_peerReceiveTime = _now;
+    // only the heartbeats sent by this link and not echoed before
+    if (_echoTime == 0 || _echoTime <= m_lastEchoed || _echoTime > m_lastSent ||
+        _now < _echoTime + _holdTime)
+    {
+        return;
+    }
+    m_lastEchoed = _echoTime;
+    double rtt = _now - _echoTime - _holdTime;
+    m_rtt = m_measured ? (c_alpha * rtt + (1 - c_alpha) * m_rtt) : rtt;
+    m_measured = true;
+}
+
+void LinkQuality::onRequestFinished(bool _success, uint64_t _latency)
+{
+    if (m_inflight > 0)
+    {
+        m_inflight--;
+    }
+    Guard l(x_quality);
+    updateLoss(_success ? 0 : 1);
+    if (!_success)
+    {
+        return;
+    }
+    if (m_latencies.size() < c_latencySamples)
+    {
+        m_latencies.push_back(_latency);
+        return;
+    }
+    m_latencies[m_nextLatency] = _latency;
+    m_nextLatency = (m_nextLatency + 1) % c_latencySamples;
+}
+
+void LinkQuality::updateLoss(double _sample)
+{
+    m_loss = c_alpha * _sample + (1 - c_alpha) * m_loss;
+}
+
+uint64_t LinkQuality::rtt() const
+{
+    Guard l(x_quality);
+    return m_measured ? (uint64_t)m_rtt : c_defaultRtt;
+}
+
+bool LinkQuality::measured() const
+{
+    Guard l(x_quality);
+    return m_measured;
+}
+
+double LinkQuality::loss() const
+{
+    Guard l(x_quality);
+    return m_loss;
+}
+
+uint64_t LinkQuality::latencyP95() const
+{
+    std::vector<uint64_t> latencies;
+    {
+        Guard l(x_quality);
+        if (m_latencies.size() < c_minLatencySamples)
+        {
+            return 0;
+        }
+        latencies = m_latencies;
+    }
+    auto rank = latencies.begin() + (latencies.size() * 95 + 99) / 100 - 1;
+    std::nth_element(latencies.begin(), rank, latencies.end());
+    return *rank;
+}
+
+double LinkQuality::score() const
+{
+    double rtt;
+    double loss;
+    {
+        Guard l(x_quality);
+        rtt = m_measured ? m_rtt : c_defaultRtt;
+        loss = m_loss;
+    }
+    // at least 1us, the links with 0 rtt are still weighted by the load
+    return std::max(rtt, 1.0) * (1 + m_inflight) * (1 + c_lossPenalty * loss);
+}
+
+std::string LinkQuality::toString() const
+{
+    std::stringstream stream;
+    stream << "rtt:" << rtt() << "us" << (measured() ? "" : "(default)") << ",loss:" << loss()
+           << ",inflight:" << m_inflight << ",p95:" << latencyP95() << "us";
+    return stream.str();
+}
+
+LinkQuality::Ptr LinkQuality::aggregate(std::vector<Ptr> const& _links)
+{
+    if (_links.size() == 1)
+    {
+        return _links[0];
+    }
+    auto aggregated = std::make_shared<LinkQuality>();
+    size_t measuredCount = 0;
+    for (auto const& link : _links)
+    {
+        Guard l(link->x_quality);
+        if (link->m_measured)
+        {
+            aggregated->m_rtt += link->m_rtt;
+            measuredCount++;
+        }
+        aggregated->m_loss += link->m_loss;
+        aggregated->m_latencies.insert(
+            aggregated->m_latencies.end(), link->m_latencies.begin(), link->m_latencies.end());
+        aggregated->m_inflight += link->m_inflight;
+    }
+    if (measuredCount > 0)
+    {
+        aggregated->m_rtt /= measuredCount;
+        aggregated->m_measured = true;
+    }
+    if (!_links.empty())
+    {
+        aggregated->m_loss /= _links.size();
+    }
+    return aggregated;
+}
+
+size_t LinkQuality::choose(std::vector<double> const& _scores, bool _best)
+{
+    if (_scores.size() <= 1)
+    {
+        return 0;
+    }
+    size_t best = std::min_element(_scores.begin(), _scores.end()) - _scores.begin();
+    if (_best)
+    {
+        return best;
+    }
+    thread_local std::mt19937 t_rng(std::random_device{}());
+    auto first = std::uniform_int_distribution<size_t>(0, _scores.size() - 1)(t_rng);
+    auto second = std::uniform_int_distribution<size_t>(0, _scores.size() - 2)(t_rng);
+    if (second >= first)
+    {
+        second++;
+    }
+    auto chosen = _scores[second] < _scores[first] ? second : first;
+    // both unusable
+    if (_scores[chosen] == std::numeric_limits<double>::max())
+    {
+        return best;
+    }
+    return chosen;
+}
+
+uint64_t LinkQuality::steadyTimeUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
@@ -0,0 +1,110 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: the rtt, loss and load of the link with one peer gateway
+ * @file LinkQuality.h
+ */
+#pragma once
+#include <bcos-framework/libutilities/Common.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace bcos
+{
+namespace gateway
+{
+/**
+ * @brief: the rtt is measured by the heartbeats of the peers supporting P2PFeature::HeartbeatEcho,
+ * every heartbeat carries its send time and echoes the send time of the last heartbeat received
+ * from the peer with the time it was held, so rtt = now - echoTime - holdTime by the local clock
+ * only. the heartbeat not echoed before the next but one heartbeat sent and the request failed by
+ * the network are counted as lost. rtt and loss are EWMA, the times are steady microseconds.
+ */
+class LinkQuality
+{
+public:
+    using Ptr = std::shared_ptr<LinkQuality>;
+    /// sendTime(8) + echoTime(8) + holdTime(8) appended to the heartbeat payload, big endian
+    constexpr static size_t c_echoSize = 24;
+    /// the rtt assumed before measured
+    constexpr static uint64_t c_defaultRtt = 50 * 1000;
+    /// the weight of the new sample
+    constexpr static double c_alpha = 0.2;
+    /// the score of the link lost all the samples is (1 + c_lossPenalty) times of the lossless one
+    constexpr static double c_lossPenalty = 10;
+    /// the latencies of the latest requests succeeded kept for the percentile
+    constexpr static size_t c_latencySamples = 128;
+    /// the percentile is not estimated with fewer samples
+    constexpr static size_t c_minLatencySamples = 20;
+
+    /// append the echo fields of the heartbeat sent at _now
+    void encodeEcho(bytes& _payload, uint64_t _now);
+    /// the echo fields of the heartbeat received at _now, false if invalid
+    bool decodeEcho(bytesConstRef _echo, uint64_t _now);
+
+    void onHeartbeatSent(uint64_t _now);
+    void onHeartbeatReceived(
+        uint64_t _peerSendTime, uint64_t _echoTime, uint64_t _holdTime, uint64_t _now);
+
+    /// the requests sent by the link and waiting for the response, the latency of the request
+    /// succeeded is sampled in microseconds
+    void onRequestStarted() { m_inflight++; }
+    void onRequestFinished(bool _success, uint64_t _latency);
+
+    /// the EWMA rtt, c_defaultRtt if not measured
+    uint64_t rtt() const;
+    bool measured() const;
+    double loss() const;
+    /// the 95th percentile latency of the latest requests in microseconds, 0 if not enough samples
+    uint64_t latencyP95() const;
+    size_t inflight() const { return m_inflight; }
+    /// the cost to send by the link, the lower the better: the rtt weighted by the loss and the
+    /// requests waiting
+    double score() const;
+    std::string toString() const;
+
+    /// the quality of the parallel links with the same peer as one link: the mean rtt of the links
+    /// measured, the mean loss, the latencies of all the links and the sum of the requests waiting.
+    /// the link itself if only one, otherwise a new one only to be read
+    static Ptr aggregate(std::vector<Ptr> const& _links);
+
+    /// the index of the link to send by: the better of two random links(power of two choices),
+    /// or the best of all if _best, the links with the max score are chosen at last
+    static size_t choose(std::vector<double> const& _scores, bool _best);
+    static uint64_t steadyTimeUs();
+
+private:
+    void updateLoss(double _sample);
+
+    mutable Mutex x_quality;
+    double m_rtt = 0;
+    bool m_measured = false;
+    double m_loss = 0;
+    // the send time of the last and the previous heartbeats sent
+    uint64_t m_lastSent = 0;
+    uint64_t m_previousSent = 0;
+    // the latest send time echoed by the peer
+    uint64_t m_lastEchoed = 0;
+    // the send time(by the clock of the peer) and the receive time of the last peer heartbeat
+    uint64_t m_peerSendTime = 0;
+    uint64_t m_peerReceiveTime = 0;
+    // the ring of the latest request latencies
+    std::vector<uint64_t> m_latencies;
+    size_t m_nextLatency = 0;
+    std::atomic<size_t> m_inflight = {0};
+};
+}  // namespace gateway
+}  // namespace bcos
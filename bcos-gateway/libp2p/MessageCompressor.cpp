@@ -0,0 +1,151 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: compress the payload of the p2p messages with zstd
+ * @file MessageCompressor.cpp
+ */
+#include <bcos-gateway/libp2p/Common.h>
+#include <bcos-gateway/libp2p/MessageCompressor.h>
+#include <zstd.h>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+using namespace bcos;
+using namespace bcos::gateway;
+
+namespace
+{
+uint64_t steadyTimeUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void printStatistics(std::stringstream& _stream, uint64_t _count, uint64_t _rawBytes,
+    uint64_t _compressedBytes, uint64_t _timeCost)
+{
+    double ratio = _compressedBytes == 0 ? 0 : (double)_rawBytes / _compressedBytes;
+    _stream << _count << "/" << _rawBytes << "B/" << _compressedBytes << "B(" << std::fixed
+            << std::setprecision(2) << ratio << ")/" << _timeCost << "us";
+}
+}  // namespace
+
+void CompressionMetrics::onCompressed(size_t _rawSize, size_t _compressedSize, uint64_t _timeCost)
+{
+    m_compressedCount.fetch_add(1, std::memory_order_relaxed);
+    m_compressRawBytes.fetch_add(_rawSize, std::memory_order_relaxed);
+    m_compressedBytes.fetch_add(_compressedSize, std::memory_order_relaxed);
+    m_compressTime.fetch_add(_timeCost, std::memory_order_relaxed);
+}
+
+void CompressionMetrics::onDecompressed(
+    size_t _compressedSize, size_t _rawSize, uint64_t _timeCost)
+{
+    m_decompressedCount.fetch_add(1, std::memory_order_relaxed);
+    m_decompressedBytes.fetch_add(_compressedSize, std::memory_order_relaxed);
+    m_decompressRawBytes.fetch_add(_rawSize, std::memory_order_relaxed);
+    m_decompressTime.fetch_add(_timeCost, std::memory_order_relaxed);
+}
+
+std::string CompressionMetrics::toString() const
+{
+    std::stringstream stream;
+    stream << "sent:";
+    printStatistics(stream, m_compressedCount.load(std::memory_order_relaxed),
+        m_compressRawBytes.load(std::memory_order_relaxed),
+        m_compressedBytes.load(std::memory_order_relaxed),
+        m_compressTime.load(std::memory_order_relaxed));
+    stream << ",received:";
+    printStatistics(stream, m_decompressedCount.load(std::memory_order_relaxed),
+        m_decompressRawBytes.load(std::memory_order_relaxed),
+        m_decompressedBytes.load(std::memory_order_relaxed),
+        m_decompressTime.load(std::memory_order_relaxed));
+    return stream.str();
+}
+
+P2PMessage::Ptr MessageCompressor::compress(
+    P2PMessage::Ptr const& _message, uint64_t& _timeCost) const
+{
+    _timeCost = 0;
+    auto payload = _message->payloadRef();
+    if (payload.size() <= m_threshold || (_message->ext() & MessageExtFieldFlag::Compress))
+    {
+        return nullptr;
+    }
+    auto startTime = steadyTimeUs();
+    auto compressedPayload = std::make_shared<bytes>(ZSTD_compressBound(payload.size()));
+    auto compressedSize = ZSTD_compress(compressedPayload->data(), compressedPayload->size(),
+        payload.data(), payload.size(), m_level);
+    _timeCost = steadyTimeUs() - startTime;
+    if (ZSTD_isError(compressedSize))
+    {
+        P2PMSG_LOG(WARNING) << LOG_DESC("compress payload failed")
+                            << LOG_KV("seq", _message->seq())
+                            << LOG_KV("payloadSize", payload.size())
+                            << LOG_KV("error", ZSTD_getErrorName(compressedSize));
+        return nullptr;
+    }
+    // not compressible
+    if (compressedSize >= payload.size())
+    {
+        return nullptr;
+    }
+    compressedPayload->resize(compressedSize);
+    // the message may be sent to the peers not supporting compression at the same time
+    auto compressedMessage = std::make_shared<P2PMessage>(*_message);
+    compressedMessage->setPayload(compressedPayload);
+    compressedMessage->setExt(_message->ext() | MessageExtFieldFlag::Compress);
+    return compressedMessage;
+}
+
+bool MessageCompressor::decompress(P2PMessage::Ptr const& _message, CompressionMetrics* _metrics)
+{
+    if (!(_message->ext() & MessageExtFieldFlag::Compress))
+    {
+        return true;
+    }
+    auto payload = _message->payloadRef();
+    auto rawSize = ZSTD_getFrameContentSize(payload.data(), payload.size());
+    if (rawSize == ZSTD_CONTENTSIZE_UNKNOWN || rawSize == ZSTD_CONTENTSIZE_ERROR ||
+        rawSize > c_maxDecompressedSize)
+    {
+        P2PMSG_LOG(ERROR) << LOG_DESC("invalid compressed payload")
+                          << LOG_KV("seq", _message->seq())
+                          << LOG_KV("payloadSize", payload.size()) << LOG_KV("rawSize", rawSize);
+        return false;
+    }
+    auto startTime = steadyTimeUs();
+    auto rawPayload = std::make_shared<bytes>(rawSize);
+    auto result =
+        ZSTD_decompress(rawPayload->data(), rawPayload->size(), payload.data(), payload.size());
+    if (ZSTD_isError(result) || result != rawSize)
+    {
+        P2PMSG_LOG(ERROR) << LOG_DESC("decompress payload failed")
+                          << LOG_KV("seq", _message->seq())
+                          << LOG_KV("payloadSize", payload.size())
+                          << LOG_KV("error", ZSTD_isError(result) ? ZSTD_getErrorName(result) :
+                                                                    "size mismatch");
+        return false;
+    }
+    if (_metrics)
+    {
+        _metrics->onDecompressed(payload.size(), rawSize, steadyTimeUs() - startTime);
+    }
+    _message->setPayload(rawPayload);
+    _message->setExt(_message->ext() & ~MessageExtFieldFlag::Compress);
+    return true;
+}
@@ -0,0 +1,81 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: compress the payload of the p2p messages with zstd
+ * @file MessageCompressor.h
+ */
+#pragma once
+#include <bcos-gateway/libp2p/P2PMessage.h>
+#include <atomic>
+
+namespace bcos
+{
+namespace gateway
+{
+/**
+ * @brief: the compression statistics of the messages exchanged with one peer
+ */
+class CompressionMetrics
+{
+public:
+    void onCompressed(size_t _rawSize, size_t _compressedSize, uint64_t _timeCost);
+    void onDecompressed(size_t _compressedSize, size_t _rawSize, uint64_t _timeCost);
+
+    /// sent and received: count, raw bytes/compressed bytes(ratio), the time cost(us)
+    std::string toString() const;
+
+private:
+    std::atomic<uint64_t> m_compressedCount = {0};
+    std::atomic<uint64_t> m_compressRawBytes = {0};
+    std::atomic<uint64_t> m_compressedBytes = {0};
+    std::atomic<uint64_t> m_compressTime = {0};
+    std::atomic<uint64_t> m_decompressedCount = {0};
+    std::atomic<uint64_t> m_decompressRawBytes = {0};
+    std::atomic<uint64_t> m_decompressedBytes = {0};
+    std::atomic<uint64_t> m_decompressTime = {0};
+};
+
+/**
+ * @brief: the payload larger than the threshold is compressed and flagged by
+ * MessageExtFieldFlag::Compress, the messages are only compressed for the peers supporting
+ * P2PFeature::Compression, by the thread sending the message instead of the io thread
+ */
+class MessageCompressor
+{
+public:
+    using Ptr = std::shared_ptr<MessageCompressor>;
+    /// the max size of the decompressed payload, reject the malicious payload exhausting memory
+    const static size_t c_maxDecompressedSize = 1024 * 1024 * 1024;
+
+    MessageCompressor(size_t _threshold, int _level) : m_threshold(_threshold), m_level(_level) {}
+    virtual ~MessageCompressor() {}
+
+    /// the copy of _message with the payload compressed, nullptr if the payload is not larger than
+    /// the threshold or the compressed one is not smaller, _message itself is not modified
+    /// @param _timeCost: the time(us) spent compressing
+    virtual P2PMessage::Ptr compress(P2PMessage::Ptr const& _message, uint64_t& _timeCost) const;
+
+    /// decompress the payload in place if it is compressed, false if the payload is invalid
+    static bool decompress(P2PMessage::Ptr const& _message, CompressionMetrics* _metrics);
+
+    size_t threshold() const { return m_threshold; }
+    int level() const { return m_level; }
+
+private:
+    size_t m_threshold;
+    int m_level;
+};
+}  // namespace gateway
+}  // namespace bcos
@@ -0,0 +1,119 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: the per-session dictionary of the groupIDs and nodeIDs in the compact options
+ * @file OptionsDictionary.cpp
+ */
+#include <bcos-gateway/libp2p/Common.h>
+#include <bcos-gateway/libp2p/OptionsDictionary.h>
+
+using namespace bcos;
+using namespace bcos::gateway;
+
+OptionsDictionary::Entry OptionsDictionary::prepare(bytesConstRef _value)
+{
+    Entry entry;
+    entry.value = _value;
+    Guard l(x_sent);
+    auto it = m_sentIndexes.find(_value);
+    if (it != m_sentIndexes.end())
+    {
+        entry.index = it->second;
+        if (entry.index < m_acknowledged)
+        {
+            entry.kind = EntryKind::Reference;
+            entry.value = bytesConstRef();
+        }
+        else
+        {
+            // the peer may not have received the definition, define it again
+            entry.kind = EntryKind::Define;
+        }
+        return entry;
+    }
+    // the dictionary is full, send the value without index
+    if (m_sent.size() >= c_maxEntries)
+    {
+        return entry;
+    }
+    auto value = std::make_shared<bytes>(_value.begin(), _value.end());
+    entry.kind = EntryKind::Define;
+    entry.index = (uint32_t)m_sent.size();
+    m_sent.push_back(value);
+    m_sentIndexes.emplace(bytesConstRef(value->data(), value->size()), entry.index);
+    return entry;
+}
+
+void OptionsDictionary::acknowledge(uint32_t _count)
+{
+    Guard l(x_sent);
+    // the acknowledgement never goes back, and never exceeds the entries sent
+    _count = std::min(_count, (uint32_t)m_sent.size());
+    if (_count > m_acknowledged)
+    {
+        m_acknowledged = _count;
+    }
+}
+
+std::shared_ptr<bytes> OptionsDictionary::resolve(Entry const& _entry)
+{
+    if (_entry.kind == EntryKind::Literal)
+    {
+        return std::make_shared<bytes>(_entry.value.begin(), _entry.value.end());
+    }
+    if (_entry.index >= c_maxEntries)
+    {
+        P2PMSG_LOG(ERROR) << LOG_DESC("options dictionary index overflow")
+                          << LOG_KV("index", _entry.index);
+        return nullptr;
+    }
+    Guard l(x_learned);
+    if (_entry.kind == EntryKind::Reference)
+    {
+        if (_entry.index >= m_learnedEntries.size() || !m_learnedEntries[_entry.index])
+        {
+            P2PMSG_LOG(ERROR) << LOG_DESC("options dictionary entry referenced before defined")
+                              << LOG_KV("index", _entry.index);
+            return nullptr;
+        }
+        return m_learnedEntries[_entry.index];
+    }
+    if (_entry.index >= m_learnedEntries.size())
+    {
+        m_learnedEntries.resize(_entry.index + 1);
+    }
+    auto& value = m_learnedEntries[_entry.index];
+    if (value)
+    {
+        // defined again by the messages sent before the acknowledgement
+        if (value->size() != _entry.value.size() ||
+            !std::equal(value->begin(), value->end(), _entry.value.begin()))
+        {
+            P2PMSG_LOG(ERROR) << LOG_DESC("options dictionary entry redefined")
+                              << LOG_KV("index", _entry.index);
+            return nullptr;
+        }
+        return value;
+    }
+    value = std::make_shared<bytes>(_entry.value.begin(), _entry.value.end());
+    // the definitions may be received out of order, only the entries without gap are acknowledged
+    auto learned = m_learned.load();
+    while (learned < m_learnedEntries.size() && m_learnedEntries[learned])
+    {
+        ++learned;
+    }
+    m_learned = learned;
+    return value;
+}
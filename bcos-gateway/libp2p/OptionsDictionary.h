@@ -0,0 +1,106 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: the per-session dictionary of the groupIDs and nodeIDs in the compact options
+ * @file OptionsDictionary.h
+ */
+#pragma once
+#include <bcos-framework/libutilities/Common.h>
+#include <algorithm>
+#include <atomic>
+#include <string_view>
+#include <unordered_map>
+
+namespace bcos
+{
+namespace gateway
+{
+/**
+ * @brief: the groupIDs and the nodeIDs of the compact options(c_compactOptionsVersion) are sent
+ * in full with an index the first time, and referenced by the index after then
+ *
+ * each side of the session maintains the entries it sent and the entries it learned, the entries
+ * are immutable once assigned. The messages may be reordered between encoding and sending(by the
+ * priority classes and the fragments), so an entry is only referenced after the peer acknowledged
+ * it(by the heartbeat), before then every message using it carries the definition again
+ */
+class OptionsDictionary
+{
+public:
+    using Ptr = std::shared_ptr<OptionsDictionary>;
+    /// the max entries of each direction, part of the protocol
+    const static size_t c_maxEntries = 1024;
+
+    enum EntryKind : uint8_t
+    {
+        Literal = 0,    ///< the value without index, the dictionary is full
+        Define = 1,     ///< the value and the index assigned to it
+        Reference = 2,  ///< only the index of the value acknowledged by the peer
+    };
+    struct Entry
+    {
+        EntryKind kind = EntryKind::Literal;
+        uint32_t index = 0;
+        // empty for Reference
+        bytesConstRef value;
+    };
+
+    OptionsDictionary() = default;
+    virtual ~OptionsDictionary() {}
+
+    /// the sending side: the entry to send _value, the index is assigned the first time
+    Entry prepare(bytesConstRef _value);
+    /// the sending side: the peer has learned the first _count entries
+    void acknowledge(uint32_t _count);
+    uint32_t acknowledged() const { return m_acknowledged; }
+
+    /// the receiving side: the value of _entry, the value of the Define entry is learned, nullptr
+    /// if the index is invalid or referenced before defined
+    /// the values returned are shared by all the messages and must not be modified
+    std::shared_ptr<bytes> resolve(Entry const& _entry);
+    /// the receiving side: the count of the entries learned without gap, acknowledged to the peer
+    uint32_t learned() const { return m_learned; }
+
+private:
+    struct RefHash
+    {
+        size_t operator()(bytesConstRef _value) const
+        {
+            return std::hash<std::string_view>()(
+                std::string_view((char const*)_value.data(), _value.size()));
+        }
+    };
+    struct RefEqual
+    {
+        bool operator()(bytesConstRef _left, bytesConstRef _right) const
+        {
+            return _left.size() == _right.size() &&
+                   std::equal(_left.begin(), _left.end(), _right.begin());
+        }
+    };
+
+    mutable bcos::Mutex x_sent;
+    // the values sent, the keys of m_sentIndexes reference them
+    std::vector<std::shared_ptr<bytes>> m_sent;
+    std::unordered_map<bytesConstRef, uint32_t, RefHash, RefEqual> m_sentIndexes;
+    std::atomic<uint32_t> m_acknowledged = {0};
+
+    mutable bcos::Mutex x_learned;
+    // index => value, nullptr if the definition has not been received
+    std::vector<std::shared_ptr<bytes>> m_learnedEntries;
+    std::atomic<uint32_t> m_learned = {0};
+};
+}  // namespace gateway
+}  // namespace bcos
@@ -8,6 +8,7 @@
 #include <bcos-gateway/libnetwork/Host.h>
 #include <bcos-gateway/libnetwork/SessionFace.h>
 #include <bcos-gateway/libp2p/Common.h>
+#include <bcos-gateway/libp2p/LinkQuality.h>
 #include <bcos-gateway/libp2p/P2PMessage.h>
 #include <memory>
 
@@ -48,11 +49,25 @@ public:
         CallbackFuncWithSession callback, Options options = Options()) = 0;
 
     virtual void asyncBroadcastMessage(std::shared_ptr<P2PMessage> message, Options options) = 0;
+    /// send the message to the given nodes without callback, the message is encoded only once and
+    /// the encoded frame is shared by all the sessions
+    virtual void asyncSendMessageByNodeIDs(std::vector<P2pID> const& _nodeIDs,
+        std::shared_ptr<P2PMessage> _message, Options _options = Options()) = 0;
 
     virtual P2PInfos sessionInfos() = 0;
     virtual P2PInfo localP2pInfo() = 0;
 
     virtual bool isConnected(P2pID const& _nodeID) const = 0;
+    /// the write queue of any session to _nodeID exceeds the high watermark, the messages except
+    /// the control messages striped to it are rejected with P2PExceptionType::SessionCongested
+    virtual bool isCongested(P2pID const& _nodeID) const = 0;
+    /// the rtt, loss and load of the links with _nodeID aggregated over all its sessions, nullptr
+    /// if not connected
+    virtual LinkQuality::Ptr linkQuality(P2pID const& _nodeID) const = 0;
+    /// the link quality of the session sending _message to _nodeID, the request is accounted on
+    /// it, nullptr if not connected
+    virtual LinkQuality::Ptr linkQuality(
+        P2pID const& _nodeID, std::shared_ptr<P2PMessage> const& _message) const = 0;
 
     virtual std::shared_ptr<Host> host() = 0;
 
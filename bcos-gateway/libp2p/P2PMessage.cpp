@@ -22,6 +22,8 @@
 #include <bcos-gateway/libp2p/Common.h>
 #include <bcos-gateway/libp2p/P2PMessage.h>
 #include <boost/asio/detail/socket_ops.hpp>
+#include <algorithm>
+#include <limits>
 
 using namespace bcos;
 using namespace bcos::gateway;
@@ -37,72 +39,304 @@ using namespace bcos::crypto;
         }                                                                                    \
     } while (0);
 
-bool P2PMessageOptions::encode(bytes& _buffer)
+namespace
+{
+void writeVarint(bytes& _buffer, uint64_t _value)
+{
+    while (_value >= 0x80)
+    {
+        _buffer.push_back((byte)(_value | 0x80));
+        _value >>= 7;
+    }
+    _buffer.push_back((byte)_value);
+}
+
+// read the varint at _offset and move _offset after it, false if incomplete or overflow
+bool readVarint(bytesConstRef _buffer, size_t& _offset, uint64_t& _value)
+{
+    _value = 0;
+    for (size_t shift = 0; shift < 64 && _offset < _buffer.size(); shift += 7)
+    {
+        auto data = _buffer[_offset++];
+        _value |= (uint64_t)(data & 0x7f) << shift;
+        if ((data & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void writeEntry(bytes& _buffer, OptionsDictionary::Entry const& _entry)
+{
+    writeVarint(_buffer, ((uint64_t)_entry.index << 2) | _entry.kind);
+    if (_entry.kind == OptionsDictionary::EntryKind::Reference)
+    {
+        return;
+    }
+    writeVarint(_buffer, _entry.value.size());
+    _buffer.insert(_buffer.end(), _entry.value.begin(), _entry.value.end());
+}
+
+bool readEntry(bytesConstRef _buffer, size_t& _offset, OptionsDictionary::Entry& _entry)
+{
+    uint64_t tag = 0;
+    if (!readVarint(_buffer, _offset, tag) || (tag >> 2) > UINT32_MAX)
+    {
+        return false;
+    }
+    _entry.kind = (OptionsDictionary::EntryKind)(tag & 0x03);
+    _entry.index = (uint32_t)(tag >> 2);
+    _entry.value = bytesConstRef();
+    if (_entry.kind == OptionsDictionary::EntryKind::Reference)
+    {
+        return true;
+    }
+    uint64_t length = 0;
+    if (_entry.kind > OptionsDictionary::EntryKind::Reference ||
+        !readVarint(_buffer, _offset, length) || length > P2PMessageOptions::MAX_NODEID_LENGTH ||
+        _offset + length > _buffer.size())
+    {
+        return false;
+    }
+    _entry.value = _buffer.getCroppedData(_offset, length);
+    _offset += length;
+    return true;
+}
+
+// release the content of _buffer, the buffer object is kept for reuse if not shared
+void recycleBuffer(std::shared_ptr<bytes>& _buffer)
+{
+    if (_buffer && _buffer.use_count() == 1)
+    {
+        // synchronize with the release of the other owners before modified
+        std::atomic_thread_fence(std::memory_order_acquire);
+        bytes().swap(*_buffer);
+        return;
+    }
+    _buffer = std::make_shared<bytes>();
+}
+}  // namespace
+
+ssize_t P2PMessageOptions::encodedLength() const
 {
-    // parameters check
     if (m_groupID.size() > MAX_GROUPID_LENGTH)
     {
         P2PMSG_LOG(ERROR) << LOG_DESC("groupID length overflow")
                           << LOG_KV("groupID length", m_groupID.size());
-        return false;
+        return -1;
     }
     if (!m_srcNodeID || m_srcNodeID->empty() || (m_srcNodeID->size() > MAX_NODEID_LENGTH))
     {
         P2PMSG_LOG(ERROR) << LOG_DESC("srcNodeID length valid")
                           << LOG_KV("srcNodeID length", (m_srcNodeID ? m_srcNodeID->size() : 0));
-        return false;
+        return -1;
     }
     if (m_dstNodeIDs.size() > MAX_DST_NODEID_COUNT)
     {
         P2PMSG_LOG(ERROR) << LOG_DESC("dstNodeID amount overfow")
                           << LOG_KV("dstNodeID size", m_dstNodeIDs.size());
-        return false;
+        return -1;
     }
-
-    for (auto dstNodeID : m_dstNodeIDs)
+    // groupID length(2) + groupID + nodeID length(2) + src nodeID + dst nodeID count(1)
+    size_t length = 2 + m_groupID.size() + 2 + m_srcNodeID->size() + 1;
+    for (auto const& dstNodeID : m_dstNodeIDs)
     {
         if (!dstNodeID || dstNodeID->empty() || (dstNodeID->size() > MAX_NODEID_LENGTH))
         {
             P2PMSG_LOG(ERROR) << LOG_DESC("dstNodeID length valid")
                               << LOG_KV("dstNodeID length", (dstNodeID ? dstNodeID->size() : 0));
-            return false;
+            return -1;
         }
+        length += dstNodeID->size();
     }
+    return length;
+}
 
+void P2PMessageOptions::encode(byte* _data) const
+{
     // groupID length
     uint16_t groupIDLength =
         boost::asio::detail::socket_ops::host_to_network_short((uint16_t)m_groupID.size());
-    _buffer.insert(_buffer.end(), (byte*)&groupIDLength, (byte*)&groupIDLength + 2);
+    memcpy(_data, &groupIDLength, 2);
+    _data += 2;
     // groupID
-    _buffer.insert(_buffer.end(), m_groupID.begin(), m_groupID.end());
+    memcpy(_data, m_groupID.data(), m_groupID.size());
+    _data += m_groupID.size();
 
     // nodeID length
     uint16_t nodeIDLength =
         boost::asio::detail::socket_ops::host_to_network_short((uint16_t)m_srcNodeID->size());
-    _buffer.insert(_buffer.end(), (byte*)&nodeIDLength, (byte*)&nodeIDLength + 2);
+    memcpy(_data, &nodeIDLength, 2);
+    _data += 2;
     // srcNodeID
-    _buffer.insert(_buffer.end(), m_srcNodeID->begin(), m_srcNodeID->end());
+    memcpy(_data, m_srcNodeID->data(), m_srcNodeID->size());
+    _data += m_srcNodeID->size();
 
     // dstNodeID count
-    uint8_t dstNodeIDCount = (uint8_t)m_dstNodeIDs.size();
-    _buffer.insert(_buffer.end(), (byte*)&dstNodeIDCount, (byte*)&dstNodeIDCount + 1);
+    *_data = (uint8_t)m_dstNodeIDs.size();
+    _data += 1;
 
     // dstNodeIDs
     for (const auto& nodeID : m_dstNodeIDs)
     {
-        _buffer.insert(_buffer.end(), nodeID->begin(), nodeID->end());
+        memcpy(_data, nodeID->data(), nodeID->size());
+        _data += nodeID->size();
+    }
+}
+
+bool P2PMessageOptions::encode(bytes& _buffer)
+{
+    // parameters check
+    auto length = encodedLength();
+    if (length < 0)
+    {
+        return false;
     }
+    auto offset = _buffer.size();
+    _buffer.resize(offset + length);
+    encode(_buffer.data() + offset);
+    return true;
+}
 
+bool P2PMessageOptions::encodeCompact(bytes& _buffer, OptionsDictionary* _dictionary) const
+{
+    if (encodedLength() < 0)
+    {
+        return false;
+    }
+    auto prepare = [_dictionary](bytesConstRef _value) {
+        if (_dictionary)
+        {
+            return _dictionary->prepare(_value);
+        }
+        OptionsDictionary::Entry entry;
+        entry.value = _value;
+        return entry;
+    };
+    writeEntry(_buffer, prepare(bytesConstRef((byte const*)m_groupID.data(), m_groupID.size())));
+    writeEntry(_buffer, prepare(bytesConstRef(m_srcNodeID->data(), m_srcNodeID->size())));
+    writeVarint(_buffer, m_dstNodeIDs.size());
+    for (auto const& dstNodeID : m_dstNodeIDs)
+    {
+        writeEntry(_buffer, prepare(bytesConstRef(dstNodeID->data(), dstNodeID->size())));
+    }
     return true;
 }
 
+ssize_t P2PMessageOptions::decodeCompact(std::shared_ptr<bytes> _holder, bytesConstRef _buffer)
+{
+    if (!_holder)
+    {
+        // the entries reference the copy of the _buffer
+        _holder = std::make_shared<bytes>(_buffer.begin(), _buffer.end());
+        _buffer = bytesConstRef(_holder->data(), _holder->size());
+    }
+    size_t offset = 0;
+    // groupID and src nodeID
+    m_compactEntries.resize(2);
+    uint64_t dstNodeCount = 0;
+    if (!readEntry(_buffer, offset, m_compactEntries[0]) ||
+        !readEntry(_buffer, offset, m_compactEntries[1]) ||
+        !readVarint(_buffer, offset, dstNodeCount) || dstNodeCount > MAX_DST_NODEID_COUNT)
+    {
+        P2PMSG_LOG(ERROR) << LOG_DESC("decode compact options error")
+                          << LOG_KV("length", _buffer.size());
+        m_compactEntries.clear();
+        return MessageDecodeStatus::MESSAGE_ERROR;
+    }
+    m_compactEntries.resize(2 + dstNodeCount);
+    for (size_t i = 0; i < dstNodeCount; ++i)
+    {
+        if (!readEntry(_buffer, offset, m_compactEntries[2 + i]))
+        {
+            P2PMSG_LOG(ERROR) << LOG_DESC("decode compact options dst nodeID error")
+                              << LOG_KV("index", i) << LOG_KV("length", _buffer.size());
+            m_compactEntries.clear();
+            return MessageDecodeStatus::MESSAGE_ERROR;
+        }
+    }
+    m_compactHolder = _holder;
+    return offset;
+}
+
+bool P2PMessageOptions::resolve(OptionsDictionary* _dictionary)
+{
+    if (m_compactEntries.empty())
+    {
+        return true;
+    }
+    std::vector<std::shared_ptr<bytes>> values;
+    values.reserve(m_compactEntries.size());
+    for (auto const& entry : m_compactEntries)
+    {
+        std::shared_ptr<bytes> value;
+        if (_dictionary)
+        {
+            value = _dictionary->resolve(entry);
+        }
+        else if (entry.kind == OptionsDictionary::EntryKind::Literal)
+        {
+            value = std::make_shared<bytes>(entry.value.begin(), entry.value.end());
+        }
+        if (!value)
+        {
+            return false;
+        }
+        values.push_back(std::move(value));
+    }
+    m_holder = nullptr;
+    m_srcNodeIDRef = bytesConstRef();
+    m_dstNodeIDRefs.clear();
+    m_groupID.assign(values[0]->begin(), values[0]->end());
+    m_srcNodeID = values[1];
+    m_dstNodeIDs.assign(values.begin() + 2, values.end());
+    m_compactEntries.clear();
+    m_compactHolder = nullptr;
+    return true;
+}
+
+ssize_t P2PMessageOptions::decode(bytesConstRef _buffer)
+{
+    return decode(nullptr, _buffer);
+}
+
+void P2PMessageOptions::reset()
+{
+    m_groupID.clear();
+    recycleBuffer(m_srcNodeID);
+    m_dstNodeIDs.clear();
+    m_holder = nullptr;
+    m_srcNodeIDRef = bytesConstRef();
+    m_dstNodeIDRefs.clear();
+    m_compactEntries.clear();
+    m_compactHolder = nullptr;
+}
+
+void P2PMessageOptions::materialize()
+{
+    if (!m_holder)
+    {
+        return;
+    }
+    m_srcNodeID = std::make_shared<bytes>(m_srcNodeIDRef.begin(), m_srcNodeIDRef.end());
+    m_dstNodeIDs.clear();
+    for (auto const& dstNodeIDRef : m_dstNodeIDRefs)
+    {
+        m_dstNodeIDs.push_back(std::make_shared<bytes>(dstNodeIDRef.begin(), dstNodeIDRef.end()));
+    }
+    m_srcNodeIDRef = bytesConstRef();
+    m_dstNodeIDRefs.clear();
+    m_holder = nullptr;
+}
+
 ///       groupID length    :1 bytes
 ///       groupID           : bytes
 ///       nodeID length     :2 bytes
 ///       src nodeID        : bytes
 ///       src nodeID count  :1 bytes
 ///       dst nodeIDs       : bytes
-ssize_t P2PMessageOptions::decode(bytesConstRef _buffer)
+ssize_t P2PMessageOptions::decode(std::shared_ptr<bytes> _holder, bytesConstRef _buffer)
 {
     size_t offset = 0;
     size_t length = _buffer.size();
@@ -131,8 +365,7 @@ ssize_t P2PMessageOptions::decode(bytesConstRef _buffer)
         offset += 2;
 
         CHECK_OFFSET_WITH_THROW_EXCEPTION(offset + nodeIDLength, length);
-        m_srcNodeID->insert(
-            m_srcNodeID->begin(), (byte*)&_buffer[offset], (byte*)&_buffer[offset] + nodeIDLength);
+        auto srcNodeIDRef = _buffer.getCroppedData(offset, nodeIDLength);
         offset += nodeIDLength;
 
         CHECK_OFFSET_WITH_THROW_EXCEPTION(offset + 1, length);
@@ -141,6 +374,21 @@ ssize_t P2PMessageOptions::decode(bytesConstRef _buffer)
         offset += 1;
 
         CHECK_OFFSET_WITH_THROW_EXCEPTION(offset + dstNodeCount * nodeIDLength, length);
+        if (_holder)
+        {
+            // reference the nodeIDs without copy
+            m_holder = _holder;
+            m_srcNodeIDRef = srcNodeIDRef;
+            m_dstNodeIDRefs.resize(dstNodeCount);
+            for (size_t i = 0; i < dstNodeCount; i++)
+            {
+                m_dstNodeIDRefs[i] = _buffer.getCroppedData(offset, nodeIDLength);
+                offset += nodeIDLength;
+            }
+            return offset;
+        }
+
+        m_srcNodeID->insert(m_srcNodeID->begin(), srcNodeIDRef.begin(), srcNodeIDRef.end());
         // dstNodeIDs
         m_dstNodeIDs.resize(dstNodeCount);
         for (size_t i = 0; i < dstNodeCount; i++)
@@ -162,36 +410,100 @@ ssize_t P2PMessageOptions::decode(bytesConstRef _buffer)
     return offset;
 }
 
-bool P2PMessage::encode(bytes& _buffer)
+ssize_t P2PMessage::optionsLength(bytes& _compactOptions) const
 {
-    _buffer.clear();
+    if (!hasOptions())
+    {
+        return 0;
+    }
+    if (!(m_ext & MessageExtFieldFlag::CompactOptions))
+    {
+        return m_options->encodedLength();
+    }
+    if (m_encodedOptions)
+    {
+        return m_encodedOptions->size();
+    }
+    if (!m_options->encodeCompact(_compactOptions, nullptr))
+    {
+        return -1;
+    }
+    return _compactOptions.size();
+}
 
-    // set length to zero first
-    uint32_t length = 0;
+void P2PMessage::encodeHeader(byte* _data, size_t _headerLength, bytes const& _compactOptions) const
+{
+    uint32_t length = boost::asio::detail::socket_ops::host_to_network_long(
+        (uint32_t)(_headerLength + m_payloadRef.size()));
     uint16_t version = boost::asio::detail::socket_ops::host_to_network_short(m_version);
     uint16_t packetType = boost::asio::detail::socket_ops::host_to_network_short(m_packetType);
     uint32_t seq = boost::asio::detail::socket_ops::host_to_network_long(m_seq);
     uint16_t ext = boost::asio::detail::socket_ops::host_to_network_short(m_ext);
 
-    _buffer.insert(_buffer.end(), (byte*)&length, (byte*)&length + 4);
-    _buffer.insert(_buffer.end(), (byte*)&version, (byte*)&version + 2);
-    _buffer.insert(_buffer.end(), (byte*)&packetType, (byte*)&packetType + 2);
-    _buffer.insert(_buffer.end(), (byte*)&seq, (byte*)&seq + 4);
-    _buffer.insert(_buffer.end(), (byte*)&ext, (byte*)&ext + 2);
+    memcpy(_data, &length, 4);
+    memcpy(_data + 4, &version, 2);
+    memcpy(_data + 6, &packetType, 2);
+    memcpy(_data + 8, &seq, 4);
+    memcpy(_data + 12, &ext, 2);
 
-    // encode options
-    if (hasOptions() && !m_options->encode(_buffer))
+    auto options = _data + MESSAGE_HEADER_LENGTH;
+    if (deadlineLength() > 0)
     {
-        return false;
+        // the remaining time instead of the deadline, the clocks of the peers are not synchronized
+        auto now = utcSteadyTime();
+        uint64_t remaining = m_deadline > now ? m_deadline - now : 0;
+        uint32_t deadline = boost::asio::detail::socket_ops::host_to_network_long(
+            (uint32_t)std::min<uint64_t>(remaining, std::numeric_limits<uint32_t>::max()));
+        memcpy(options, &deadline, DEADLINE_LENGTH);
+        options += DEADLINE_LENGTH;
     }
 
-    _buffer.insert(_buffer.end(), m_payload->begin(), m_payload->end());
-
-    // calc total length and modify the length value in the buffer
-    length = boost::asio::detail::socket_ops::host_to_network_long((uint32_t)_buffer.size());
+    // encode options
+    if (!hasOptions())
+    {
+        return;
+    }
+    if (!(m_ext & MessageExtFieldFlag::CompactOptions))
+    {
+        m_options->encode(options);
+        return;
+    }
+    auto const& compactOptions = m_encodedOptions ? *m_encodedOptions : _compactOptions;
+    memcpy(options, compactOptions.data(), compactOptions.size());
+}
 
-    std::copy((byte*)&length, (byte*)&length + 4, _buffer.data());
+bool P2PMessage::encode(bytes& _buffer)
+{
+    // the length of the frame is known before encoding, allocate once
+    bytes compactOptions;
+    auto length = optionsLength(compactOptions);
+    if (length < 0)
+    {
+        return false;
+    }
+    auto headerLength = MESSAGE_HEADER_LENGTH + deadlineLength() + length;
+    _buffer.clear();
+    _buffer.reserve(headerLength + m_payloadRef.size());
+    _buffer.resize(headerLength);
+    encodeHeader(_buffer.data(), headerLength, compactOptions);
+    _buffer.insert(_buffer.end(), m_payloadRef.begin(), m_payloadRef.end());
+    return true;
+}
 
+bool P2PMessage::encode(WriteBuffer& _frame)
+{
+    bytes compactOptions;
+    auto length = optionsLength(compactOptions);
+    if (length < 0)
+    {
+        return false;
+    }
+    auto headerLength = MESSAGE_HEADER_LENGTH + deadlineLength() + length;
+    _frame.buffer = std::make_shared<bytes>(headerLength);
+    encodeHeader(_frame.buffer->data(), headerLength, compactOptions);
+    // the payload is written by the gather-write without copy
+    _frame.payload = m_payloadRef;
+    _frame.holder = m_holder ? m_holder : m_payload;
     return true;
 }
 
@@ -225,7 +537,36 @@ ssize_t P2PMessage::decodeHeader(bytesConstRef _buffer)
     return offset;
 }
 
+void P2PMessage::reset()
+{
+    m_length = 0;
+    m_version = 0;
+    m_packetType = 0;
+    m_seq = 0;
+    m_ext = 0;
+    m_deadline = 0;
+    // the options may be shared by the copies of the message
+    if (m_options && m_options.use_count() == 1)
+    {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        m_options->reset();
+    }
+    else
+    {
+        m_options = std::make_shared<P2PMessageOptions>();
+    }
+    m_encodedOptions = nullptr;
+    m_holder = nullptr;
+    recycleBuffer(m_payload);
+    m_payloadRef = bytesConstRef();
+}
+
 ssize_t P2PMessage::decode(bytesConstRef _buffer)
+{
+    return decode(nullptr, _buffer);
+}
+
+ssize_t P2PMessage::decode(std::shared_ptr<bytes> _holder, bytesConstRef _buffer)
 {
     // check if packet header fully received
     if (_buffer.size() < P2PMessage::MESSAGE_HEADER_LENGTH)
@@ -241,10 +582,26 @@ ssize_t P2PMessage::decode(bytesConstRef _buffer)
         return MessageDecodeStatus::MESSAGE_INCOMPLETE;
     }
 
+    if (deadlineLength() > 0)
+    {
+        if (m_length < (size_t)offset + DEADLINE_LENGTH)
+        {
+            return MessageDecodeStatus::MESSAGE_ERROR;
+        }
+        // the time spent on the wire is not counted, it's small compared to the timeout
+        uint32_t remaining = boost::asio::detail::socket_ops::network_to_host_long(
+            *((uint32_t*)&_buffer[offset]));
+        m_deadline = utcSteadyTime() + remaining;
+        offset += DEADLINE_LENGTH;
+    }
+
     if (hasOptions())
     {
-        // encode options
-        auto optionsOffset = m_options->decode(_buffer.getCroppedData(offset));
+        // decode options, the compact version is resolved by the session received from
+        auto optionsBuffer = _buffer.getCroppedData(offset, m_length - offset);
+        auto optionsOffset = (m_ext & MessageExtFieldFlag::CompactOptions) ?
+                                 m_options->decodeCompact(_holder, optionsBuffer) :
+                                 m_options->decode(_holder, optionsBuffer);
         if (optionsOffset < 0)
         {
             return MessageDecodeStatus::MESSAGE_ERROR;
@@ -254,7 +611,15 @@ ssize_t P2PMessage::decode(bytesConstRef _buffer)
 
     auto data = _buffer.getCroppedData(offset, m_length - offset);
     // payload
-    m_payload = std::make_shared<bytes>(data.begin(), data.end());
+    if (_holder)
+    {
+        // reference the payload without copy
+        m_holder = _holder;
+        recycleBuffer(m_payload);
+        m_payloadRef = data;
+        return m_length;
+    }
+    setPayload(std::make_shared<bytes>(data.begin(), data.end()));
 
     return m_length;
 }
@@ -23,6 +23,8 @@
 #include <bcos-framework/libutilities/Common.h>
 #include <bcos-gateway/libnetwork/Common.h>
 #include <bcos-gateway/libnetwork/Message.h>
+#include <bcos-gateway/libnetwork/ObjectPool.h>
+#include <bcos-gateway/libp2p/OptionsDictionary.h>
 
 namespace bcos
 {
@@ -36,6 +38,15 @@ namespace gateway
 ///       src nodeID        : bytes
 ///       src nodeID count  :1 bytes
 ///       dst nodeIDs       : bytes
+///   options(compact version, MessageExtFieldFlag::CompactOptions):
+///       groupID           :entry
+///       src nodeID        :entry
+///       dst nodeID count  :varint
+///       dst nodeIDs       :entries
+///   entry:
+///       tag               :varint, (dictionary index << 2) | OptionsDictionary::EntryKind
+///       value length      :varint, Literal and Define only
+///       value             :bytes, Literal and Define only
 class P2PMessageOptions
 {
 public:
@@ -56,25 +67,99 @@ public:
     const static size_t MAX_DST_NODEID_COUNT = 255;
 
     bool encode(bytes& _buffer);
+    /// the length of the default version, -1 if any field is invalid
+    ssize_t encodedLength() const;
+    /// encode the default version into _data of encodedLength() bytes, the fields are checked by
+    /// encodedLength
+    void encode(byte* _data) const;
     ssize_t decode(bytesConstRef _buffer);
+    /// decode without copy, the nodeIDs reference the _buffer owned by _holder, the nodeIDs are
+    /// copied if the _holder is nullptr
+    ssize_t decode(std::shared_ptr<bytes> _holder, bytesConstRef _buffer);
+
+    /// encode in the compact version, the values are sent without index if _dictionary is nullptr
+    bool encodeCompact(bytes& _buffer, OptionsDictionary* _dictionary) const;
+    /// decode the compact version, the fields are empty until resolved by the dictionary of the
+    /// session received from
+    ssize_t decodeCompact(std::shared_ptr<bytes> _holder, bytesConstRef _buffer);
+    /// resolve the fields decoded in the compact version, false if any entry is invalid
+    bool resolve(OptionsDictionary* _dictionary);
+    bool unresolved() const { return !m_compactEntries.empty(); }
+
+    /// restore the initial state to be reused, the buffers referenced are released
+    void reset();
 
 public:
     std::string groupID() const { return m_groupID; }
     void setGroupID(const std::string& _groupID) { m_groupID = _groupID; }
 
-    std::shared_ptr<bytes> srcNodeID() const { return m_srcNodeID; }
-    void setSrcNodeID(std::shared_ptr<bytes> _srcNodeID) { m_srcNodeID = _srcNodeID; }
+    /// the nodeIDs decoded without copy are copied out when accessed by shared_ptr
+    std::shared_ptr<bytes> srcNodeID() const
+    {
+        if (m_holder)
+        {
+            return std::make_shared<bytes>(m_srcNodeIDRef.begin(), m_srcNodeIDRef.end());
+        }
+        return m_srcNodeID;
+    }
+    void setSrcNodeID(std::shared_ptr<bytes> _srcNodeID)
+    {
+        materialize();
+        m_srcNodeID = _srcNodeID;
+    }
 
-    std::vector<std::shared_ptr<bytes>>& dstNodeIDs() { return m_dstNodeIDs; }
+    std::vector<std::shared_ptr<bytes>>& dstNodeIDs()
+    {
+        materialize();
+        return m_dstNodeIDs;
+    }
     void setDstNodeIDs(const std::vector<std::shared_ptr<bytes>>& _dstNodeIDs)
     {
+        materialize();
         m_dstNodeIDs = _dstNodeIDs;
     }
 
+    /// access the nodeIDs without copy
+    bytesConstRef srcNodeIDRef() const
+    {
+        if (m_holder)
+        {
+            return m_srcNodeIDRef;
+        }
+        return m_srcNodeID ? bytesConstRef(m_srcNodeID->data(), m_srcNodeID->size()) :
+                             bytesConstRef();
+    }
+    size_t dstNodeIDCount() const
+    {
+        return m_holder ? m_dstNodeIDRefs.size() : m_dstNodeIDs.size();
+    }
+    bytesConstRef dstNodeIDRef(size_t _index) const
+    {
+        if (m_holder)
+        {
+            return m_dstNodeIDRefs.at(_index);
+        }
+        auto const& dstNodeID = m_dstNodeIDs.at(_index);
+        return bytesConstRef(dstNodeID->data(), dstNodeID->size());
+    }
+
 protected:
+    // copy the nodeIDs referenced to the buffer holder, and release the holder
+    void materialize();
+
     std::string m_groupID;
     std::shared_ptr<bytes> m_srcNodeID;
     std::vector<std::shared_ptr<bytes>> m_dstNodeIDs;
+
+    // the buffer referenced by m_srcNodeIDRef and m_dstNodeIDRefs
+    std::shared_ptr<bytes> m_holder;
+    bytesConstRef m_srcNodeIDRef;
+    std::vector<bytesConstRef> m_dstNodeIDRefs;
+
+    // the entries decoded in the compact version: groupID, src nodeID, dst nodeIDs, the values
+    // reference m_compactHolder
+    std::vector<OptionsDictionary::Entry> m_compactEntries;
+    std::shared_ptr<bytes> m_compactHolder;
 };
 
 /// Message format definition of gateway P2P network
@@ -85,6 +170,8 @@ protected:
 ///   packet type       :2 bytes
 ///   seq               :4 bytes
 ///   ext               :2 bytes
+///   deadline          :4 bytes, the remaining milliseconds of the request when sent, only the
+///                      messages with options and MessageExtFieldFlag::Deadline
 ///   options(default version):
 ///       groupID length    :1 bytes
 ///       groupID           : bytes
@@ -92,6 +179,7 @@ protected:
 ///       src nodeID        : bytes
 ///       src nodeID count  :1 bytes
 ///       dst nodeIDs       : bytes
+///   options(compact version): see P2PMessageOptions
 ///   payload           :X bytes
 class P2PMessage : public Message
 {
@@ -100,6 +188,8 @@ public:
 
     /// length(4) + version(2) + packetType(2) + seq(4) + ext(2)
     const static size_t MESSAGE_HEADER_LENGTH = 14;
+    /// the remaining milliseconds following the header with MessageExtFieldFlag::Deadline
+    const static size_t DEADLINE_LENGTH = 4;
 
 public:
     P2PMessage()
@@ -108,6 +198,7 @@ public:
         m_options = std::make_shared<P2PMessageOptions>();
     }
 
+
     virtual ~P2PMessage() {}
 
 public:
@@ -129,8 +220,38 @@ public:
     P2PMessageOptions::Ptr options() const { return m_options; }
     void setOptions(P2PMessageOptions::Ptr _options) { m_options = _options; }
 
-    std::shared_ptr<bytes> payload() const { return m_payload; }
-    void setPayload(std::shared_ptr<bytes> _payload) { m_payload = _payload; }
+    /// the steady time in milliseconds when the request expires, 0 means no deadline. the
+    /// remaining time is sent with MessageExtFieldFlag::Deadline and converted back to the
+    /// deadline by the clock of the receiver
+    uint64_t deadline() const { return m_deadline; }
+    void setDeadline(uint64_t _deadline) { m_deadline = _deadline; }
+    bool expired(uint64_t _now) const { return m_deadline > 0 && _now >= m_deadline; }
+
+    /// the payload decoded without copy is copied out when accessed by shared_ptr, use payloadRef
+    /// to access the payload without copy
+    std::shared_ptr<bytes> payload() const
+    {
+        if (m_holder)
+        {
+            return std::make_shared<bytes>(m_payloadRef.begin(), m_payloadRef.end());
+        }
+        return m_payload;
+    }
+    void setPayload(std::shared_ptr<bytes> _payload)
+    {
+        m_holder = nullptr;
+        m_payload = _payload;
+        m_payloadRef = bytesConstRef(m_payload->data(), m_payload->size());
+    }
+    bytesConstRef payloadRef() const { return m_payloadRef; }
+
+    /// the options encoded in the compact version by the dictionary of the session sent to,
+    /// encoded instead of the options if the ext has MessageExtFieldFlag::CompactOptions
+    std::shared_ptr<bytes> encodedOptions() const { return m_encodedOptions; }
+    void setEncodedOptions(std::shared_ptr<bytes> _encodedOptions)
+    {
+        m_encodedOptions = std::move(_encodedOptions);
+    }
 
 public:
     ssize_t decodeHeader(bytesConstRef _buffer);
@@ -142,33 +263,78 @@ public:
     }
 
     bool encode(bytes& _buffer) override;
+    /// the header and the options are encoded into _frame.buffer of the exact size, the payload is
+    /// referenced without copy
+    bool encode(WriteBuffer& _frame) override;
     ssize_t decode(bytesConstRef _buffer) override;
+    /// decode without copy, the payload and the options reference the _buffer owned by _holder,
+    /// the payload and the options are copied if the _holder is nullptr
+    ssize_t decode(std::shared_ptr<bytes> _holder, bytesConstRef _buffer) override;
     bool isRespPacket() const override { return (m_ext & MessageExtFieldFlag::Response) != 0; }
 
+    /// restore the initial state to be reused by the P2PMessageFactory, the options and the
+    /// payload are reused if not shared with the others
+    void reset();
+
 protected:
+    // the length of the options encoded, -1 if invalid, the compact options without the
+    // encodedOptions are encoded into _compactOptions
+    ssize_t optionsLength(bytes& _compactOptions) const;
+    // encode the header and the options into _data of _headerLength bytes
+    void encodeHeader(byte* _data, size_t _headerLength, bytes const& _compactOptions) const;
+    size_t deadlineLength() const
+    {
+        return (hasOptions() && (m_ext & MessageExtFieldFlag::Deadline)) ? DEADLINE_LENGTH : 0;
+    }
+
     uint32_t m_length = 0;
     uint16_t m_version = 0;
     uint16_t m_packetType = 0;
     uint32_t m_seq = 0;
     uint16_t m_ext = 0;
+    uint64_t m_deadline = 0;
 
-    P2PMessageOptions::Ptr m_options;  ///< options fields
+    P2PMessageOptions::Ptr m_options;         ///< options fields
+    std::shared_ptr<bytes> m_encodedOptions;  ///< compact options encoded for one session
 
     std::shared_ptr<bytes> m_payload;  ///< payload data
+    bytesConstRef m_payloadRef;        ///< reference to m_payload or the buffer of m_holder
+    std::shared_ptr<bytes> m_holder;   ///< the buffer referenced by the payload and the options
 };
 
 class P2PMessageFactory : public MessageFactory
 {
 public:
     using Ptr = std::shared_ptr<P2PMessageFactory>;
+    /// the idle messages kept for reuse by default
+    const static size_t c_defaultPoolCapacity = 1024;
+
+    /// the messages are recycled when released, _poolCapacity 0 means disable
+    explicit P2PMessageFactory(size_t _poolCapacity = c_defaultPoolCapacity)
+    {
+        if (_poolCapacity > 0)
+        {
+            m_pool = ObjectPool<P2PMessage>::create(_poolCapacity);
+        }
+    }
     virtual ~P2PMessageFactory() {}
 
 public:
     virtual Message::Ptr buildMessage()
     {
+        if (m_pool)
+        {
+            return m_pool->acquire();
+        }
         auto message = std::make_shared<P2PMessage>();
         return message;
     }
+
+    /// nullptr if the pool is disabled
+    ObjectPool<P2PMessage>::Ptr pool() const { return m_pool; }
+
+private:
+    ObjectPool<P2PMessage>::Ptr m_pool;
 };
 
 inline std::ostream& operator<<(std::ostream& _out, const P2PMessage _p2pMessage)
@@ -19,6 +19,7 @@ using namespace bcos::gateway;
 P2PSession::P2PSession()
 {
     m_p2pInfo = std::make_shared<P2PInfo>();
+    m_linkQuality = std::make_shared<LinkQuality>();
     P2PSESSION_LOG(INFO) << "[P2PSession::P2PSession] this=" << this;
 }
 
@@ -34,6 +35,8 @@ void P2PSession::start()
         m_run = true;
 
         m_session->start();
+        // negotiate the protocol before any other message
+        handshake();
         heartBeat();
     }
 }
@@ -60,15 +63,38 @@ void P2PSession::heartBeat()
             auto message =
                 std::dynamic_pointer_cast<P2PMessage>(service->messageFactory()->buildMessage());
             message->setPacketType(MessageType::Heartbeat);
+            message->setVersion(m_session->protocolVersion());
             uint32_t statusSeq =
                 boost::asio::detail::socket_ops::host_to_network_long(service->statusSeq());
             auto payload = std::make_shared<bytes>((byte*)&statusSeq, (byte*)&statusSeq + 4);
+            // acknowledge the entries of the options dictionary learned, the legacy gateways only
+            // read the statusSeq
+            if (message->version() >= c_compactOptionsVersion)
+            {
+                uint32_t learned = boost::asio::detail::socket_ops::host_to_network_long(
+                    m_optionsDictionary.learned());
+                payload->insert(payload->end(), (byte*)&learned, (byte*)&learned + 4);
+            }
+            // measure the rtt by the echo of the peer, the echo is always the tail of the payload
+            // whatever the version is
+            if (m_session->supports(P2PFeature::HeartbeatEcho))
+            {
+                m_linkQuality->encodeEcho(*payload, LinkQuality::steadyTimeUs());
+            }
             message->setPayload(payload);
 
             P2PSESSION_LOG(DEBUG) << LOG_DESC("P2PSession onHeartBeat")
                                   << LOG_KV("p2pid", m_p2pInfo->p2pID)
                                   << LOG_KV("endpoint", m_session->nodeIPEndpoint())
-                                  << LOG_KV("statusSeq", service->statusSeq());
+                                  << LOG_KV("statusSeq", service->statusSeq())
+                                  << LOG_KV("version", m_session->protocolVersion())
+                                  << LOG_KV("features", m_session->features())
+                                  << LOG_KV("dictionarySent", m_optionsDictionary.acknowledged())
+                                  << LOG_KV("dictionaryLearned", m_optionsDictionary.learned())
+                                  << LOG_KV("writeQueue", m_session->writeQueueMetrics())
+                                  << LOG_KV("dispatch", m_session->dispatchMetrics())
+                                  << LOG_KV("link", m_linkQuality->toString())
+                                  << LOG_KV("compression", m_compressionMetrics.toString());
 
             m_session->asyncSendMessage(message);
         }
@@ -89,4 +115,23 @@ void P2PSession::heartBeat()
             }
         });
     }
-}
\ No newline at end of file
+}
+
+void P2PSession::handshake()
+{
+    auto service = m_service.lock();
+    if (!service || !m_session || !m_session->actived())
+    {
+        return;
+    }
+    auto message = std::dynamic_pointer_cast<P2PMessage>(service->messageFactory()->buildMessage());
+    message->setPacketType(MessageType::Handshake);
+    // the peer has not negotiated the version
+    message->setVersion(c_legacyProtocolVersion);
+    message->setPayload(std::make_shared<bytes>(service->protocolInfo().encode()));
+    P2PSESSION_LOG(INFO) << LOG_DESC("P2PSession handshake") << LOG_KV("p2pid", m_p2pInfo->p2pID)
+                         << LOG_KV("endpoint", m_session->nodeIPEndpoint())
+                         << LOG_KV("maxVersion", service->protocolInfo().maxVersion())
+                         << LOG_KV("features", service->protocolInfo().features());
+    m_session->asyncSendMessage(message);
+}
@@ -8,6 +8,8 @@
 #include <bcos-gateway/libnetwork/Common.h>
 #include <bcos-gateway/libnetwork/SessionFace.h>
 #include <bcos-gateway/libp2p/Common.h>
+#include <bcos-gateway/libp2p/LinkQuality.h>
+#include <bcos-gateway/libp2p/MessageCompressor.h>
 #include <bcos-gateway/libp2p/P2PMessage.h>
 #include <memory>
 
@@ -31,6 +33,8 @@ public:
     virtual void stop(DisconnectReason reason);
     virtual bool actived() { return m_run; }
     virtual void heartBeat();
+    /// send the protocol versions and the features supported to the peer
+    virtual void handshake();
 
     virtual SessionFace::Ptr session() { return m_session; }
     virtual void setSession(std::shared_ptr<SessionFace> session) { m_session = session; }
@@ -48,6 +52,12 @@ public:
     virtual std::weak_ptr<Service> service() { return m_service; }
     virtual void setService(std::weak_ptr<Service> service) { m_service = service; }
 
+    virtual CompressionMetrics& compressionMetrics() { return m_compressionMetrics; }
+    /// the groupIDs and nodeIDs of the compact options sent and received by this session
+    virtual OptionsDictionary& optionsDictionary() { return m_optionsDictionary; }
+    /// measured by the heartbeats and the requests sent by this session
+    virtual LinkQuality::Ptr linkQuality() const { return m_linkQuality; }
+
 private:
     SessionFace::Ptr m_session;
     /// gateway p2p info
@@ -55,6 +65,9 @@ private:
     std::weak_ptr<Service> m_service;
     std::shared_ptr<boost::asio::deadline_timer> m_timer;
     bool m_run = false;
+    CompressionMetrics m_compressionMetrics;
+    OptionsDictionary m_optionsDictionary;
+    LinkQuality::Ptr m_linkQuality;
     const static uint32_t HEARTBEAT_INTERVEL = 5000;
 };
 
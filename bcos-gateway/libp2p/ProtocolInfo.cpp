@@ -0,0 +1,68 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: the protocol versions and features exchanged by the handshake of the session
+ * @file ProtocolInfo.cpp
+ */
+#include <bcos-gateway/libp2p/ProtocolInfo.h>
+#include <boost/asio/detail/socket_ops.hpp>
+
+using namespace bcos;
+using namespace bcos::gateway;
+
+bytes ProtocolInfo::encode() const
+{
+    bytes payload;
+    payload.reserve(PAYLOAD_MIN_LENGTH);
+    uint16_t minVersion = boost::asio::detail::socket_ops::host_to_network_short(m_minVersion);
+    uint16_t maxVersion = boost::asio::detail::socket_ops::host_to_network_short(m_maxVersion);
+    uint32_t features = boost::asio::detail::socket_ops::host_to_network_long(m_features);
+    payload.insert(payload.end(), (byte*)&minVersion, (byte*)&minVersion + 2);
+    payload.insert(payload.end(), (byte*)&maxVersion, (byte*)&maxVersion + 2);
+    payload.insert(payload.end(), (byte*)&features, (byte*)&features + 4);
+    return payload;
+}
+
+bool ProtocolInfo::decode(bytesConstRef _payload)
+{
+    if (_payload.size() < PAYLOAD_MIN_LENGTH)
+    {
+        return false;
+    }
+    uint16_t minVersion;
+    uint16_t maxVersion;
+    uint32_t features;
+    memcpy(&minVersion, _payload.data(), 2);
+    memcpy(&maxVersion, _payload.data() + 2, 2);
+    memcpy(&features, _payload.data() + 4, 4);
+    m_minVersion = boost::asio::detail::socket_ops::network_to_host_short(minVersion);
+    m_maxVersion = boost::asio::detail::socket_ops::network_to_host_short(maxVersion);
+    m_features = boost::asio::detail::socket_ops::network_to_host_long(features);
+    return m_minVersion <= m_maxVersion;
+}
+
+bool ProtocolInfo::negotiate(
+    ProtocolInfo const& _peer, uint16_t& _version, uint32_t& _features) const
+{
+    auto minVersion = std::max(m_minVersion, _peer.minVersion());
+    auto maxVersion = std::min(m_maxVersion, _peer.maxVersion());
+    if (minVersion > maxVersion)
+    {
+        return false;
+    }
+    _version = maxVersion;
+    _features = m_features & _peer.features();
+    return true;
+}
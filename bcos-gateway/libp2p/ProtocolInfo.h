@@ -0,0 +1,64 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: the protocol versions and features exchanged by the handshake of the session
+ * @file ProtocolInfo.h
+ */
+#pragma once
+#include <bcos-framework/libutilities/Common.h>
+#include <bcos-gateway/libnetwork/Common.h>
+
+namespace bcos
+{
+namespace gateway
+{
+/// Handshake payload format definition
+///
+/// fields:
+///   min version       :2 bytes
+///   max version       :2 bytes
+///   features          :4 bytes, the P2PFeature supported
+/// the fields appended by the later versions are ignored
+///
+/// both sides send the handshake when the session starts, the legacy gateways ignore it and the
+/// session keeps c_legacyProtocolVersion without any feature
+class ProtocolInfo
+{
+public:
+    /// min version(2) + max version(2) + features(4)
+    const static size_t PAYLOAD_MIN_LENGTH = 8;
+
+    ProtocolInfo() = default;
+    ProtocolInfo(uint16_t _minVersion, uint16_t _maxVersion, uint32_t _features)
+      : m_minVersion(_minVersion), m_maxVersion(_maxVersion), m_features(_features)
+    {}
+
+    bytes encode() const;
+    bool decode(bytesConstRef _payload);
+
+    /// the highest version and the features supported by both sides, false if no common version
+    bool negotiate(ProtocolInfo const& _peer, uint16_t& _version, uint32_t& _features) const;
+
+    uint16_t minVersion() const { return m_minVersion; }
+    uint16_t maxVersion() const { return m_maxVersion; }
+    uint32_t features() const { return m_features; }
+
+private:
+    uint16_t m_minVersion = c_legacyProtocolVersion;
+    uint16_t m_maxVersion = c_legacyProtocolVersion;
+    uint32_t m_features = 0;
+};
+}  // namespace gateway
+}  // namespace bcos
@@ -13,13 +13,51 @@
 #include <bcos-gateway/libp2p/P2PMessage.h>
 #include <bcos-gateway/libp2p/P2PSession.h>  // for P2PSession
 #include <bcos-gateway/libp2p/Service.h>
+#include <boost/functional/hash.hpp>
 #include <boost/random.hpp>
+#include <algorithm>
 
 using namespace bcos;
 using namespace bcos::gateway;
 
 static const uint32_t CHECK_INTERVEL = 10000;
 
+namespace
+{
+// the messages of the same group between the same nodes belong to one flow and keep their order,
+// the messages without options are independent requests and spread by seq
+size_t flowKey(P2PMessage::Ptr const& _message)
+{
+    if (!_message->hasOptions())
+    {
+        return _message->seq();
+    }
+    auto const& options = _message->options();
+    size_t key = std::hash<std::string>()(options->groupID());
+    auto srcNodeID = options->srcNodeIDRef();
+    boost::hash_combine(key, boost::hash_range(srcNodeID.begin(), srcNodeID.end()));
+    for (size_t i = 0; i < options->dstNodeIDCount(); ++i)
+    {
+        auto dstNodeID = options->dstNodeIDRef(i);
+        boost::hash_combine(key, boost::hash_range(dstNodeID.begin(), dstNodeID.end()));
+    }
+    return key;
+}
+
+// decompress the payload and resolve the compact options of the message received from _session,
+// false if the message is invalid
+bool restoreMessage(P2PMessage::Ptr const& _message, P2PSession::Ptr const& _session)
+{
+    if (!MessageCompressor::decompress(_message, &_session->compressionMetrics()) ||
+        !_message->options()->resolve(&_session->optionsDictionary()))
+    {
+        return false;
+    }
+    _message->setExt(_message->ext() & ~MessageExtFieldFlag::CompactOptions);
+    return true;
+}
+}  // namespace
+
 Service::Service() {}
 
 void Service::start()
@@ -56,13 +94,21 @@ void Service::stop()
 
         /// disconnect sessions
         RecursiveGuard l(x_sessions);
-        for (auto session : m_sessions)
+        auto sessions = m_sessionTable.snapshot();
+        for (auto const& session : sessions->sessions)
         {
             session.second->stop(ClientQuit);
         }
+        for (auto const& stripes : sessions->stripeSessions)
+        {
+            for (auto const& session : stripes.second)
+            {
+                session->stop(ClientQuit);
+            }
+        }
 
         /// clear sessions
-        m_sessions.clear();
+        m_sessionTable.publish(std::make_shared<SessionTable::Snapshot>());
     }
 }
 
@@ -102,9 +148,19 @@ void Service::heartBeat()
             it.first, std::bind(&Service::onConnect, shared_from_this(), std::placeholders::_1,
                           std::placeholders::_2, std::placeholders::_3));
     }
+    connectStripes();
+    SERVICE_LOG(INFO) << LOG_DESC("heartBeat")
+                      << LOG_KV("connected count", m_sessionTable.snapshot()->sessions.size())
+                      << LOG_KV("expiredRequests", m_expiredRequests);
+    if (m_host->dispatchLanes())
     {
-        RecursiveGuard l(x_sessions);
-        SERVICE_LOG(INFO) << LOG_DESC("heartBeat") << LOG_KV("connected count", m_sessions.size());
+        SERVICE_LOG(INFO) << LOG_DESC("heartBeat dispatch metrics")
+                          << LOG_KV("metrics", m_host->dispatchLanes()->toString());
+    }
+    if (m_host->sslSessionCache())
+    {
+        SERVICE_LOG(INFO) << LOG_DESC("heartBeat handshake metrics")
+                          << LOG_KV("metrics", m_host->sslSessionCache()->metrics());
     }
 
     auto self = std::weak_ptr<Service>(shared_from_this());
@@ -165,13 +221,19 @@ void Service::onConnect(
                       << LOG_KV("endpoint", peer);
 
     RecursiveGuard l(x_sessions);
-    auto it = m_sessions.find(p2pID);
-    if (it != m_sessions.end() && it->second->actived())
+    auto primary = m_sessionTable.snapshot()->find(p2pID);
+    // the peer connected already, keep the session as a stripe until connectionsPerPeer reached
+    bool stripe = false;
+    if (primary && primary->actived())
     {
-        SERVICE_LOG(INFO) << "Disconnect duplicate peer" << LOG_KV("p2pid", p2pID);
-        updateStaticNodes(session->socket(), p2pID);
-        session->disconnect(DuplicatePeer);
-        return;
+        if (sessionCount(p2pID) >= m_connectionsPerPeer)
+        {
+            SERVICE_LOG(INFO) << "Disconnect duplicate peer" << LOG_KV("p2pid", p2pID);
+            updateStaticNodes(session->socket(), p2pID);
+            session->disconnect(DuplicatePeer);
+            return;
+        }
+        stripe = true;
     }
 
     if (p2pID == id())
@@ -192,20 +254,63 @@ void Service::onConnect(
         std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, p2pSessionWeakPtr));
     p2pSession->start();
     updateStaticNodes(session->socket(), p2pID);
-    if (it != m_sessions.end())
-    {
-        it->second = p2pSession;
-    }
-    else
+    // publish the new version of the sessions, the senders holding the old one are not blocked
+    auto sessions = m_sessionTable.copy();
+    if (stripe)
     {
-        m_sessions.insert(std::make_pair(p2pID, p2pSession));
+        sessions->stripeSessions[p2pID].push_back(p2pSession);
+        m_sessionTable.publish(sessions);
+        SERVICE_LOG(INFO) << LOG_DESC("Stripe connection established") << LOG_KV("p2pid", p2pID)
+                          << LOG_KV("endpoint", session->nodeIPEndpoint())
+                          << LOG_KV("sessions", sessionCount(p2pID));
+        connectStripes();
+        return;
     }
+    sessions->sessions[p2pID] = p2pSession;
+    m_sessionTable.publish(sessions);
     SERVICE_LOG(INFO) << LOG_DESC("Connection established") << LOG_KV("p2pid", p2pID)
                       << LOG_KV("endpoint", session->nodeIPEndpoint());
+    connectStripes();
 }
 
 void Service::onDisconnect(NetworkException e, P2PSession::Ptr p2pSession)
 {
+    {
+        RecursiveGuard l(x_sessions);
+        auto p2pID = p2pSession->p2pID();
+        if (m_sessionTable.snapshot()->stripeSessions.count(p2pID))
+        {
+            // the peer is still connected by the other sessions, the disconnection handlers are
+            // not notified
+            auto sessions = m_sessionTable.copy();
+            auto& stripes = sessions->stripeSessions[p2pID];
+            auto it = sessions->sessions.find(p2pID);
+            auto pos = std::find(stripes.begin(), stripes.end(), p2pSession);
+            bool primary = (it != sessions->sessions.end() && it->second == p2pSession);
+            if (pos != stripes.end() || primary)
+            {
+                if (pos != stripes.end())
+                {
+                    stripes.erase(pos);
+                }
+                else
+                {
+                    // the primary session closed, promote a stripe session
+                    it->second = stripes.back();
+                    stripes.pop_back();
+                }
+                SERVICE_LOG(INFO) << LOG_DESC("onDisconnect stripe session")
+                                  << LOG_KV("p2pid", p2pID) << LOG_KV("errorCode", e.errorCode())
+                                  << LOG_KV("stripes", stripes.size());
+                if (stripes.empty())
+                {
+                    sessions->stripeSessions.erase(p2pID);
+                }
+                m_sessionTable.publish(sessions);
+                return;
+            }
+        }
+    }
     // handle all registered handlers
     for (const auto& handler : m_disconnectionHandlers)
     {
@@ -213,14 +318,15 @@ void Service::onDisconnect(NetworkException e, P2PSession::Ptr p2pSession)
     }
 
     RecursiveGuard l(x_sessions);
-    auto it = m_sessions.find(p2pSession->p2pID());
-    if (it != m_sessions.end() && it->second == p2pSession)
+    if (m_sessionTable.snapshot()->find(p2pSession->p2pID()) == p2pSession)
     {
-        SERVICE_LOG(TRACE) << "Service onDisconnect and remove from m_sessions"
+        SERVICE_LOG(TRACE) << "Service onDisconnect and remove from m_sessionTable"
                            << LOG_KV("p2pid", p2pSession->p2pID())
                            << LOG_KV("endpoint", p2pSession->session()->nodeIPEndpoint());
 
-        m_sessions.erase(it);
+        auto sessions = m_sessionTable.copy();
+        sessions->sessions.erase(p2pSession->p2pID());
+        m_sessionTable.publish(sessions);
         if (e.errorCode() == P2PExceptionType::DuplicateSession)
             return;
         SERVICE_LOG(WARNING) << LOG_DESC("onDisconnect") << LOG_KV("errorCode", e.errorCode())
@@ -244,6 +350,7 @@ void Service::sendMessageBySession(
     auto seq = messageFactory()->newSeq();
     p2pMessage->setSeq(seq);
     p2pMessage->setPacketType(_packetType);
+    p2pMessage->setVersion(_p2pSession->session()->protocolVersion());
     p2pMessage->setPayload(std::make_shared<bytes>(_payload.begin(), _payload.end()));
 
     _p2pSession->session()->asyncSendMessage(p2pMessage);
@@ -259,6 +366,7 @@ void Service::sendRespMessageBySession(
     auto respMessage = std::static_pointer_cast<P2PMessage>(messageFactory()->buildMessage());
 
     respMessage->setSeq(_p2pMessage->seq());
+    respMessage->setVersion(_p2pSession->session()->protocolVersion());
     respMessage->setRespPacket();
     respMessage->setPayload(std::make_shared<bytes>(_payload.begin(), _payload.end()));
 
@@ -303,6 +411,25 @@ void Service::onMessage(NetworkException e, SessionFace::Ptr session, Message::P
             return;
         }
 
+        auto p2pMessage = std::dynamic_pointer_cast<P2PMessage>(message);
+        // the peer never sends the version higher than negotiated
+        if (p2pMessage->version() > c_maxProtocolVersion)
+        {
+            SERVICE_LOG(WARNING) << LOG_DESC("drop the message of the unsupported version")
+                                 << LOG_KV("p2pid", p2pID) << LOG_KV("endpoint", nodeIPEndpoint)
+                                 << LOG_KV("version", p2pMessage->version())
+                                 << LOG_KV("seq", p2pMessage->seq());
+            return;
+        }
+        // decompressed and resolved by the worker thread instead of the io thread
+        if (!restoreMessage(p2pMessage, p2pSession))
+        {
+            SERVICE_LOG(WARNING) << LOG_DESC("drop the message failed to restore")
+                                 << LOG_KV("p2pid", p2pID) << LOG_KV("endpoint", nodeIPEndpoint)
+                                 << LOG_KV("seq", p2pMessage->seq());
+            return;
+        }
+
         auto serviceWeakPtr = std::weak_ptr<Service>(shared_from_this());
         auto gateway = m_gateway.lock();
         if (!gateway)
@@ -313,13 +440,11 @@ void Service::onMessage(NetworkException e, SessionFace::Ptr session, Message::P
         }
 
         /// SERVICE_LOG(TRACE) << "Service onMessage: " << message->seq();
-        auto p2pMessage = std::dynamic_pointer_cast<P2PMessage>(message);
         auto options = p2pMessage->options();
         auto groupID = options->groupID();
-        auto srcNodeID = options->srcNodeID();
-        auto payload = p2pMessage->payload();
-        auto bytesConstRefPayload = bytesConstRef(payload->data(), payload->size());
-        const auto& dstNodeIDs = options->dstNodeIDs();
+        // the payload and the nodeIDs reference the receive buffer without copy
+        auto srcNodeID = options->srcNodeIDRef();
+        auto bytesConstRefPayload = p2pMessage->payloadRef();
 
         SERVICE_LOG(TRACE) << LOG_DESC("onMessage receive message") << LOG_KV("p2pid", p2pID)
                            << LOG_KV("endpoint", nodeIPEndpoint) << LOG_KV("seq", p2pMessage->seq())
@@ -338,9 +463,7 @@ void Service::onMessage(NetworkException e, SessionFace::Ptr session, Message::P
         {
         case MessageType::Handshake:
         {
-            // TODO: Process handshake packet logic, handshake protocol and determine
-            // the version, when handshake finished the version field of P2PMessage
-            // should be set
+            onHandshake(p2pSession, bytesConstRefPayload);
         }
         break;
         case MessageType::Heartbeat:
@@ -349,6 +472,23 @@ void Service::onMessage(NetworkException e, SessionFace::Ptr session, Message::P
                 *((uint32_t*)bytesConstRefPayload.data()));
             bool statusSeqChanged = false;
             gateway->gatewayNodeManager()->onReceiveStatusSeq(p2pID, statusSeq, statusSeqChanged);
+            // the entries of the options dictionary learned by the peer
+            if (p2pMessage->version() >= c_compactOptionsVersion &&
+                bytesConstRefPayload.size() >= 8)
+            {
+                p2pSession->optionsDictionary().acknowledge(
+                    boost::asio::detail::socket_ops::network_to_host_long(
+                        *((uint32_t*)(bytesConstRefPayload.data() + 4))));
+            }
+            // the echo is the tail of the payload, after the fields of the version
+            if (session->supports(P2PFeature::HeartbeatEcho) &&
+                bytesConstRefPayload.size() >= 4 + LinkQuality::c_echoSize)
+            {
+                p2pSession->linkQuality()->decodeEcho(
+                    bytesConstRefPayload.getCroppedData(
+                        bytesConstRefPayload.size() - LinkQuality::c_echoSize),
+                    LinkQuality::steadyTimeUs());
+            }
             if (statusSeqChanged)
             {
                 sendMessageBySession(MessageType::RequestNodeIDs, bytesConstRef(), p2pSession);
@@ -374,8 +514,24 @@ void Service::onMessage(NetworkException e, SessionFace::Ptr session, Message::P
         break;
         case MessageType::PeerToPeerMessage:
         {
-            bcos::crypto::NodeIDPtr srcNodeIDPtr = m_keyFactory->createKey(*srcNodeID.get());
-            bcos::crypto::NodeIDPtr dstNodeIDPtr = m_keyFactory->createKey(*dstNodeIDs[0].get());
+            if (options->dstNodeIDCount() == 0)
+            {
+                SERVICE_LOG(WARNING) << LOG_DESC("PeerToPeerMessage without dstNodeID")
+                                     << LOG_KV("p2pid", p2pID) << LOG_KV("seq", message->seq());
+                break;
+            }
+            // the sender has given up the request, drop it instead of handling it for nothing
+            if (p2pMessage->expired(utcSteadyTime()))
+            {
+                m_expiredRequests++;
+                SERVICE_LOG(DEBUG) << LOG_DESC("drop the expired PeerToPeerMessage")
+                                   << LOG_KV("p2pid", p2pID) << LOG_KV("seq", message->seq())
+                                   << LOG_KV("group", groupID);
+                break;
+            }
+            bcos::crypto::NodeIDPtr srcNodeIDPtr = m_keyFactory->createKey(srcNodeID);
+            bcos::crypto::NodeIDPtr dstNodeIDPtr =
+                m_keyFactory->createKey(options->dstNodeIDRef(0));
             gateway->onReceiveP2PMessage(groupID, srcNodeIDPtr, dstNodeIDPtr, bytesConstRefPayload,
                 [groupID, srcNodeIDPtr, dstNodeIDPtr, message, p2pSession, p2pMessage,
                     serviceWeakPtr](Error::Ptr _error) {
@@ -403,7 +559,7 @@ void Service::onMessage(NetworkException e, SessionFace::Ptr session, Message::P
         break;
         case MessageType::BroadcastMessage:
         {
-            bcos::crypto::NodeIDPtr srcNodeIDPtr = m_keyFactory->createKey(*srcNodeID.get());
+            bcos::crypto::NodeIDPtr srcNodeIDPtr = m_keyFactory->createKey(srcNodeID);
             gateway->onReceiveBroadcastMessage(groupID, srcNodeIDPtr, bytesConstRefPayload);
         }
         break;
@@ -480,9 +636,8 @@ P2PMessage::Ptr Service::sendMessageByNodeID(P2pID nodeID, P2PMessage::Ptr messa
 
 bool Service::connected(std::string const& _nodeID)
 {
-    RecursiveGuard l(x_sessions);
-    auto it = m_sessions.find(_nodeID);
-    return (it != m_sessions.end() && it->second->actived());
+    auto session = m_sessionTable.snapshot()->find(_nodeID);
+    return session && session->actived();
 }
 void Service::asyncSendMessageByNodeID(
     P2pID nodeID, P2PMessage::Ptr message, CallbackFuncWithSession callback, Options options)
@@ -495,21 +650,27 @@ void Service::asyncSendMessageByNodeID(
             return;
         }
 
-        RecursiveGuard l(x_sessions);
-        auto it = m_sessions.find(nodeID);
+        auto sessions = m_sessionTable.snapshot();
+        auto primary = sessions->find(nodeID);
 
-        if (it != m_sessions.end() && it->second->actived())
+        if (primary && primary->actived())
         {
             if (message->seq() == 0)
             {
                 message->setSeq(m_messageFactory->newSeq());
             }
-            auto session = it->second;
+            auto session = stripeSession(*sessions, nodeID, primary, message);
+            auto sendMessage = formatMessage(message, session);
             if (callback)
             {
-                session->session()->asyncSendMessage(message, options,
+                session->session()->asyncSendMessage(sendMessage, options,
                     [session, callback](NetworkException e, Message::Ptr message) {
                         P2PMessage::Ptr p2pMessage = std::dynamic_pointer_cast<P2PMessage>(message);
+                        if (p2pMessage && !restoreMessage(p2pMessage, session))
+                        {
+                            e = NetworkException(ProtocolError, "ProtocolError");
+                            p2pMessage = nullptr;
+                        }
                         if (callback)
                         {
                             callback(e, session, p2pMessage);
@@ -518,7 +679,7 @@ void Service::asyncSendMessageByNodeID(
             }
             else
             {
-                session->session()->asyncSendMessage(message, options, nullptr);
+                session->session()->asyncSendMessage(sendMessage, options, nullptr);
             }
         }
         else
@@ -552,16 +713,21 @@ void Service::asyncBroadcastMessage(P2PMessage::Ptr message, Options options)
 {
     try
     {
-        std::unordered_map<P2pID, P2PSession::Ptr> sessions;
+        if (message->seq() == 0)
         {
-            RecursiveGuard l(x_sessions);
-            sessions = m_sessions;
+            message->setSeq(m_messageFactory->newSeq());
         }
-
-        for (auto s : sessions)
+        auto table = m_sessionTable.snapshot();
+        std::vector<P2PSession::Ptr> sessions;
+        sessions.reserve(table->sessions.size());
+        for (auto const& it : table->sessions)
         {
-            asyncSendMessageByNodeID(s.first, message, CallbackFuncWithSession(), options);
+            if (it.second->actived())
+            {
+                sessions.push_back(stripeSession(*table, it.first, it.second, message));
+            }
         }
+        asyncSendMessageBySessions(sessions, message, options);
     }
     catch (std::exception& e)
     {
@@ -570,14 +736,130 @@ void Service::asyncBroadcastMessage(P2PMessage::Ptr message, Options options)
     }
 }
 
+void Service::asyncSendMessageByNodeIDs(
+    std::vector<P2pID> const& _nodeIDs, P2PMessage::Ptr _message, Options _options)
+{
+    try
+    {
+        if (_message->seq() == 0)
+        {
+            _message->setSeq(m_messageFactory->newSeq());
+        }
+        auto table = m_sessionTable.snapshot();
+        std::vector<P2PSession::Ptr> sessions;
+        sessions.reserve(_nodeIDs.size());
+        for (auto const& nodeID : _nodeIDs)
+        {
+            if (nodeID == id())
+            {
+                continue;
+            }
+            auto primary = table->find(nodeID);
+            if (!primary || !primary->actived())
+            {
+                SERVICE_LOG(WARNING) << "Node inactived" << LOG_KV("nodeid", nodeID);
+                continue;
+            }
+            sessions.push_back(stripeSession(*table, nodeID, primary, _message));
+        }
+        asyncSendMessageBySessions(sessions, _message, _options);
+    }
+    catch (std::exception& e)
+    {
+        SERVICE_LOG(WARNING) << LOG_DESC("asyncSendMessageByNodeIDs")
+                             << LOG_KV("what", boost::diagnostic_information(e));
+    }
+}
+
+void Service::asyncSendMessageBySessions(std::vector<P2PSession::Ptr> const& _sessions,
+    P2PMessage::Ptr const& _message, Options const& _options)
+{
+    try
+    {
+        // the sessions of the same format(protocol version, compression and the compact options
+        // encoded by the dictionary of the session) share one frame, the dictionaries of the
+        // sessions are the same in most cases
+        std::map<std::tuple<uint16_t, bool, bytes>, std::vector<P2PSession::Ptr>> formats;
+        size_t compressedSessions = 0;
+        for (auto const& session : _sessions)
+        {
+            auto compress =
+                m_messageCompressor && session->session()->supports(P2PFeature::Compression);
+            auto version = session->session()->protocolVersion();
+            bytes encodedOptions;
+            if (version >= c_compactOptionsVersion && _message->hasOptions() &&
+                !_message->options()->encodeCompact(
+                    encodedOptions, &session->optionsDictionary()))
+            {
+                SERVICE_LOG(ERROR) << LOG_DESC("asyncSendMessageBySessions: encode options failed")
+                                   << LOG_KV("packetType", _message->packetType())
+                                   << LOG_KV("seq", _message->seq());
+                return;
+            }
+            compressedSessions += compress ? 1 : 0;
+            formats[std::make_tuple(version, compress, std::move(encodedOptions))].push_back(
+                session);
+        }
+        // compress once for all the versions
+        P2PMessage::Ptr compressed;
+        uint64_t compressTime = 0;
+        if (compressedSessions > 0)
+        {
+            compressed = m_messageCompressor->compress(_message, compressTime);
+        }
+        for (auto const& it : formats)
+        {
+            auto version = std::get<0>(it.first);
+            auto compress = std::get<1>(it.first);
+            auto const& encodedOptions = std::get<2>(it.first);
+            auto message = (compress && compressed) ? compressed : _message;
+            auto compact = version >= c_compactOptionsVersion && _message->hasOptions();
+            if (message->version() != version || compact)
+            {
+                message = std::make_shared<P2PMessage>(*message);
+                message->setVersion(version);
+            }
+            if (compact)
+            {
+                message->setExt(message->ext() | MessageExtFieldFlag::CompactOptions);
+                message->setEncodedOptions(std::make_shared<bytes>(encodedOptions));
+            }
+            // encode once, all the sessions reference the same frame in their write queues
+            auto encodedMessage = EncodedMessage::encode(message);
+            if (!encodedMessage)
+            {
+                SERVICE_LOG(ERROR) << LOG_DESC("asyncSendMessageBySessions: encode message failed")
+                                   << LOG_KV("packetType", _message->packetType())
+                                   << LOG_KV("seq", _message->seq());
+                return;
+            }
+            for (auto const& session : it.second)
+            {
+                if (compress && compressed)
+                {
+                    // the time is shared by the sessions
+                    session->compressionMetrics().onCompressed(_message->payloadRef().size(),
+                        compressed->payloadRef().size(), compressTime / compressedSessions);
+                }
+                session->session()->asyncSendEncodedMessage(encodedMessage, _options, nullptr);
+            }
+        }
+    }
+    catch (std::exception& e)
+    {
+        SERVICE_LOG(WARNING) << LOG_DESC("asyncSendMessageBySessions")
+                             << LOG_KV("what", boost::diagnostic_information(e));
+    }
+}
+
 P2PInfos Service::sessionInfos()
 {
     P2PInfos infos;
     try
     {
-        RecursiveGuard l(x_sessions);
-        auto s = m_sessions;
-        for (auto const& i : s)
+        auto sessions = m_sessionTable.snapshot();
+        infos.reserve(sessions->sessions.size());
+        for (auto const& i : sessions->sessions)
         {
             infos.push_back(i.second->p2pInfo());
         }
@@ -592,14 +874,213 @@ P2PInfos Service::sessionInfos()
 
 bool Service::isConnected(P2pID const& nodeID) const
 {
-    RecursiveGuard l(x_sessions);
-    auto it = m_sessions.find(nodeID);
+    auto session = m_sessionTable.snapshot()->find(nodeID);
+    return session && session->actived();
+}
+
+size_t Service::sessionCount(P2pID const& _nodeID) const
+{
+    auto sessions = m_sessionTable.snapshot();
+    size_t count = 0;
+    auto primary = sessions->find(_nodeID);
+    if (primary && primary->actived())
+    {
+        ++count;
+    }
+    auto stripeIt = sessions->stripeSessions.find(_nodeID);
+    if (stripeIt != sessions->stripeSessions.end())
+    {
+        for (auto const& session : stripeIt->second)
+        {
+            count += session->actived() ? 1 : 0;
+        }
+    }
+    return count;
+}
+
+P2PSession::Ptr Service::stripeSession(SessionTable::Snapshot const& _sessions,
+    P2pID const& _nodeID, P2PSession::Ptr const& _primary, P2PMessage::Ptr const& _message) const
+{
+    if (m_connectionsPerPeer <= 1)
+    {
+        return _primary;
+    }
+    auto it = _sessions.stripeSessions.find(_nodeID);
+    if (it == _sessions.stripeSessions.end() || it->second.empty())
+    {
+        return _primary;
+    }
+    auto index = flowKey(_message) % (it->second.size() + 1);
+    if (index == 0 || !it->second[index - 1]->actived())
+    {
+        return _primary;
+    }
+    return it->second[index - 1];
+}
 
-    if (it != m_sessions.end() && it->second->actived())
+P2PMessage::Ptr Service::formatMessage(
+    P2PMessage::Ptr const& _message, P2PSession::Ptr const& _session) const
+{
+    auto formatted = _message;
+    if (m_messageCompressor && _session->session()->supports(P2PFeature::Compression))
+    {
+        uint64_t compressTime = 0;
+        auto compressed = m_messageCompressor->compress(_message, compressTime);
+        if (compressed)
+        {
+            _session->compressionMetrics().onCompressed(
+                _message->payloadRef().size(), compressed->payloadRef().size(), compressTime);
+            formatted = compressed;
+        }
+    }
+    auto version = _session->session()->protocolVersion();
+    auto compact = version >= c_compactOptionsVersion && _message->hasOptions();
+    if (formatted->version() != version || compact)
+    {
+        if (formatted == _message)
+        {
+            formatted = std::make_shared<P2PMessage>(*_message);
+        }
+        formatted->setVersion(version);
+    }
+    // the remaining time of the request is sent only to the peers able to drop the expired ones
+    if (_message->deadline() > 0 && _session->session()->supports(P2PFeature::RequestDeadline))
+    {
+        if (formatted == _message)
+        {
+            formatted = std::make_shared<P2PMessage>(*_message);
+        }
+        formatted->setExt(formatted->ext() | MessageExtFieldFlag::Deadline);
+    }
+    if (compact)
+    {
+        // the groupID and the nodeIDs known by the peer are sent by the index
+        auto encodedOptions = std::make_shared<bytes>();
+        if (formatted->options()->encodeCompact(*encodedOptions, &_session->optionsDictionary()))
+        {
+            formatted->setExt(formatted->ext() | MessageExtFieldFlag::CompactOptions);
+            formatted->setEncodedOptions(encodedOptions);
+        }
+    }
+    return formatted;
+}
+
+void Service::onHandshake(P2PSession::Ptr const& _p2pSession, bytesConstRef _payload)
+{
+    ProtocolInfo peerProtocol;
+    if (!peerProtocol.decode(_payload))
+    {
+        SERVICE_LOG(WARNING) << LOG_DESC("invalid handshake")
+                             << LOG_KV("p2pid", _p2pSession->p2pID())
+                             << LOG_KV("payloadSize", _payload.size());
+        return;
+    }
+    uint16_t version = c_legacyProtocolVersion;
+    uint32_t features = 0;
+    if (!protocolInfo().negotiate(peerProtocol, version, features))
+    {
+        SERVICE_LOG(WARNING) << LOG_DESC("disconnect the peer of the incompatible protocol")
+                             << LOG_KV("p2pid", _p2pSession->p2pID())
+                             << LOG_KV("peerMinVersion", peerProtocol.minVersion())
+                             << LOG_KV("peerMaxVersion", peerProtocol.maxVersion());
+        _p2pSession->stop(IncompatibleProtocol);
+        return;
+    }
+    _p2pSession->session()->setProtocol(version, features);
+    SERVICE_LOG(INFO) << LOG_DESC("protocol negotiated") << LOG_KV("p2pid", _p2pSession->p2pID())
+                      << LOG_KV("endpoint", _p2pSession->session()->nodeIPEndpoint())
+                      << LOG_KV("version", version) << LOG_KV("features", features)
+                      << LOG_KV("peerFeatures", peerProtocol.features());
+}
+
+void Service::connectStripes()
+{
+    if (m_connectionsPerPeer <= 1 || !m_run)
+    {
+        return;
+    }
+    std::map<NodeIPEndpoint, P2pID> staticNodes;
+    {
+        RecursiveGuard l(x_nodes);
+        staticNodes = m_staticNodes;
+    }
+    for (auto const& it : staticNodes)
+    {
+        // only the node with the smaller id opens the stripe sessions, so that the two sides
+        // never exceed connectionsPerPeer by connecting each other at the same time
+        if (it.second.empty() || it.second <= id())
+        {
+            continue;
+        }
+        auto count = sessionCount(it.second);
+        if (count == 0 || count >= m_connectionsPerPeer)
+        {
+            continue;
+        }
+        SERVICE_LOG(DEBUG) << LOG_DESC("connectStripes") << LOG_KV("endpoint", it.first)
+                           << LOG_KV("sessions", count);
+        m_host->asyncConnect(
+            it.first, std::bind(&Service::onConnect, shared_from_this(), std::placeholders::_1,
+                          std::placeholders::_2, std::placeholders::_3));
+    }
+}
+
+bool Service::isCongested(P2pID const& _nodeID) const
+{
+    auto sessions = m_sessionTable.snapshot();
+    auto primary = sessions->find(_nodeID);
+    if (!primary)
+    {
+        return false;
+    }
+    if (primary->session()->congested())
     {
         return true;
     }
-    return false;
+    // the flows striped to the congested session are rejected
+    auto it = sessions->stripeSessions.find(_nodeID);
+    if (it == sessions->stripeSessions.end())
+    {
+        return false;
+    }
+    return std::any_of(it->second.begin(), it->second.end(), [](P2PSession::Ptr const& _session) {
+        return _session->actived() && _session->session()->congested();
+    });
+}
+
+LinkQuality::Ptr Service::linkQuality(P2pID const& _nodeID) const
+{
+    auto sessions = m_sessionTable.snapshot();
+    auto primary = sessions->find(_nodeID);
+    if (!primary)
+    {
+        return nullptr;
+    }
+    std::vector<LinkQuality::Ptr> links = {primary->linkQuality()};
+    auto it = sessions->stripeSessions.find(_nodeID);
+    if (it != sessions->stripeSessions.end())
+    {
+        for (auto const& session : it->second)
+        {
+            if (session->actived())
+            {
+                links.push_back(session->linkQuality());
+            }
+        }
+    }
+    return LinkQuality::aggregate(links);
+}
+
+LinkQuality::Ptr Service::linkQuality(
+    P2pID const& _nodeID, P2PMessage::Ptr const& _message) const
+{
+    auto sessions = m_sessionTable.snapshot();
+    auto primary = sessions->find(_nodeID);
+    if (!primary)
+    {
+        return nullptr;
+    }
+    return stripeSession(*sessions, _nodeID, primary, _message)->linkQuality();
 }
 
 uint32_t Service::statusSeq()
@@ -672,8 +1153,6 @@ void Service::asyncBroadcastMessageToP2PNodes(
 void Service::asyncSendMessageByP2PNodeIDs(
     int16_t _type, const std::vector<P2pID>& _nodeIDs, bytesConstRef _payload, Options _options)
 {
-    for (auto const& nodeID : _nodeIDs)
-    {
-        asyncSendMessageByP2PNodeID(_type, nodeID, _payload, _options, nullptr);
-    }
+    auto p2pMessage = newP2PMessage(_type, _payload);
+    asyncSendMessageByNodeIDs(_nodeIDs, p2pMessage, _options);
 }
\ No newline at end of file
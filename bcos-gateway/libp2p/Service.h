@@ -12,6 +12,8 @@
 #include <bcos-gateway/Gateway.h>
 #include <bcos-gateway/libp2p/P2PInterface.h>
 #include <bcos-gateway/libp2p/P2PSession.h>
+#include <bcos-gateway/libp2p/ProtocolInfo.h>
+#include <bcos-gateway/libp2p/SessionTable.h>
 
 #include <map>
 #include <memory>
@@ -56,6 +58,8 @@ public:
         CallbackFuncWithSession callback, Options options = Options()) override;
 
     void asyncBroadcastMessage(std::shared_ptr<P2PMessage> message, Options options) override;
+    void asyncSendMessageByNodeIDs(std::vector<P2pID> const& _nodeIDs,
+        std::shared_ptr<P2PMessage> _message, Options _options = Options()) override;
 
     virtual std::map<NodeIPEndpoint, P2pID> staticNodes() { return m_staticNodes; }
     virtual void setStaticNodes(const std::set<NodeIPEndpoint>& staticNodes)
@@ -74,6 +78,10 @@ public:
         return p2pInfo;
     }
     bool isConnected(P2pID const& nodeID) const override;
+    bool isCongested(P2pID const& _nodeID) const override;
+    LinkQuality::Ptr linkQuality(P2pID const& _nodeID) const override;
+    LinkQuality::Ptr linkQuality(
+        P2pID const& _nodeID, P2PMessage::Ptr const& _message) const override;
 
     std::shared_ptr<Host> host() override { return m_host; }
     virtual void setHost(std::shared_ptr<Host> host) { m_host = host; }
@@ -104,13 +112,7 @@ public:
 
     std::shared_ptr<P2PSession> getP2PSessionByNodeId(P2pID const& _nodeID) override
     {
-        RecursiveGuard l(x_sessions);
-        auto it = m_sessions.find(_nodeID);
-        if (it != m_sessions.end())
-        {
-            return it->second;
-        }
-        return nullptr;
+        return m_sessionTable.snapshot()->find(_nodeID);
     }
 
     uint32_t statusSeq();
@@ -147,9 +149,48 @@ public:
 
     bool connected(std::string const& _nodeID) override;
 
+    uint32_t connectionsPerPeer() const { return m_connectionsPerPeer; }
+    /// the number of the parallel sessions with every peer, the messages are striped across them
+    virtual void setConnectionsPerPeer(uint32_t _connectionsPerPeer)
+    {
+        m_connectionsPerPeer = std::max<uint32_t>(_connectionsPerPeer, 1);
+    }
+    /// the number of the active sessions with the peer, including the primary session
+    size_t sessionCount(P2pID const& _nodeID) const;
+
+    /// the protocol versions and the P2PFeature supported, sent to the peers by the handshake
+    virtual ProtocolInfo protocolInfo() const
+    {
+        return ProtocolInfo(c_minProtocolVersion, c_maxProtocolVersion,
+            P2PFeature::Compression | P2PFeature::Fragmentation | P2PFeature::HeartbeatEcho |
+                P2PFeature::RequestDeadline);
+    }
+
+    MessageCompressor::Ptr messageCompressor() const { return m_messageCompressor; }
+    /// compress the large messages sent to the peers supporting compression, nullptr to disable
+    virtual void setMessageCompressor(MessageCompressor::Ptr _messageCompressor)
+    {
+        m_messageCompressor = _messageCompressor;
+    }
+
 private:
     std::shared_ptr<P2PMessage> newP2PMessage(int16_t _type, bytesConstRef _payload);
 
+    /// the session of _sessions to send the _message to the peer
+    P2PSession::Ptr stripeSession(SessionTable::Snapshot const& _sessions, P2pID const& _nodeID,
+        P2PSession::Ptr const& _primary, P2PMessage::Ptr const& _message) const;
+    /// send _message to the _sessions, the sessions of the same format share the encoded frame
+    void asyncSendMessageBySessions(std::vector<P2PSession::Ptr> const& _sessions,
+        P2PMessage::Ptr const& _message, Options const& _options);
+    /// open the stripe sessions with the peers until connectionsPerPeer reached
+    void connectStripes();
+    /// the _message in the format negotiated with the _session: the protocol version and the
+    /// payload compressed if supported, _message itself is not modified
+    P2PMessage::Ptr formatMessage(
+        P2PMessage::Ptr const& _message, P2PSession::Ptr const& _session) const;
+    /// negotiate the protocol with the handshake received from the peer
+    void onHandshake(P2PSession::Ptr const& _p2pSession, bytesConstRef _payload);
+
 private:
     std::vector<std::function<void(NetworkException, P2PSession::Ptr)>> m_disconnectionHandlers;
 
@@ -162,8 +203,14 @@ private:
 
     std::shared_ptr<Host> m_host;
 
-    std::unordered_map<P2pID, P2PSession::Ptr> m_sessions;
+    // the send path reads the snapshot of the sessions without lock
+    SessionTable m_sessionTable;
+    // serialize the writers of m_sessionTable: onConnect, onDisconnect and stop
     mutable bcos::RecursiveMutex x_sessions;
+    uint32_t m_connectionsPerPeer = 1;
+    MessageCompressor::Ptr m_messageCompressor;
+    // the requests dropped for expired before handled
+    std::atomic<uint64_t> m_expiredRequests = {0};
 
     std::shared_ptr<MessageFactory> m_messageFactory;
 
@@ -0,0 +1,111 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: the copy-on-write table of the sessions with the peers
+ * @file SessionTable.h
+ */
+#pragma once
+#include <bcos-gateway/libp2p/P2PSession.h>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace bcos
+{
+namespace gateway
+{
+/**
+ * @brief: the sessions are published as immutable snapshots(RCU), the readers take the current
+ * snapshot without lock and use it as long as they need, the writers build a new snapshot from
+ * the copy of the current one and publish it. the writers must be serialized by the caller.
+ *
+ * every thread caches a weak reference to the snapshot it read, and only reloads it after a new
+ * version published, so the readers do not contend on the lock of std::atomic_load. the cache
+ * never owns the snapshot, the replaced snapshots(and the sessions dropped from them) are
+ * released as soon as the readers using them are done, even if the thread never reads again.
+ */
+class SessionTable
+{
+public:
+    struct Snapshot
+    {
+        using Ptr = std::shared_ptr<Snapshot>;
+        using ConstPtr = std::shared_ptr<const Snapshot>;
+
+        /// the primary session of the peer, nullptr if not connected
+        P2PSession::Ptr find(P2pID const& _nodeID) const
+        {
+            auto it = sessions.find(_nodeID);
+            return it != sessions.end() ? it->second : nullptr;
+        }
+
+        std::unordered_map<P2pID, P2PSession::Ptr> sessions;
+        // the extra sessions with the peers besides sessions when connectionsPerPeer > 1
+        std::unordered_map<P2pID, std::vector<P2PSession::Ptr>> stripeSessions;
+    };
+
+    SessionTable()
+      : m_id(s_nextID.fetch_add(1, std::memory_order_relaxed)),
+        m_snapshot(std::make_shared<Snapshot>())
+    {}
+    SessionTable(SessionTable const&) = delete;
+    SessionTable& operator=(SessionTable const&) = delete;
+
+    /// the current snapshot
+    Snapshot::ConstPtr snapshot() const
+    {
+        thread_local Cache t_cache;
+        auto version = m_version.load(std::memory_order_acquire);
+        if (t_cache.tableID == m_id && t_cache.version == version)
+        {
+            // alive as long as the version is current, the table holds it
+            auto snapshot = t_cache.snapshot.lock();
+            if (snapshot)
+            {
+                return snapshot;
+            }
+        }
+        // the snapshot loaded is the version read or a newer one
+        auto snapshot = std::atomic_load(&m_snapshot);
+        t_cache.snapshot = snapshot;
+        t_cache.tableID = m_id;
+        t_cache.version = version;
+        return snapshot;
+    }
+    /// the copy of the current snapshot to be modified and published
+    Snapshot::Ptr copy() const { return std::make_shared<Snapshot>(*snapshot()); }
+    void publish(Snapshot::Ptr _snapshot)
+    {
+        std::atomic_store(&m_snapshot, Snapshot::ConstPtr(std::move(_snapshot)));
+        m_version.fetch_add(1, std::memory_order_release);
+    }
+
+private:
+    struct Cache
+    {
+        uint64_t tableID = 0;
+        uint64_t version = 0;
+        std::weak_ptr<const Snapshot> snapshot;
+    };
+    // the tables are identified by id instead of address, the address may be reused
+    static inline std::atomic<uint64_t> s_nextID = {1};
+
+    uint64_t m_id;
+    Snapshot::ConstPtr m_snapshot;
+    std::atomic<uint64_t> m_version = {0};
+};
+}  // namespace gateway
+}  // namespace bcos
@@ -0,0 +1,69 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: benchmarks of the AMOPMessage codec
+ * @file AMOPMessageBench.cpp
+ */
+#include "AllocationCounter.h"
+#include <bcos-gateway/libamop/AMOPMessage.h>
+
+using namespace bcos;
+using namespace bcos::amop;
+using namespace bcos::test;
+
+namespace
+{
+const int64_t c_minPayloadSize = 64;
+const int64_t c_maxPayloadSize = 16 * 1024 * 1024;
+}  // namespace
+
+static void AMOPMessage_Encode(benchmark::State& _state)
+{
+    bytes data(_state.range(0), 0x03);
+    auto message = std::make_shared<AMOPMessageFactory>()->buildMessage();
+    message->setType(AMOPMessage::Type::AMOPRequest);
+    message->setData(bytesConstRef(data.data(), data.size()));
+    int64_t encodedSize = 0;
+    AllocationCounter counter(_state);
+    for (auto _ : _state)
+    {
+        bytes buffer;
+        message->encode(buffer);
+        encodedSize = buffer.size();
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    counter.report(encodedSize);
+}
+
+static void AMOPMessage_Decode(benchmark::State& _state)
+{
+    bytes data(_state.range(0), 0x03);
+    auto message = std::make_shared<AMOPMessageFactory>()->buildMessage();
+    message->setType(AMOPMessage::Type::AMOPRequest);
+    message->setData(bytesConstRef(data.data(), data.size()));
+    bytes buffer;
+    message->encode(buffer);
+    auto factory = std::make_shared<AMOPMessageFactory>();
+    AllocationCounter counter(_state);
+    for (auto _ : _state)
+    {
+        auto decoded = factory->buildMessage(bytesConstRef(buffer.data(), buffer.size()));
+        benchmark::DoNotOptimize(decoded->data().data());
+    }
+    counter.report(buffer.size());
+}
+
+BENCHMARK(AMOPMessage_Encode)->RangeMultiplier(8)->Range(c_minPayloadSize, c_maxPayloadSize);
+BENCHMARK(AMOPMessage_Decode)->RangeMultiplier(8)->Range(c_minPayloadSize, c_maxPayloadSize);
@@ -0,0 +1,67 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: count the heap allocations of the benchmarks
+ * @file AllocationCounter.cpp
+ */
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+std::atomic<uint64_t> g_allocations = {0};
+}  // namespace
+
+uint64_t bcos::test::allocations()
+{
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+void* operator new(size_t _size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto p = std::malloc(_size == 0 ? 1 : _size))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t _size)
+{
+    return operator new(_size);
+}
+
+void operator delete(void* _p) noexcept
+{
+    std::free(_p);
+}
+
+void operator delete[](void* _p) noexcept
+{
+    std::free(_p);
+}
+
+void operator delete(void* _p, size_t) noexcept
+{
+    std::free(_p);
+}
+
+void operator delete[](void* _p, size_t) noexcept
+{
+    std::free(_p);
+}
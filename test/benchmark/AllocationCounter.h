@@ -0,0 +1,58 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: count the heap allocations of the benchmarks
+ * @file AllocationCounter.h
+ */
+#pragma once
+#include <benchmark/benchmark.h>
+#include <cstdint>
+
+namespace bcos
+{
+namespace test
+{
+/// the calls of operator new of the benchmark binary, the global operator new is replaced by
+/// AllocationCounter.cpp
+uint64_t allocations();
+
+/**
+ * @brief: report the allocations/op and the bytes/s of the iterations of the benchmark, created
+ * after the setup so that only the iterations are counted
+ */
+class AllocationCounter
+{
+public:
+    explicit AllocationCounter(benchmark::State& _state)
+      : m_state(_state), m_allocations(allocations())
+    {}
+
+    /// _bytesPerOp: the bytes encoded or decoded by each iteration, 0 if not processing bytes
+    void report(int64_t _bytesPerOp = 0)
+    {
+        m_state.counters["allocs/op"] = benchmark::Counter(
+            (double)(allocations() - m_allocations), benchmark::Counter::kAvgIterations);
+        if (_bytesPerOp > 0)
+        {
+            m_state.SetBytesProcessed(m_state.iterations() * _bytesPerOp);
+        }
+    }
+
+private:
+    benchmark::State& m_state;
+    uint64_t m_allocations;
+};
+}  // namespace test
+}  // namespace bcos
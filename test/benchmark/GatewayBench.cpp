@@ -0,0 +1,316 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: the throughput between two local gateways striped over connections_per_peer sessions
+ * @file GatewayBench.cpp
+ */
+#include <benchmark/benchmark.h>
+#include <bcos-gateway/GatewayFactory.h>
+#include <bcos-gateway/libp2p/Service.h>
+#include <openssl/pem.h>
+#include <openssl/x509v3.h>
+#include <boost/filesystem.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+using namespace bcos;
+using namespace bcos::gateway;
+
+namespace
+{
+// the packet type of the benchmark messages, not used by the gateway
+const int16_t c_benchPacketType = 0x7001;
+// the bytes sent by each iteration
+const size_t c_batchBytes = 64 * 1024 * 1024;
+// the bytes sent but not received yet, below the write queue watermark of the sessions
+const size_t c_windowBytes = 16 * 1024 * 1024;
+// the messages are sent by different src nodes, so they are striped across the sessions
+const size_t c_flows = 64;
+// the time to wait for the gateways to open all the sessions
+const std::chrono::seconds c_connectTimeout(30);
+const std::chrono::seconds c_receiveTimeout(30);
+
+// the file closed when released
+using FilePtr = std::unique_ptr<FILE, decltype(&fclose)>;
+
+std::shared_ptr<EVP_PKEY> generateKey()
+{
+    std::shared_ptr<EVP_PKEY_CTX> context(
+        EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr), EVP_PKEY_CTX_free);
+    EVP_PKEY* key = nullptr;
+    if (!context || EVP_PKEY_keygen_init(context.get()) <= 0 ||
+        EVP_PKEY_CTX_set_ec_paramgen_curve_nid(context.get(), NID_X9_62_prime256v1) <= 0 ||
+        EVP_PKEY_keygen(context.get(), &key) <= 0)
+    {
+        BOOST_THROW_EXCEPTION(std::runtime_error("generate the key failed"));
+    }
+    return std::shared_ptr<EVP_PKEY>(key, EVP_PKEY_free);
+}
+
+/// the certificate of _key issued by _issuer, self-signed if _issuer is nullptr
+std::shared_ptr<X509> issueCert(std::string const& _name, EVP_PKEY* _key, X509* _issuer,
+    EVP_PKEY* _issuerKey, bool _ca, long _serial)
+{
+    std::shared_ptr<X509> cert(X509_new(), X509_free);
+    X509_set_version(cert.get(), 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(cert.get()), _serial);
+    X509_gmtime_adj(X509_getm_notBefore(cert.get()), -3600);
+    X509_gmtime_adj(X509_getm_notAfter(cert.get()), 24 * 3600);
+    X509_set_pubkey(cert.get(), _key);
+    auto subject = X509_get_subject_name(cert.get());
+    X509_NAME_add_entry_by_txt(
+        subject, "CN", MBSTRING_ASC, (const unsigned char*)_name.c_str(), -1, -1, 0);
+    X509_set_issuer_name(cert.get(), _issuer ? X509_get_subject_name(_issuer) : subject);
+
+    X509V3_CTX extContext;
+    X509V3_set_ctx_nodb(&extContext);
+    X509V3_set_ctx(&extContext, _issuer ? _issuer : cert.get(), cert.get(), nullptr, nullptr, 0);
+    auto ext = X509V3_EXT_conf_nid(nullptr, &extContext, NID_basic_constraints,
+        (char*)(_ca ? "critical,CA:TRUE" : "CA:FALSE"));
+    X509_add_ext(cert.get(), ext, -1);
+    X509_EXTENSION_free(ext);
+    if (X509_sign(cert.get(), _issuerKey, EVP_sha256()) <= 0)
+    {
+        BOOST_THROW_EXCEPTION(std::runtime_error("sign the certificate failed: " + _name));
+    }
+    return cert;
+}
+
+void writeCert(boost::filesystem::path const& _path, X509* _cert)
+{
+    FilePtr file(fopen(_path.string().c_str(), "w"), fclose);
+    if (!file || !PEM_write_X509(file.get(), _cert))
+    {
+        BOOST_THROW_EXCEPTION(std::runtime_error("write failed: " + _path.string()));
+    }
+}
+
+void writeKey(boost::filesystem::path const& _path, EVP_PKEY* _key)
+{
+    FilePtr file(fopen(_path.string().c_str(), "w"), fclose);
+    if (!file || !PEM_write_PrivateKey(file.get(), _key, nullptr, nullptr, 0, nullptr, nullptr))
+    {
+        BOOST_THROW_EXCEPTION(std::runtime_error("write failed: " + _path.string()));
+    }
+}
+
+uint16_t freePort()
+{
+    ba::io_service ioService;
+    bi::tcp::acceptor acceptor(ioService, bi::tcp::endpoint(ba::ip::address_v4::loopback(), 0));
+    return acceptor.local_endpoint().port();
+}
+
+/**
+ * @brief: two gateways connected through the loopback in a temporary directory, the two node
+ * certificates are issued by a temporary ca, so the gateways have different node ids
+ */
+class GatewayPair
+{
+public:
+    explicit GatewayPair(uint32_t _connectionsPerPeer)
+      : m_path(boost::filesystem::temp_directory_path() /
+               boost::filesystem::unique_path("bcos-gateway-bench-%%%%-%%%%"))
+    {
+        boost::filesystem::create_directories(m_path);
+        auto caKey = generateKey();
+        auto caCert = issueCert("ca", caKey.get(), nullptr, caKey.get(), true, 1);
+        writeCert(m_path / "ca.crt", caCert.get());
+
+        std::vector<uint16_t> ports = {freePort(), freePort()};
+        std::string nodes = "{\"nodes\":[\"127.0.0.1:" + std::to_string(ports[0]) +
+                            "\",\"127.0.0.1:" + std::to_string(ports[1]) + "\"]}";
+        std::ofstream((m_path / "nodes.json").string()) << nodes;
+
+        GatewayFactory factory("", "");
+        for (size_t i = 0; i < 2; ++i)
+        {
+            auto name = "node" + std::to_string(i);
+            auto key = generateKey();
+            auto cert = issueCert(name, key.get(), caCert.get(), caKey.get(), false, i + 2);
+            writeCert(m_path / (name + ".crt"), cert.get());
+            writeKey(m_path / (name + ".key"), key.get());
+
+            auto configPath = m_path / (name + ".ini");
+            std::ofstream(configPath.string()) << "[p2p]\n"
+                                      << "listen_ip=127.0.0.1\n"
+                                      << "listen_port=" << ports[i] << "\n"
+                                      << "nodes_path=" << m_path.string() << "\n"
+                                      << "nodes_file=nodes.json\n"
+                                      << "connections_per_peer=" << _connectionsPerPeer << "\n"
+                                      << "[cert]\n"
+                                      << "ca_path=" << m_path.string() << "\n"
+                                      << "ca_cert=ca.crt\n"
+                                      << "node_key=" << name << ".key\n"
+                                      << "node_cert=" << name << ".crt\n";
+            auto config = std::make_shared<GatewayConfig>();
+            config->initConfig(configPath.string());
+            config->loadP2pConnectedNodes();
+            std::string nodeID;
+            factory.certPubHexHandler()((m_path / (name + ".crt")).string(), nodeID);
+            m_nodeIDs.push_back(nodeID);
+            m_gateways.push_back(factory.buildGateway(config, true));
+        }
+    }
+
+    ~GatewayPair()
+    {
+        for (auto& gateway : m_gateways)
+        {
+            gateway->stop();
+        }
+        m_gateways.clear();
+        boost::system::error_code error;
+        boost::filesystem::remove_all(m_path, error);
+    }
+
+    /// start the gateways and wait for the sessions opened, false if timeout
+    bool start(uint32_t _connectionsPerPeer)
+    {
+        for (auto& gateway : m_gateways)
+        {
+            gateway->start();
+        }
+        auto deadline = std::chrono::steady_clock::now() + c_connectTimeout;
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            if (service(0)->sessionCount(m_nodeIDs[1]) >= _connectionsPerPeer &&
+                service(1)->sessionCount(m_nodeIDs[0]) >= _connectionsPerPeer)
+            {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return false;
+    }
+
+    Service::Ptr service(size_t _index) const
+    {
+        return std::dynamic_pointer_cast<Service>(m_gateways[_index]->p2pInterface());
+    }
+    P2pID const& nodeID(size_t _index) const { return m_nodeIDs[_index]; }
+
+private:
+    boost::filesystem::path m_path;
+    std::vector<Gateway::Ptr> m_gateways;
+    std::vector<P2pID> m_nodeIDs;
+};
+}  // namespace
+
+/// send the messages from one gateway to the other over connections_per_peer sessions, the
+/// messages of c_flows flows are striped across the sessions. bytes_per_second is the payload
+/// received per second
+static void Gateway_StripedThroughput(benchmark::State& _state)
+{
+    auto connectionsPerPeer = (uint32_t)_state.range(0);
+    auto messageSize = (size_t)_state.range(1);
+    // released after the gateways calling the handler
+    std::mutex mutex;
+    std::condition_variable received;
+    std::atomic<uint64_t> receivedBytes = {0};
+    std::unique_ptr<GatewayPair> gateways;
+    try
+    {
+        gateways = std::make_unique<GatewayPair>(connectionsPerPeer);
+    }
+    catch (std::exception const& _e)
+    {
+        _state.SkipWithError(("build the gateways failed: " + std::string(_e.what())).c_str());
+        return;
+    }
+
+    gateways->service(1)->registerHandlerByMsgType(
+        c_benchPacketType, [&](NetworkException, P2PSession::Ptr, P2PMessage::Ptr _message) {
+            receivedBytes.fetch_add(_message->payloadRef().size());
+            received.notify_one();
+        });
+    if (!gateways->start(connectionsPerPeer))
+    {
+        _state.SkipWithError("connect timeout");
+        return;
+    }
+
+    auto sender = gateways->service(0);
+    auto payload = std::make_shared<bytes>(messageSize, 0x5a);
+    std::vector<std::shared_ptr<bytes>> srcNodeIDs;
+    for (size_t i = 0; i < c_flows; ++i)
+    {
+        srcNodeIDs.push_back(std::make_shared<bytes>(64, (byte)i));
+    }
+    auto dstNodeID = std::make_shared<bytes>(64, 0xff);
+    // the notification may be missed, the received bytes are checked every millisecond
+    auto waitReceived = [&](uint64_t _bytes) {
+        auto deadline = std::chrono::steady_clock::now() + c_receiveTimeout;
+        while (receivedBytes.load() < _bytes)
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+            {
+                return false;
+            }
+            std::unique_lock<std::mutex> lock(mutex);
+            received.wait_for(lock, std::chrono::milliseconds(1));
+        }
+        return true;
+    };
+    uint64_t sentBytes = 0;
+    size_t sentMessages = 0;
+    for (auto _ : _state)
+    {
+        for (size_t batch = 0; batch < c_batchBytes; batch += messageSize)
+        {
+            auto message =
+                std::static_pointer_cast<P2PMessage>(sender->messageFactory()->buildMessage());
+            message->setPacketType(c_benchPacketType);
+            message->options()->setGroupID("group0");
+            message->options()->setSrcNodeID(srcNodeIDs[sentMessages % c_flows]);
+            message->options()->dstNodeIDs().push_back(dstNodeID);
+            message->setPayload(payload);
+            sender->asyncSendMessageByNodeID(gateways->nodeID(1), message, nullptr);
+            sentBytes += messageSize;
+            sentMessages++;
+            // keep the sessions below the write queue watermark
+            waitReceived(sentBytes - std::min<uint64_t>(sentBytes, c_windowBytes));
+        }
+        if (!waitReceived(sentBytes))
+        {
+            _state.SkipWithError("receive timeout");
+            break;
+        }
+    }
+    _state.SetBytesProcessed(receivedBytes.load());
+    _state.counters["sessions"] = (double)gateways->service(0)->sessionCount(gateways->nodeID(1));
+}
+
+static void stripedArgs(benchmark::internal::Benchmark* _benchmark)
+{
+    for (int64_t connectionsPerPeer : {1, 2, 4, 8, 16})
+    {
+        for (int64_t messageSize : {16 * 1024, 1024 * 1024})
+        {
+            _benchmark->Args({connectionsPerPeer, messageSize});
+        }
+    }
+}
+
+BENCHMARK(Gateway_StripedThroughput)
+    ->ArgNames({"connections", "size"})
+    ->Apply(stripedArgs)
+    ->Iterations(4)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,45 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: the allocations of the response callbacks with and without the pool
+ * @file ObjectPoolBench.cpp
+ */
+#include "AllocationCounter.h"
+#include <bcos-gateway/libnetwork/ObjectPool.h>
+#include <bcos-gateway/libnetwork/SessionFace.h>
+
+using namespace bcos;
+using namespace bcos::gateway;
+using namespace bcos::test;
+
+/// acquire and release a response callback as Session::asyncSendMessage, the allocs/op is 0 when
+/// pooled(the control block is recycled too)
+static void ObjectPool_AcquireCallback(benchmark::State& _state)
+{
+    auto pool = ObjectPool<ResponseCallback>::create(16);
+    bool pooled = _state.range(0) != 0;
+    // warm up the pool
+    pool->acquire();
+    AllocationCounter counter(_state);
+    for (auto _ : _state)
+    {
+        auto callback = pooled ? pool->acquire() : std::make_shared<ResponseCallback>();
+        callback->m_startTime = 1;
+        benchmark::DoNotOptimize(callback.get());
+    }
+    counter.report();
+}
+
+BENCHMARK(ObjectPool_AcquireCallback)->ArgName("pooled")->DenseRange(0, 1);
@@ -0,0 +1,218 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: benchmarks of the P2PMessage codec
+ * @file P2PMessageBench.cpp
+ */
+#include "../common/FakeP2PMessage.h"
+#include "AllocationCounter.h"
+#include <bcos-gateway/libnetwork/RecvBuffer.h>
+#include <bcos-gateway/libp2p/P2PMessage.h>
+
+using namespace bcos;
+using namespace bcos::gateway;
+using namespace bcos::test;
+
+namespace
+{
+const int64_t c_minPayloadSize = 64;
+const int64_t c_maxPayloadSize = 16 * 1024 * 1024;
+// the bytes of the frames decoded by each iteration of the streaming decode
+const size_t c_streamSize = 16 * 1024 * 1024;
+// the bytes returned by one read of the socket, at most one tls record for the ssl socket
+const size_t c_readSize = 16 * 1024;
+
+// the fake message with _dstNodeIDCount dst nodes
+P2PMessage::Ptr makeMessage(size_t _payloadSize, size_t _dstNodeIDCount)
+{
+    auto message = fakeP2PMessage(_payloadSize, 1);
+    for (size_t i = 1; i < _dstNodeIDCount; ++i)
+    {
+        message->options()->dstNodeIDs().push_back(std::make_shared<bytes>(64, (byte)i));
+    }
+    return message;
+}
+
+// the factory of Session, the messages are recycled if _pooled
+MessageFactory::Ptr messageFactory(bool _pooled)
+{
+    return std::make_shared<P2PMessageFactory>(
+        _pooled ? P2PMessageFactory::c_defaultPoolCapacity : 0);
+}
+}  // namespace
+
+/// encode into the contiguous buffer
+static void P2PMessage_Encode(benchmark::State& _state)
+{
+    auto message = makeMessage(_state.range(0), 1);
+    int64_t frameSize = 0;
+    AllocationCounter counter(_state);
+    for (auto _ : _state)
+    {
+        bytes buffer;
+        message->encode(buffer);
+        frameSize = buffer.size();
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    counter.report(frameSize);
+}
+
+/// encode the header and the options only, the payload is gathered by the write
+static void P2PMessage_EncodeGather(benchmark::State& _state)
+{
+    auto message = makeMessage(_state.range(0), 1);
+    int64_t frameSize = 0;
+    AllocationCounter counter(_state);
+    for (auto _ : _state)
+    {
+        WriteBuffer frame;
+        message->encode(frame);
+        frameSize = frame.size();
+        benchmark::DoNotOptimize(frame.buffer->data());
+    }
+    counter.report(frameSize);
+}
+
+/// decode with the payload and the options copied
+static void P2PMessage_Decode(benchmark::State& _state)
+{
+    auto frame = encodeFakeP2PMessage(_state.range(0), 1);
+    auto factory = messageFactory(false);
+    AllocationCounter counter(_state);
+    for (auto _ : _state)
+    {
+        auto message = factory->buildMessage();
+        benchmark::DoNotOptimize(message->decode(bytesConstRef(frame->data(), frame->size())));
+    }
+    counter.report(frame->size());
+}
+
+/// decode referencing the received buffer, the messages are built as Session, with and without
+/// the pool
+static void P2PMessage_DecodeZeroCopy(benchmark::State& _state)
+{
+    auto frame = encodeFakeP2PMessage(_state.range(0), 1);
+    auto factory = messageFactory(_state.range(1) != 0);
+    AllocationCounter counter(_state);
+    for (auto _ : _state)
+    {
+        auto message = factory->buildMessage();
+        benchmark::DoNotOptimize(
+            message->decode(frame, bytesConstRef(frame->data(), frame->size())));
+    }
+    counter.report(frame->size());
+}
+
+/// the options with 1 to MAX_DST_NODEID_COUNT dst nodeIDs
+static void P2PMessageOptions_Encode(benchmark::State& _state)
+{
+    auto options = makeMessage(0, _state.range(0))->options();
+    int64_t optionsSize = 0;
+    AllocationCounter counter(_state);
+    for (auto _ : _state)
+    {
+        bytes buffer;
+        options->encode(buffer);
+        optionsSize = buffer.size();
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    counter.report(optionsSize);
+}
+
+static void P2PMessageOptions_Decode(benchmark::State& _state)
+{
+    bytes buffer;
+    makeMessage(0, _state.range(0))->options()->encode(buffer);
+    auto holder = std::make_shared<bytes>(buffer);
+    AllocationCounter counter(_state);
+    for (auto _ : _state)
+    {
+        P2PMessageOptions options;
+        // copy the nodeIDs if not zero-copy
+        auto result = options.decode(
+            _state.range(1) ? holder : nullptr, bytesConstRef(holder->data(), holder->size()));
+        benchmark::DoNotOptimize(result);
+    }
+    counter.report(holder->size());
+}
+
+/// decode the concatenated frames received as Session::doRead: the stream is read into the
+/// RecvBuffer of the session in socket-sized reads, and the frames reference the buffer
+static void P2PMessage_StreamDecode(benchmark::State& _state)
+{
+    auto frame = encodeFakeP2PMessage(_state.range(0), 1);
+    auto frameCount = std::max<size_t>(1, c_streamSize / frame->size());
+    auto stream = std::make_shared<bytes>();
+    stream->reserve(frameCount * frame->size());
+    for (size_t i = 0; i < frameCount; ++i)
+    {
+        stream->insert(stream->end(), frame->begin(), frame->end());
+    }
+    auto factory = messageFactory(_state.range(1) != 0);
+    RecvBuffer recvBuffer;
+    AllocationCounter counter(_state);
+    for (auto _ : _state)
+    {
+        size_t received = 0;
+        size_t decoded = 0;
+        while (received < stream->size())
+        {
+            // the socket reads into the free space of the buffer
+            auto buffer = recvBuffer.writableBuffer();
+            auto size = std::min({buffer.size(), c_readSize, stream->size() - received});
+            memcpy(buffer.data(), stream->data() + received, size);
+            recvBuffer.commit(size);
+            received += size;
+            while (true)
+            {
+                auto message = factory->buildMessage();
+                auto result = message->decode(recvBuffer.chunk(), recvBuffer.readableData());
+                if (result <= 0)
+                {
+                    break;
+                }
+                recvBuffer.consume(result);
+                decoded++;
+            }
+        }
+        if (decoded != frameCount)
+        {
+            _state.SkipWithError("decode failed");
+            break;
+        }
+    }
+    _state.counters["frames/op"] = (double)frameCount;
+    counter.report(stream->size());
+}
+
+BENCHMARK(P2PMessage_Encode)->RangeMultiplier(8)->Range(c_minPayloadSize, c_maxPayloadSize);
+BENCHMARK(P2PMessage_EncodeGather)->RangeMultiplier(8)->Range(c_minPayloadSize, c_maxPayloadSize);
+BENCHMARK(P2PMessage_Decode)->RangeMultiplier(8)->Range(c_minPayloadSize, c_maxPayloadSize);
+BENCHMARK(P2PMessage_DecodeZeroCopy)
+    ->ArgNames({"payload", "pooled"})
+    ->RangeMultiplier(8)
+    ->Ranges({{c_minPayloadSize, c_maxPayloadSize}, {0, 1}});
+BENCHMARK(P2PMessageOptions_Encode)
+    ->ArgName("dstNodeIDs")
+    ->RangeMultiplier(4)
+    ->Range(1, P2PMessageOptions::MAX_DST_NODEID_COUNT);
+BENCHMARK(P2PMessageOptions_Decode)
+    ->ArgNames({"dstNodeIDs", "zeroCopy"})
+    ->RangeMultiplier(4)
+    ->Ranges({{1, P2PMessageOptions::MAX_DST_NODEID_COUNT}, {0, 1}});
+BENCHMARK(P2PMessage_StreamDecode)
+    ->ArgNames({"payload", "pooled"})
+    ->RangeMultiplier(8)
+    ->Ranges({{c_minPayloadSize, c_maxPayloadSize}, {0, 1}});
@@ -0,0 +1,149 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: the contention of the session lookups of the senders
+ * @file SessionTableBench.cpp
+ */
+#include "AllocationCounter.h"
+#include <bcos-gateway/libp2p/SessionTable.h>
+#include <mutex>
+
+using namespace bcos;
+using namespace bcos::gateway;
+using namespace bcos::test;
+
+namespace
+{
+const size_t c_peers = 64;
+
+P2pID peerID(size_t _index)
+{
+    return std::string(128, 'a') + std::to_string(_index);
+}
+
+std::vector<P2pID> const& peerIDs()
+{
+    static std::vector<P2pID> s_peerIDs = [] {
+        std::vector<P2pID> nodeIDs;
+        for (size_t i = 0; i < c_peers; ++i)
+        {
+            nodeIDs.push_back(peerID(i));
+        }
+        return nodeIDs;
+    }();
+    return s_peerIDs;
+}
+
+// the session table guarded by the lock held by every lookup, as Service did before the snapshot
+struct LockedSessions
+{
+    LockedSessions()
+    {
+        for (auto const& nodeID : peerIDs())
+        {
+            sessions[nodeID] = std::make_shared<P2PSession>();
+        }
+    }
+    P2PSession::Ptr find(P2pID const& _nodeID) const
+    {
+        RecursiveGuard l(x_sessions);
+        auto it = sessions.find(_nodeID);
+        return it != sessions.end() ? it->second : nullptr;
+    }
+
+    std::unordered_map<P2pID, P2PSession::Ptr> sessions;
+    mutable RecursiveMutex x_sessions;
+};
+
+SessionTable& sessionTable()
+{
+    static SessionTable s_sessionTable;
+    static std::once_flag s_once;
+    std::call_once(s_once, [] {
+        auto snapshot = s_sessionTable.copy();
+        for (auto const& nodeID : peerIDs())
+        {
+            snapshot->sessions[nodeID] = std::make_shared<P2PSession>();
+        }
+        s_sessionTable.publish(snapshot);
+    });
+    return s_sessionTable;
+}
+}  // namespace
+
+/// the lookups of the senders(asyncSendMessageByNodeID, connected, isConnected) of 1 to 64 threads
+static void SessionTable_LockedLookup(benchmark::State& _state)
+{
+    static LockedSessions s_sessions;
+    auto const& nodeIDs = peerIDs();
+    size_t index = _state.thread_index();
+    for (auto _ : _state)
+    {
+        auto session = s_sessions.find(nodeIDs[index++ % nodeIDs.size()]);
+        benchmark::DoNotOptimize(session->actived());
+    }
+    _state.SetItemsProcessed(_state.iterations());
+}
+
+static void SessionTable_SnapshotLookup(benchmark::State& _state)
+{
+    auto& table = sessionTable();
+    auto const& nodeIDs = peerIDs();
+    size_t index = _state.thread_index();
+    for (auto _ : _state)
+    {
+        auto session = table.snapshot()->find(nodeIDs[index++ % nodeIDs.size()]);
+        benchmark::DoNotOptimize(session->actived());
+    }
+    _state.SetItemsProcessed(_state.iterations());
+}
+
+/// the broadcast: the whole table copied under the lock before, iterated on the snapshot now
+static void SessionTable_LockedBroadcast(benchmark::State& _state)
+{
+    static LockedSessions s_sessions;
+    for (auto _ : _state)
+    {
+        std::unordered_map<P2pID, P2PSession::Ptr> sessions;
+        {
+            RecursiveGuard l(s_sessions.x_sessions);
+            sessions = s_sessions.sessions;
+        }
+        for (auto const& it : sessions)
+        {
+            benchmark::DoNotOptimize(it.second->actived());
+        }
+    }
+    _state.SetItemsProcessed(_state.iterations() * c_peers);
+}
+
+static void SessionTable_SnapshotBroadcast(benchmark::State& _state)
+{
+    auto& table = sessionTable();
+    for (auto _ : _state)
+    {
+        auto snapshot = table.snapshot();
+        for (auto const& it : snapshot->sessions)
+        {
+            benchmark::DoNotOptimize(it.second->actived());
+        }
+    }
+    _state.SetItemsProcessed(_state.iterations() * c_peers);
+}
+
+BENCHMARK(SessionTable_LockedLookup)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(SessionTable_SnapshotLookup)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(SessionTable_LockedBroadcast)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(SessionTable_SnapshotBroadcast)->ThreadRange(1, 64)->UseRealTime();
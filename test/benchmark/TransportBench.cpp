@@ -0,0 +1,167 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief: the throughput and the cpu cost of the plaintext, ssl and sm ssl connections
+ * @file TransportBench.cpp
+ */
+#include <benchmark/benchmark.h>
+#include <bcos-gateway/GatewayFactory.h>
+#include <bcos-gateway/libnetwork/Socket.h>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <thread>
+
+using namespace bcos;
+using namespace bcos::gateway;
+
+namespace
+{
+enum Transport : int64_t
+{
+    PlaintextTransport = 0,
+    SSLTransport = 1,
+    SMSSLTransport = 2,
+};
+
+// the certificates of the unit tests, set by CMakeLists.txt
+const std::string c_dataPath = BCOS_GATEWAY_BENCH_DATA_PATH;
+
+// the context of the gateway, the plaintext connection still needs one to create the socket
+std::shared_ptr<ba::ssl::context> sslContext(int64_t _transport)
+{
+    GatewayFactory factory("", "");
+    if (_transport == SMSSLTransport)
+    {
+        GatewayConfig::SMCertConfig config;
+        config.caCert = c_dataPath + "sm_ca/sm_ca.crt";
+        config.nodeCert = c_dataPath + "sm_ca/sm_node.crt";
+        config.nodeKey = c_dataPath + "sm_ca/sm_node.key";
+        config.enNodeCert = c_dataPath + "sm_ca/sm_ennode.crt";
+        config.enNodeKey = c_dataPath + "sm_ca/sm_ennode.key";
+        return factory.buildSSLContext(config);
+    }
+    GatewayConfig::CertConfig config;
+    config.caCert = c_dataPath + "ca/ca.crt";
+    config.nodeCert = c_dataPath + "ca/node.crt";
+    config.nodeKey = c_dataPath + "ca/node.key";
+    return factory.buildSSLContext(config);
+}
+}  // namespace
+
+/// write the messages through a loopback connection of the transport, the peer reads and decrypts
+/// them in its own thread. bytes_per_second is the throughput of the connection, cpu_ns/B is the
+/// cpu time of both ends(the process cpu time) per byte
+static void Transport_Write(benchmark::State& _state)
+{
+    auto transport = _state.range(0);
+    auto messageSize = (size_t)_state.range(1);
+    std::shared_ptr<ba::ssl::context> context;
+    try
+    {
+        context = sslContext(transport);
+    }
+    catch (std::exception const& _e)
+    {
+        _state.SkipWithError(("build the ssl context failed: " + std::string(_e.what())).c_str());
+        return;
+    }
+    ba::io_service ioService;
+    bi::tcp::acceptor acceptor(ioService, bi::tcp::endpoint(ba::ip::address_v4::loopback(), 0));
+    auto endpoint = acceptor.local_endpoint();
+
+    // the connection is accepted by the peer thread from the backlog
+    auto socket = std::make_shared<Socket>(ioService, *context, NodeIPEndpoint());
+    socket->setPlaintext(transport == PlaintextTransport);
+    boost::system::error_code error;
+    socket->ref().connect(endpoint, error);
+    if (error)
+    {
+        _state.SkipWithError(("connect failed: " + error.message()).c_str());
+        return;
+    }
+
+    // the peer drains the connection until it is closed
+    std::atomic<uint64_t> received = {0};
+    std::thread reader([&]() {
+        ba::ssl::stream<bi::tcp::socket> peer(ioService, *context);
+        boost::system::error_code error;
+        acceptor.accept(peer.next_layer(), error);
+        if (!error && transport != PlaintextTransport)
+        {
+            peer.handshake(ba::ssl::stream_base::server, error);
+        }
+        bytes buffer(64 * 1024);
+        while (!error)
+        {
+            auto size = (transport == PlaintextTransport) ?
+                            peer.next_layer().read_some(ba::buffer(buffer), error) :
+                            peer.read_some(ba::buffer(buffer), error);
+            received.fetch_add(size, std::memory_order_relaxed);
+        }
+    });
+
+    if (transport != PlaintextTransport)
+    {
+        socket->sslref().handshake(ba::ssl::stream_base::client, error);
+    }
+    if (error)
+    {
+        _state.SkipWithError(("handshake failed: " + error.message()).c_str());
+        socket->close();
+        reader.join();
+        return;
+    }
+
+    bytes message(messageSize, 0x5a);
+    uint64_t sent = 0;
+    auto cpuStart = std::clock();
+    for (auto _ : _state)
+    {
+        auto size = (transport == PlaintextTransport) ?
+                        ba::write(socket->ref(), ba::buffer(message), error) :
+                        ba::write(socket->sslref(), ba::buffer(message), error);
+        if (error)
+        {
+            _state.SkipWithError(("write failed: " + error.message()).c_str());
+            break;
+        }
+        sent += size;
+    }
+    // the bytes in flight are received and decrypted before the cpu time counted
+    while (!error && received.load(std::memory_order_relaxed) < sent)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    auto cpuTime = (double)(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    socket->close();
+    reader.join();
+
+    _state.SetBytesProcessed(sent);
+    _state.counters["cpu_ns/B"] = sent > 0 ? cpuTime * 1e9 / sent : 0;
+}
+
+static void transportArgs(benchmark::internal::Benchmark* _benchmark)
+{
+    for (auto transport : {PlaintextTransport, SSLTransport, SMSSLTransport})
+    {
+        for (int64_t size : {1024, 16 * 1024, 256 * 1024, 1024 * 1024})
+        {
+            _benchmark->Args({transport, size});
+        }
+    }
+}
+
+BENCHMARK(Transport_Write)->ArgNames({"transport", "size"})->Apply(transportArgs)->UseRealTime();
@@ -0,0 +1,63 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief the P2PMessage shared by the tests and the benchmarks
+ * @file FakeP2PMessage.h
+ */
+#pragma once
+
+#include <bcos-gateway/libp2p/P2PMessage.h>
+
+namespace bcos
+{
+namespace test
+{
+/// the payload of the fake message, the byte i is (i * 7 + _seq), so the payloads of the
+/// different seqs are told apart
+inline std::shared_ptr<bytes> fakePayload(size_t _payloadSize, uint32_t _seq)
+{
+    auto payload = std::make_shared<bytes>(_payloadSize);
+    for (size_t i = 0; i < _payloadSize; ++i)
+    {
+        (*payload)[i] = (byte)(i * 7 + _seq);
+    }
+    return payload;
+}
+
+/// the PeerToPeerMessage of group0 from the node of 64 bytes 0x01 to the node of 64 bytes 0x02
+inline gateway::P2PMessage::Ptr fakeP2PMessage(size_t _payloadSize, uint32_t _seq,
+    uint16_t _version = gateway::c_legacyProtocolVersion)
+{
+    auto message = std::make_shared<gateway::P2PMessage>();
+    message->setPacketType(gateway::MessageType::PeerToPeerMessage);
+    message->setVersion(_version);
+    message->setSeq(_seq);
+    message->options()->setGroupID("group0");
+    message->options()->setSrcNodeID(std::make_shared<bytes>(64, 0x01));
+    message->options()->dstNodeIDs().push_back(std::make_shared<bytes>(64, 0x02));
+    message->setPayload(fakePayload(_payloadSize, _seq));
+    return message;
+}
+
+/// the frame of fakeP2PMessage
+inline std::shared_ptr<bytes> encodeFakeP2PMessage(size_t _payloadSize, uint32_t _seq,
+    uint16_t _version = gateway::c_legacyProtocolVersion)
+{
+    auto buffer = std::make_shared<bytes>();
+    fakeP2PMessage(_payloadSize, _seq, _version)->encode(*buffer);
+    return buffer;
+}
+}  // namespace test
+}  // namespace bcos
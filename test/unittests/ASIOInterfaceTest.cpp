@@ -0,0 +1,186 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief test for the gather-write of the ASIOInterface
+ * @file ASIOInterfaceTest.cpp
+ */
+
+#include <bcos-framework/testutils/TestPromptFixture.h>
+#include <bcos-gateway/libnetwork/ASIOInterface.h>
+#include <boost/test/unit_test.hpp>
+#include <future>
+#include <thread>
+
+using namespace bcos;
+using namespace bcos::gateway;
+using namespace bcos::test;
+
+namespace
+{
+const std::string c_caPath = "../test/unittests/data/ca/";
+
+// the buffers of the sizes, every buffer filled with its own index
+std::vector<std::shared_ptr<bytes>> makeBuffers(std::vector<size_t> const& _sizes)
+{
+    std::vector<std::shared_ptr<bytes>> buffers;
+    for (size_t i = 0; i < _sizes.size(); ++i)
+    {
+        buffers.push_back(std::make_shared<bytes>(_sizes[i], (byte)(i + 1)));
+    }
+    return buffers;
+}
+
+std::vector<ba::const_buffer> constBuffers(std::vector<std::shared_ptr<bytes>> const& _buffers)
+{
+    std::vector<ba::const_buffer> constBuffers;
+    for (auto const& buffer : _buffers)
+    {
+        constBuffers.push_back(ba::buffer(*buffer));
+    }
+    return constBuffers;
+}
+
+bytes concat(std::vector<ba::const_buffer> const& _buffers)
+{
+    bytes data;
+    for (auto const& buffer : _buffers)
+    {
+        auto begin = static_cast<const byte*>(buffer.data());
+        data.insert(data.end(), begin, begin + buffer.size());
+    }
+    return data;
+}
+
+// small messages, a frame just below the tls record, a large frame and a burst of small ones
+const std::vector<size_t> c_mixedSizes = {100, 200, 20000, 300, 5000, 15900, 50, 3000, 3000,
+    3000, 3000, 3000, 3000, 1, 4095, 4096, 1024 * 1024, 7};
+
+std::shared_ptr<ba::ssl::context> sslContext()
+{
+    auto context = std::make_shared<ba::ssl::context>(ba::ssl::context::tlsv12);
+    context->use_certificate_chain_file(c_caPath + "node.crt");
+    context->use_private_key_file(c_caPath + "node.key", ba::ssl::context::pem);
+    context->set_verify_mode(ba::ssl::verify_none);
+    return context;
+}
+
+// write the buffers by ASIOInterface::asyncWrite through a loopback connection of _type, return
+// the bytes received by the peer
+bytes writeThroughLoopback(int _type, std::vector<ba::const_buffer> const& _buffers)
+{
+    auto ioService = std::make_shared<ba::io_service>();
+    auto context = sslContext();
+    auto asioInterface = std::make_shared<ASIOInterface>();
+    asioInterface->setIOService(ioService);
+    asioInterface->setSSLContext(context);
+    asioInterface->setType(ASIOInterface::SSL);
+
+    bi::tcp::acceptor acceptor(*ioService, bi::tcp::endpoint(ba::ip::address_v4::loopback(), 0));
+    auto port = acceptor.local_endpoint().port();
+    auto total = concat(_buffers).size();
+
+    // the peer accepts and reads synchronously in its own io_service
+    auto received = std::async(std::launch::async, [&acceptor, context, _type, total]() {
+        ba::io_service peerService;
+        ba::ssl::stream<bi::tcp::socket> peer(peerService, *context);
+        acceptor.accept(peer.next_layer());
+        bytes data(total);
+        if (_type == ASIOInterface::SSL)
+        {
+            peer.handshake(ba::ssl::stream_base::server);
+            ba::read(peer, ba::buffer(data));
+        }
+        else
+        {
+            ba::read(peer.next_layer(), ba::buffer(data));
+        }
+        return data;
+    });
+
+    auto socket = std::make_shared<Socket>(*ioService, *context, NodeIPEndpoint());
+    socket->setPlaintext(_type == ASIOInterface::TCP_ONLY);
+    socket->ref().connect(bi::tcp::endpoint(ba::ip::address_v4::loopback(), port));
+    if (_type == ASIOInterface::SSL)
+    {
+        socket->sslref().handshake(ba::ssl::stream_base::client);
+    }
+
+    std::promise<std::pair<boost::system::error_code, size_t>> written;
+    asioInterface->asyncWrite(
+        socket, _buffers, [&written](const boost::system::error_code _error, std::size_t _size) {
+            written.set_value(std::make_pair(_error, _size));
+        });
+    std::thread ioThread([ioService]() { ioService->run(); });
+    auto result = written.get_future().get();
+    BOOST_CHECK(!result.first);
+    auto data = received.get();
+    socket->close();
+    ioService->stop();
+    ioThread.join();
+    return data;
+}
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE(ASIOInterfaceTest, TestPromptFixture)
+
+BOOST_AUTO_TEST_CASE(test_writeBuffers)
+{
+    auto buffers = makeBuffers(c_mixedSizes);
+    auto input = constBuffers(buffers);
+
+    // the plaintext socket writes the buffers as is
+    std::vector<std::shared_ptr<bytes>> packed;
+    auto tcpBuffers = ASIOInterface::writeBuffers(ASIOInterface::TCP_ONLY, input, packed);
+    BOOST_CHECK(packed.empty());
+    BOOST_CHECK_EQUAL(tcpBuffers.size(), input.size());
+
+    auto sslBuffers = ASIOInterface::writeBuffers(ASIOInterface::SSL, input, packed);
+    BOOST_CHECK(concat(sslBuffers) == concat(input));
+    BOOST_CHECK(!packed.empty());
+    BOOST_CHECK(sslBuffers.size() < input.size());
+    for (auto const& buffer : packed)
+    {
+        BOOST_CHECK(buffer->size() <= ASIOInterface::c_maxTLSRecordSize);
+    }
+    // the buffers not small are referenced without copy
+    for (auto const& buffer : buffers)
+    {
+        if (buffer->size() < ASIOInterface::c_packThreshold)
+        {
+            continue;
+        }
+        auto it = std::find_if(sslBuffers.begin(), sslBuffers.end(), [&buffer](auto const& _b) {
+            return _b.data() == buffer->data() && _b.size() == buffer->size();
+        });
+        BOOST_CHECK(it != sslBuffers.end());
+    }
+    // the six 3000 bytes buffers are packed into two records at most
+    BOOST_CHECK(sslBuffers.size() <= input.size() - 6);
+}
+
+BOOST_AUTO_TEST_CASE(test_asyncWrite)
+{
+    auto buffers = makeBuffers(c_mixedSizes);
+    auto input = constBuffers(buffers);
+    auto expected = concat(input);
+    for (auto type : {ASIOInterface::TCP_ONLY, ASIOInterface::SSL})
+    {
+        auto received = writeThroughLoopback(type, input);
+        BOOST_CHECK_EQUAL(received.size(), expected.size());
+        BOOST_CHECK(received == expected);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,90 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief test for the DispatchLanes
+ * @file DispatchLanesTest.cpp
+ */
+
+#include <bcos-framework/testutils/TestPromptFixture.h>
+#include <bcos-gateway/libnetwork/Common.h>
+#include <bcos-gateway/libnetwork/DispatchLanes.h>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+
+using namespace bcos;
+using namespace bcos::gateway;
+using namespace bcos::test;
+
+BOOST_FIXTURE_TEST_SUITE(DispatchLanesTest, TestPromptFixture)
+
+BOOST_AUTO_TEST_CASE(test_classify)
+{
+    BOOST_CHECK(DispatchLanes::classify(MessageType::Handshake) == DispatchLane::Control);
+    BOOST_CHECK(DispatchLanes::classify(MessageType::Heartbeat) == DispatchLane::Control);
+    BOOST_CHECK(DispatchLanes::classify(MessageType::RequestNodeIDs) == DispatchLane::Control);
+    BOOST_CHECK(DispatchLanes::classify(MessageType::ResponseNodeIDs) == DispatchLane::Control);
+    BOOST_CHECK(DispatchLanes::classify(MessageType::PeerToPeerMessage) == DispatchLane::P2P);
+    BOOST_CHECK(
+        DispatchLanes::classify(MessageType::BroadcastMessage) == DispatchLane::Broadcast);
+    BOOST_CHECK(DispatchLanes::classify(MessageType::AMOPMessageType) == DispatchLane::AMOP);
+    BOOST_CHECK(DispatchLanes::classify(0x7fff) == DispatchLane::P2P);
+
+    for (size_t i = 0; i < DispatchLanes::c_laneCount; ++i)
+    {
+        BOOST_CHECK(DispatchLanes::lane(DispatchLanes::name((DispatchLane)i)) == (DispatchLane)i);
+    }
+    BOOST_CHECK(DispatchLanes::lane("consensus") == DispatchLane::Count);
+}
+
+BOOST_AUTO_TEST_CASE(test_lanes)
+{
+    auto config = DispatchLanes::defaultConfig();
+    config[(size_t)DispatchLane::AMOP].threads = 0;
+    config[(size_t)DispatchLane::P2P].threads = 1;
+    DispatchLanes lanes(config);
+    BOOST_CHECK(!lanes.executor(DispatchLane::AMOP));
+    BOOST_CHECK_EQUAL(lanes.executor(DispatchLane::Control)->threadNum(), 2);
+    BOOST_CHECK_EQUAL(lanes.queueLimit(DispatchLane::P2P), 100000);
+    lanes.start();
+
+    // the control message is not delayed by the data message blocking its lane
+    std::atomic_bool blocked = {true};
+    std::atomic_bool controlExecuted = {false};
+    auto dataQueue = lanes.executor(DispatchLane::P2P)->newQueue();
+    auto controlQueue = lanes.executor(DispatchLane::Control)->newQueue();
+    dataQueue->post([&]() {
+        while (blocked)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    controlQueue->post([&]() { controlExecuted = true; });
+    for (size_t i = 0; i < 1000 && !controlExecuted; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    BOOST_CHECK(controlExecuted);
+    blocked = false;
+
+    lanes.onDropped(DispatchLane::Broadcast);
+    BOOST_CHECK_EQUAL(lanes.dropped(DispatchLane::Broadcast), 1);
+    auto metrics = lanes.toString();
+    BOOST_CHECK(metrics.find("broadcast:{threads:4") != std::string::npos);
+    BOOST_CHECK(metrics.find("dropped:1") != std::string::npos);
+    BOOST_CHECK(metrics.find("amop:{threadPool,dropped:0}") != std::string::npos);
+    lanes.stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
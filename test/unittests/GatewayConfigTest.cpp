@@ -117,6 +117,24 @@ BOOST_AUTO_TEST_CASE(test_nodesJsonParser)
     }
 }
 
+BOOST_AUTO_TEST_CASE(test_dispatchLanesParser)
+{
+    auto config = std::make_shared<GatewayConfig>();
+    auto lanes = DispatchLanes::defaultConfig();
+    config->parseDispatchLanes(" broadcast:8:500 ,,control : 3 : 0", lanes);
+    BOOST_CHECK_EQUAL(lanes[(size_t)DispatchLane::Broadcast].threads, 8);
+    BOOST_CHECK_EQUAL(lanes[(size_t)DispatchLane::Broadcast].queueLimit, 500);
+    BOOST_CHECK_EQUAL(lanes[(size_t)DispatchLane::Control].threads, 3);
+    BOOST_CHECK_EQUAL(lanes[(size_t)DispatchLane::AMOP].threads, 4);
+
+    // unknown lane, missing field, negative or too many threads
+    BOOST_CHECK_THROW(config->parseDispatchLanes("consensus:1:0", lanes), InvalidParameter);
+    BOOST_CHECK_THROW(config->parseDispatchLanes("p2p:1", lanes), InvalidParameter);
+    BOOST_CHECK_THROW(config->parseDispatchLanes("p2p:-1:0", lanes), InvalidParameter);
+    BOOST_CHECK_THROW(config->parseDispatchLanes("p2p:1000:0", lanes), InvalidParameter);
+    BOOST_CHECK_THROW(config->parseDispatchLanes("p2p:x:0", lanes), InvalidParameter);
+}
+
 BOOST_AUTO_TEST_CASE(test_initConfig)
 {
     {
@@ -129,6 +147,29 @@ BOOST_AUTO_TEST_CASE(test_initConfig)
         BOOST_CHECK_EQUAL(config->listenPort(), 12345);
         BOOST_CHECK_EQUAL(config->smSSL(), false);
         BOOST_CHECK_EQUAL(config->connectedNodes().size(), 3);
+        BOOST_CHECK_EQUAL(config->ioThreadCount(), 4);
+        BOOST_CHECK_EQUAL(config->writeQueueWatermark().highBytes, 16 * 1024 * 1024);
+        BOOST_CHECK_EQUAL(config->writeQueueWatermark().lowBytes, 8 * 1024 * 1024);
+        BOOST_CHECK_EQUAL(config->writeQueueWatermark().highMessages, 1000);
+        BOOST_CHECK_EQUAL(config->writeQueueWatermark().lowMessages, 500);
+        BOOST_CHECK_EQUAL(config->sslSessionCacheSize(), 128);
+        BOOST_CHECK_EQUAL(config->plaintextNetworks().size(), 3);
+        BOOST_CHECK_EQUAL(config->plaintextNetworks()[1], "192.168.1.10");
+        BOOST_CHECK_EQUAL(config->connectionsPerPeer(), 4);
+        BOOST_CHECK_EQUAL(config->fragmentConfig().fragmentSize, 64 * 1024);
+        BOOST_CHECK_EQUAL(config->fragmentConfig().maxReassemblyBytes, 128 * 1024 * 1024);
+        BOOST_CHECK(config->compression());
+        BOOST_CHECK_EQUAL(config->compressThreshold(), 4 * 1024);
+        BOOST_CHECK_EQUAL(config->compressLevel(), 1);
+        BOOST_CHECK_EQUAL(config->unicastTimeout(), 3000);
+        BOOST_CHECK(config->hedgeRequests());
+        auto const& lanes = config->dispatchLanes();
+        BOOST_CHECK_EQUAL(lanes[(size_t)DispatchLane::Control].threads, 1);
+        BOOST_CHECK_EQUAL(lanes[(size_t)DispatchLane::Control].queueLimit, 0);
+        BOOST_CHECK_EQUAL(lanes[(size_t)DispatchLane::AMOP].threads, 0);
+        // not configured
+        BOOST_CHECK_EQUAL(lanes[(size_t)DispatchLane::P2P].threads, 16);
+        BOOST_CHECK_EQUAL(lanes[(size_t)DispatchLane::P2P].queueLimit, 100000);
 
         auto certConfig = config->certConfig();
         BOOST_CHECK(!certConfig.caCert.empty());
@@ -150,6 +191,7 @@ BOOST_AUTO_TEST_CASE(test_initSMConfig)
         BOOST_CHECK_EQUAL(config->listenPort(), 54321);
         BOOST_CHECK_EQUAL(config->smSSL(), true);
         BOOST_CHECK_EQUAL(config->connectedNodes().size(), 1);
+        BOOST_CHECK(config->ioThreadCount() >= 1);
 
         auto smCertConfig = config->smCertConfig();
         BOOST_CHECK(!smCertConfig.caCert.empty());
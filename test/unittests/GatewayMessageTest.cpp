@@ -305,4 +305,154 @@ BOOST_AUTO_TEST_CASE(test_P2PMessage_codec)
     }
 }
 
+BOOST_AUTO_TEST_CASE(test_P2PMessage_deadline)
+{
+    auto factory = std::make_shared<P2PMessageFactory>();
+    auto encodeMsg = std::static_pointer_cast<P2PMessage>(factory->buildMessage());
+    encodeMsg->setSeq(0x12345678);
+    encodeMsg->setPacketType(MessageType::PeerToPeerMessage);
+    encodeMsg->setPayload(std::make_shared<bytes>(100, 'a'));
+    std::string nodeID = "nodeID";
+    encodeMsg->options()->setGroupID("group");
+    encodeMsg->options()->setSrcNodeID(std::make_shared<bytes>(nodeID.begin(), nodeID.end()));
+    encodeMsg->options()->dstNodeIDs().push_back(
+        std::make_shared<bytes>(nodeID.begin(), nodeID.end()));
+    encodeMsg->setDeadline(utcSteadyTime() + 5000);
+
+    // the deadline is not sent without the flag
+    bytes buffer;
+    BOOST_CHECK(encodeMsg->encode(buffer));
+    auto decodeMsg = std::static_pointer_cast<P2PMessage>(factory->buildMessage());
+    BOOST_CHECK_EQUAL(
+        decodeMsg->decode(bytesConstRef(buffer.data(), buffer.size())), buffer.size());
+    BOOST_CHECK_EQUAL(decodeMsg->deadline(), 0);
+    BOOST_CHECK(!decodeMsg->expired(utcSteadyTime()));
+
+    // the remaining time is restored by the clock of the receiver
+    auto size = buffer.size();
+    encodeMsg->setExt(MessageExtFieldFlag::Deadline);
+    BOOST_CHECK(encodeMsg->encode(buffer));
+    BOOST_CHECK_EQUAL(buffer.size(), size + P2PMessage::DEADLINE_LENGTH);
+    decodeMsg = std::static_pointer_cast<P2PMessage>(factory->buildMessage());
+    BOOST_CHECK_EQUAL(
+        decodeMsg->decode(bytesConstRef(buffer.data(), buffer.size())), buffer.size());
+    auto now = utcSteadyTime();
+    BOOST_CHECK(decodeMsg->deadline() > now + 4000 && decodeMsg->deadline() <= now + 5000);
+    BOOST_CHECK(!decodeMsg->expired(now));
+    BOOST_CHECK(decodeMsg->expired(now + 5000));
+    BOOST_CHECK_EQUAL(decodeMsg->options()->groupID(), "group");
+    BOOST_CHECK_EQUAL(decodeMsg->payloadRef().size(), 100);
+
+    // expired before sent
+    encodeMsg->setDeadline(utcSteadyTime() - 1);
+    BOOST_CHECK(encodeMsg->encode(buffer));
+    decodeMsg = std::static_pointer_cast<P2PMessage>(factory->buildMessage());
+    decodeMsg->decode(bytesConstRef(buffer.data(), buffer.size()));
+    BOOST_CHECK(decodeMsg->expired(utcSteadyTime()));
+
+    // only the messages with options carry the deadline
+    auto heartbeat = std::static_pointer_cast<P2PMessage>(factory->buildMessage());
+    heartbeat->setExt(MessageExtFieldFlag::Deadline);
+    heartbeat->setPacketType(MessageType::Heartbeat);
+    heartbeat->setDeadline(utcSteadyTime() + 5000);
+    BOOST_CHECK(heartbeat->encode(buffer));
+    BOOST_CHECK_EQUAL(buffer.size(), size_t(P2PMessage::MESSAGE_HEADER_LENGTH));
+
+    // the deadline field is truncated
+    BOOST_CHECK(encodeMsg->encode(buffer));
+    buffer[0] = buffer[1] = buffer[2] = 0;
+    buffer[3] = P2PMessage::MESSAGE_HEADER_LENGTH + 2;
+    decodeMsg = std::static_pointer_cast<P2PMessage>(factory->buildMessage());
+    BOOST_CHECK_EQUAL(decodeMsg->decode(bytesConstRef(buffer.data(), buffer.size())),
+        MessageDecodeStatus::MESSAGE_ERROR);
+
+    // the deadline is cleared when the message is recycled
+    encodeMsg->reset();
+    BOOST_CHECK_EQUAL(encodeMsg->deadline(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_P2PMessage_decodeWithoutCopy)
+{
+    auto factory = std::make_shared<P2PMessageFactory>();
+    auto encodeMsg = std::static_pointer_cast<P2PMessage>(factory->buildMessage());
+    auto payload = std::make_shared<bytes>(10000, 'a');
+    encodeMsg->setSeq(0x12345678);
+    encodeMsg->setPacketType(MessageType::PeerToPeerMessage);
+    encodeMsg->setPayload(payload);
+
+    std::string srcNodeID = "srcNodeID";
+    std::string dstNodeID = "dstNodeID";
+    auto options = std::make_shared<P2PMessageOptions>();
+    options->setGroupID("group");
+    options->setSrcNodeID(std::make_shared<bytes>(srcNodeID.begin(), srcNodeID.end()));
+    options->dstNodeIDs().push_back(std::make_shared<bytes>(dstNodeID.begin(), dstNodeID.end()));
+    encodeMsg->setOptions(options);
+
+    auto buffer = std::make_shared<bytes>();
+    BOOST_CHECK(encodeMsg->encode(*buffer.get()));
+
+    auto decodeMsg = std::static_pointer_cast<P2PMessage>(factory->buildMessage());
+    auto ret = decodeMsg->decode(buffer, bytesConstRef(buffer->data(), buffer->size()));
+    BOOST_CHECK_EQUAL(ret, buffer->size());
+    // the decoded message holds the buffer
+    BOOST_CHECK(buffer.use_count() > 1);
+
+    // the payload and the nodeIDs reference the buffer
+    auto payloadRef = decodeMsg->payloadRef();
+    BOOST_CHECK_EQUAL(payloadRef.size(), payload->size());
+    BOOST_CHECK(payloadRef.data() >= buffer->data());
+    BOOST_CHECK(payloadRef.data() + payloadRef.size() <= buffer->data() + buffer->size());
+    BOOST_CHECK(*decodeMsg->payload() == *payload);
+
+    auto decodeOptions = decodeMsg->options();
+    BOOST_CHECK_EQUAL(decodeOptions->groupID(), "group");
+    BOOST_CHECK_EQUAL(decodeOptions->srcNodeIDRef().toString(), srcNodeID);
+    BOOST_CHECK_EQUAL(decodeOptions->dstNodeIDCount(), 1);
+    BOOST_CHECK_EQUAL(decodeOptions->dstNodeIDRef(0).toString(), dstNodeID);
+    auto srcNodeIDRef = decodeOptions->srcNodeIDRef();
+    BOOST_CHECK(srcNodeIDRef.data() >= buffer->data() &&
+                srcNodeIDRef.data() < buffer->data() + buffer->size());
+
+    // modify the options copies the nodeIDs
+    auto& dstNodeIDs = decodeOptions->dstNodeIDs();
+    BOOST_CHECK_EQUAL(dstNodeIDs.size(), 1);
+    BOOST_CHECK_EQUAL(std::string(dstNodeIDs[0]->begin(), dstNodeIDs[0]->end()), dstNodeID);
+    BOOST_CHECK_EQUAL(decodeOptions->srcNodeIDRef().toString(), srcNodeID);
+
+    // the buffer is released with the message
+    decodeMsg.reset();
+    BOOST_CHECK_EQUAL(buffer.use_count(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_EncodedMessage)
+{
+    auto factory = std::make_shared<P2PMessageFactory>();
+    auto message = std::static_pointer_cast<P2PMessage>(factory->buildMessage());
+    message->setPacketType(MessageType::BroadcastMessage);
+    message->setSeq(factory->newSeq());
+    message->options()->setGroupID("group");
+    message->options()->setSrcNodeID(std::make_shared<bytes>(64, 'a'));
+    message->setPayload(std::make_shared<bytes>(1024, 'b'));
+
+    auto encodedMessage = EncodedMessage::encode(message);
+    BOOST_CHECK(encodedMessage);
+    BOOST_CHECK(encodedMessage->message() == message);
+
+    bytes buffer;
+    message->encode(buffer);
+    BOOST_CHECK(encodedMessage->frame().toBytes() == buffer);
+    BOOST_CHECK_EQUAL(encodedMessage->size(), buffer.size());
+    // the payload is referenced without copy
+    BOOST_CHECK(encodedMessage->frame().payload.data() == message->payloadRef().data());
+    BOOST_CHECK_EQUAL(encodedMessage->frame().buffer->size(), buffer.size() - 1024);
+
+    // the encoded frame is referenced by the write queues without copy
+    std::vector<WriteBuffer> writeQueues(30, encodedMessage->frame());
+    BOOST_CHECK_EQUAL(encodedMessage->frame().buffer.use_count(), 31);
+
+    // the message without options can not be encoded
+    message->options()->setSrcNodeID(std::make_shared<bytes>());
+    BOOST_CHECK(!EncodedMessage::encode(message));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,90 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief test for the idle sweeper
+ * @file IdleSweeperTest.cpp
+ */
+
+#include <bcos-framework/testutils/TestPromptFixture.h>
+#include <bcos-gateway/libnetwork/IdleSweeper.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace bcos;
+using namespace bcos::gateway;
+using namespace bcos::test;
+
+namespace
+{
+class FakeConnection : public IdleCheckable
+{
+public:
+    explicit FakeConnection(uint64_t _idleTime) : idleTime(_idleTime) {}
+    bool checkIdle(uint64_t _now) override
+    {
+        if (closed)
+        {
+            return false;
+        }
+        if (_now > lastIOTime + idleTime)
+        {
+            closed = true;
+            return false;
+        }
+        return true;
+    }
+    uint64_t idleTime;
+    uint64_t lastIOTime = utcSteadyTime();
+    bool closed = false;
+};
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE(IdleSweeperTest, TestPromptFixture)
+
+BOOST_AUTO_TEST_CASE(test_sweep)
+{
+    auto ioService = std::make_shared<boost::asio::io_service>();
+    auto sweeper = std::make_shared<IdleSweeper>(ioService);
+    auto now = utcSteadyTime();
+    auto activeConnection = std::make_shared<FakeConnection>(1000);
+    auto idleConnection = std::make_shared<FakeConnection>(1000);
+    auto releasedConnection = std::make_shared<FakeConnection>(1000);
+    sweeper->add(activeConnection);
+    sweeper->add(idleConnection);
+    sweeper->add(releasedConnection);
+    releasedConnection.reset();
+    BOOST_CHECK_EQUAL(sweeper->size(), 3);
+
+    // the released connection is removed
+    BOOST_CHECK_EQUAL(sweeper->sweep(now + 500), 2);
+
+    activeConnection->lastIOTime = now + 1000;
+    BOOST_CHECK_EQUAL(sweeper->sweep(now + 1500), 1);
+    BOOST_CHECK(!activeConnection->closed);
+    BOOST_CHECK(idleConnection->closed);
+}
+
+BOOST_AUTO_TEST_CASE(test_timer)
+{
+    auto ioService = std::make_shared<boost::asio::io_service>();
+    auto sweeper = std::make_shared<IdleSweeper>(ioService, 10);
+    auto connection = std::make_shared<FakeConnection>(30);
+    sweeper->add(connection);
+    // the timer stops after the only connection closed, so the io_service returns
+    ioService->run();
+    BOOST_CHECK(connection->closed);
+    BOOST_CHECK_EQUAL(sweeper->size(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,187 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief test for the LinkQuality
+ * @file LinkQualityTest.cpp
+ */
+
+#include <bcos-framework/testutils/TestPromptFixture.h>
+#include <bcos-gateway/libp2p/LinkQuality.h>
+#include <boost/test/unit_test.hpp>
+#include <limits>
+
+using namespace bcos;
+using namespace bcos::gateway;
+using namespace bcos::test;
+
+BOOST_FIXTURE_TEST_SUITE(LinkQualityTest, TestPromptFixture)
+
+BOOST_AUTO_TEST_CASE(test_echo)
+{
+    // the clocks of the two sides are not synchronized
+    LinkQuality local;
+    LinkQuality peer;
+    const uint64_t oneWayDelay = 1000;
+    uint64_t localTime = 1000000;
+    uint64_t peerTime = 9000000;
+    BOOST_CHECK(!local.measured());
+    BOOST_CHECK_EQUAL(local.rtt(), LinkQuality::c_defaultRtt);
+
+    for (size_t i = 0; i < 3; ++i)
+    {
+        bytes payload;
+        local.encodeEcho(payload, localTime);
+        BOOST_CHECK_EQUAL(payload.size(), LinkQuality::c_echoSize);
+        localTime += oneWayDelay;
+        peerTime += oneWayDelay;
+        BOOST_CHECK(peer.decodeEcho(ref(payload), peerTime));
+
+        // the peer sends its heartbeat 3000us later
+        localTime += 3000;
+        peerTime += 3000;
+        payload.clear();
+        peer.encodeEcho(payload, peerTime);
+        localTime += oneWayDelay;
+        peerTime += oneWayDelay;
+        BOOST_CHECK(local.decodeEcho(ref(payload), localTime));
+        BOOST_CHECK(local.measured());
+        BOOST_CHECK_EQUAL(local.rtt(), 2 * oneWayDelay);
+        localTime += 10000;
+        peerTime += 10000;
+    }
+    BOOST_CHECK_EQUAL(local.loss(), 0);
+    // the echo received again is ignored
+    bytes payload;
+    peer.encodeEcho(payload, peerTime);
+    BOOST_CHECK(local.decodeEcho(ref(payload), localTime + 100000));
+    BOOST_CHECK_EQUAL(local.rtt(), 2 * oneWayDelay);
+    BOOST_CHECK(!local.decodeEcho(bytesConstRef(payload.data(), 8), localTime));
+}
+
+BOOST_AUTO_TEST_CASE(test_loss)
+{
+    LinkQuality quality;
+    bytes payload;
+    // not echoed by the peer
+    for (uint64_t i = 1; i <= 5; ++i)
+    {
+        quality.encodeEcho(payload, i * 1000);
+    }
+    BOOST_CHECK(quality.loss() > 0.4);
+    auto lossyScore = quality.score();
+
+    // the requests succeeded
+    for (size_t i = 0; i < 20; ++i)
+    {
+        quality.onRequestStarted();
+        quality.onRequestFinished(true, 1000);
+    }
+    BOOST_CHECK(quality.loss() < 0.05);
+    BOOST_CHECK(quality.score() < lossyScore);
+    BOOST_CHECK_EQUAL(quality.inflight(), 0);
+
+    auto score = quality.score();
+    quality.onRequestStarted();
+    BOOST_CHECK_EQUAL(quality.inflight(), 1);
+    BOOST_CHECK(quality.score() > score);
+}
+
+BOOST_AUTO_TEST_CASE(test_latencyP95)
+{
+    LinkQuality quality;
+    for (uint64_t i = 1; i < LinkQuality::c_minLatencySamples; ++i)
+    {
+        quality.onRequestStarted();
+        quality.onRequestFinished(true, i);
+    }
+    // not enough samples
+    BOOST_CHECK_EQUAL(quality.latencyP95(), 0);
+
+    // only the latest samples are kept, the failed requests are not sampled
+    for (uint64_t i = 1; i <= 1000; ++i)
+    {
+        quality.onRequestStarted();
+        quality.onRequestFinished(true, 1000000 + i % 100);
+        quality.onRequestStarted();
+        quality.onRequestFinished(false, 1);
+    }
+    auto p95 = quality.latencyP95();
+    BOOST_CHECK(p95 >= 1000000 + 90 && p95 <= 1000000 + 99);
+    BOOST_CHECK_EQUAL(quality.inflight(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_choose)
+{
+    BOOST_CHECK_EQUAL(LinkQuality::choose({}, false), 0);
+    BOOST_CHECK_EQUAL(LinkQuality::choose({5}, false), 0);
+    BOOST_CHECK_EQUAL(LinkQuality::choose({3, 1, 2}, true), 1);
+
+    // the slowest gateway is never the better of two
+    std::vector<double> scores = {1000, 1100, 1200, 50000};
+    std::vector<size_t> chosen(scores.size(), 0);
+    for (size_t i = 0; i < 10000; ++i)
+    {
+        chosen[LinkQuality::choose(scores, false)]++;
+    }
+    BOOST_CHECK_EQUAL(chosen[3], 0);
+    // still spread over the other gateways
+    BOOST_CHECK(chosen[0] > chosen[1] && chosen[1] > chosen[2] && chosen[2] > 0);
+
+    // the unusable gateways are chosen at last
+    auto max = std::numeric_limits<double>::max();
+    for (size_t i = 0; i < 100; ++i)
+    {
+        BOOST_CHECK_EQUAL(LinkQuality::choose({max, max, 7}, false), 2);
+        BOOST_CHECK_EQUAL(LinkQuality::choose({max, 7}, false), 1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_aggregate)
+{
+    auto first = std::make_shared<LinkQuality>();
+    auto second = std::make_shared<LinkQuality>();
+    auto third = std::make_shared<LinkQuality>();
+    BOOST_CHECK(LinkQuality::aggregate({first}) == first);
+
+    // the rtt of the first is 1000us and the third 3000us, the second is not measured
+    first->onHeartbeatSent(10000);
+    first->onHeartbeatReceived(1, 10000, 0, 11000);
+    third->onHeartbeatSent(10000);
+    third->onHeartbeatReceived(1, 10000, 0, 13000);
+    for (size_t i = 0; i < LinkQuality::c_minLatencySamples; ++i)
+    {
+        first->onRequestStarted();
+        first->onRequestFinished(true, 500);
+    }
+    second->onRequestStarted();
+    second->onRequestStarted();
+    third->onRequestStarted();
+    third->onRequestFinished(false, 1);
+
+    auto aggregated = LinkQuality::aggregate({first, second, third});
+    BOOST_CHECK(aggregated->measured());
+    BOOST_CHECK_EQUAL(aggregated->rtt(), 2000);
+    BOOST_CHECK_CLOSE(aggregated->loss(), third->loss() / 3, 0.001);
+    BOOST_CHECK_EQUAL(aggregated->inflight(), 2);
+    BOOST_CHECK_EQUAL(aggregated->latencyP95(), 500);
+    // the requests waiting and the loss of the other links make the peer worse than its best link
+    BOOST_CHECK(aggregated->score() > first->score());
+
+    auto unmeasured = LinkQuality::aggregate({second, std::make_shared<LinkQuality>()});
+    BOOST_CHECK(!unmeasured->measured());
+    BOOST_CHECK_EQUAL(unmeasured->rtt(), LinkQuality::c_defaultRtt);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
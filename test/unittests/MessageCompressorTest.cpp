@@ -0,0 +1,125 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief test for the payload compression of the p2p messages
+ * @file MessageCompressorTest.cpp
+ */
+
+#include "../common/FakeP2PMessage.h"
+#include <bcos-framework/testutils/TestPromptFixture.h>
+#include <bcos-gateway/libp2p/MessageCompressor.h>
+#include <boost/test/unit_test.hpp>
+#include <random>
+
+using namespace bcos;
+using namespace bcos::gateway;
+using namespace bcos::test;
+
+namespace
+{
+P2PMessage::Ptr buildMessage(std::shared_ptr<bytes> _payload)
+{
+    auto message = fakeP2PMessage(0, 100);
+    message->setPayload(_payload);
+    return message;
+}
+
+std::shared_ptr<bytes> compressiblePayload(size_t _size)
+{
+    auto payload = std::make_shared<bytes>(_size);
+    for (size_t i = 0; i < _size; ++i)
+    {
+        (*payload)[i] = (byte)((i / 16) % 8);
+    }
+    return payload;
+}
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE(MessageCompressorTest, TestPromptFixture)
+
+BOOST_AUTO_TEST_CASE(test_compressAndDecompress)
+{
+    MessageCompressor compressor(1024, 3);
+    auto payload = compressiblePayload(256 * 1024);
+    auto message = buildMessage(payload);
+    uint64_t timeCost = 0;
+    auto compressed = compressor.compress(message, timeCost);
+    BOOST_CHECK(compressed);
+    BOOST_CHECK(compressed->ext() & MessageExtFieldFlag::Compress);
+    BOOST_CHECK(compressed->payloadRef().size() < payload->size() / 10);
+    // the original message is not modified
+    BOOST_CHECK(!(message->ext() & MessageExtFieldFlag::Compress));
+    BOOST_CHECK(*message->payload() == *payload);
+
+    // encode and decode as the receiver
+    bytes buffer;
+    BOOST_CHECK(compressed->encode(buffer));
+    auto received = std::make_shared<P2PMessage>();
+    BOOST_CHECK_EQUAL(received->decode(bytesConstRef(buffer.data(), buffer.size())),
+        (ssize_t)buffer.size());
+    CompressionMetrics metrics;
+    metrics.onCompressed(payload->size(), compressed->payloadRef().size(), timeCost);
+    BOOST_CHECK(MessageCompressor::decompress(received, &metrics));
+    BOOST_CHECK(!(received->ext() & MessageExtFieldFlag::Compress));
+    BOOST_CHECK(*received->payload() == *payload);
+    BOOST_CHECK_EQUAL(received->options()->groupID(), "group0");
+    BOOST_CHECK_EQUAL(received->seq(), 100);
+    BOOST_CHECK(metrics.toString().find("sent:1/262144B/") == 0);
+
+    // the message not compressed is not modified
+    BOOST_CHECK(MessageCompressor::decompress(message, nullptr));
+    BOOST_CHECK(*message->payload() == *payload);
+}
+
+BOOST_AUTO_TEST_CASE(test_notCompressed)
+{
+    MessageCompressor compressor(1024, 3);
+    uint64_t timeCost = 0;
+    // no larger than the threshold
+    BOOST_CHECK(!compressor.compress(buildMessage(compressiblePayload(1024)), timeCost));
+
+    // not compressible
+    std::mt19937 random(1);
+    auto payload = std::make_shared<bytes>(64 * 1024);
+    for (auto& value : *payload)
+    {
+        value = (byte)random();
+    }
+    BOOST_CHECK(!compressor.compress(buildMessage(payload), timeCost));
+
+    // compressed already
+    auto compressed = compressor.compress(buildMessage(compressiblePayload(8192)), timeCost);
+    BOOST_CHECK(compressed);
+    BOOST_CHECK(!compressor.compress(compressed, timeCost));
+}
+
+BOOST_AUTO_TEST_CASE(test_invalidPayload)
+{
+    auto message = buildMessage(compressiblePayload(1024));
+    message->setExt(MessageExtFieldFlag::Compress);
+    BOOST_CHECK(!MessageCompressor::decompress(message, nullptr));
+
+    // truncated
+    MessageCompressor compressor(0, 1);
+    uint64_t timeCost = 0;
+    auto compressed = compressor.compress(buildMessage(compressiblePayload(8192)), timeCost);
+    BOOST_CHECK(compressed);
+    auto payload = compressed->payload();
+    payload->resize(payload->size() / 2);
+    compressed->setPayload(payload);
+    BOOST_CHECK(!MessageCompressor::decompress(compressed, nullptr));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
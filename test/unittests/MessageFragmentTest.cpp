@@ -0,0 +1,250 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief test for the fragmentation and the reassembly of the large messages
+ * @file MessageFragmentTest.cpp
+ */
+
+#include "../common/FakeP2PMessage.h"
+#include <bcos-framework/testutils/TestPromptFixture.h>
+#include <bcos-gateway/libnetwork/MessageFragment.h>
+#include <bcos-gateway/libnetwork/WriteQueue.h>
+#include <bcos-gateway/libp2p/P2PMessage.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace bcos;
+using namespace bcos::gateway;
+using namespace bcos::test;
+
+namespace
+{
+bytesConstRef toRef(std::shared_ptr<bytes> const& _buffer)
+{
+    return bytesConstRef(_buffer->data(), _buffer->size());
+}
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE(MessageFragmentTest, TestPromptFixture)
+
+BOOST_AUTO_TEST_CASE(test_splitAndReassemble)
+{
+    auto frame = encodeFakeP2PMessage(200 * 1024 + 17, 3);
+    auto fragments = MessageFragmenter::split(toRef(frame), 1, 64 * 1024);
+    BOOST_CHECK_EQUAL(fragments.size(), (frame->size() + 64 * 1024 - 1) / (64 * 1024));
+
+    MessageReassembler reassembler(1024 * 1024);
+    std::shared_ptr<bytes> result;
+    for (size_t i = 0; i < fragments.size(); ++i)
+    {
+        BOOST_CHECK(MessageFragmenter::isFragment(toRef(fragments[i])));
+        // incomplete fragment
+        BOOST_CHECK_EQUAL(reassembler.decode(toRef(fragments[i]).getCroppedData(0, 30), result),
+            MessageDecodeStatus::MESSAGE_INCOMPLETE);
+        BOOST_CHECK_EQUAL(
+            reassembler.decode(toRef(fragments[i]), result), (ssize_t)fragments[i]->size());
+        BOOST_CHECK_EQUAL(result == nullptr, i + 1 < fragments.size());
+    }
+    BOOST_CHECK_EQUAL(reassembler.size(), 0);
+    BOOST_CHECK_EQUAL(reassembler.bytesSize(), 0);
+    BOOST_CHECK(*result == *frame);
+
+    // the reassembled frame is decoded as the original message
+    auto message = std::make_shared<P2PMessage>();
+    BOOST_CHECK_EQUAL(message->decode(result, toRef(result)), (ssize_t)result->size());
+    BOOST_CHECK_EQUAL(message->seq(), 3);
+    BOOST_CHECK_EQUAL(message->payloadRef().size(), 200 * 1024 + 17);
+    BOOST_CHECK_EQUAL(message->options()->groupID(), "group0");
+
+    // the frame no larger than the fragment size is not fragmented
+    BOOST_CHECK(!MessageFragmenter::isFragment(toRef(frame)));
+    BOOST_CHECK_EQUAL(MessageFragmenter::split(toRef(frame), 2, frame->size()).size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_interleave)
+{
+    auto bulk = encodeFakeP2PMessage(1024 * 1024, 1);
+    auto consensus = encodeFakeP2PMessage(256, 2);
+    auto fragments = MessageFragmenter::split(toRef(bulk), 1, 64 * 1024);
+
+    // the consensus message queued after the fragments of the bulk message is sent before most
+    // of them
+    WriteQueue queue;
+    for (auto& fragment : fragments)
+    {
+        queue.push(fragment, MessagePriority::Bulk);
+    }
+    queue.push(consensus, MessagePriority::Consensus);
+    auto other = encodeFakeP2PMessage(1024 * 1024 + 100, 4);
+    auto otherFragments = MessageFragmenter::split(toRef(other), 2, 64 * 1024);
+    for (auto& fragment : otherFragments)
+    {
+        queue.push(fragment, MessagePriority::Normal);
+    }
+
+    MessageReassembler reassembler(4 * 1024 * 1024);
+    std::vector<std::shared_ptr<bytes>> frames;
+    size_t sentBeforeConsensus = 0;
+    bool consensusSent = false;
+    while (!queue.empty())
+    {
+        auto buffer = queue.pop().buffer;
+        if (!MessageFragmenter::isFragment(toRef(buffer)))
+        {
+            BOOST_CHECK(*buffer == *consensus);
+            consensusSent = true;
+            continue;
+        }
+        if (!consensusSent)
+        {
+            sentBeforeConsensus++;
+        }
+        std::shared_ptr<bytes> frame;
+        BOOST_CHECK_EQUAL(reassembler.decode(toRef(buffer), frame), (ssize_t)buffer->size());
+        if (frame)
+        {
+            frames.push_back(frame);
+        }
+    }
+    BOOST_CHECK(sentBeforeConsensus <= 1);
+    // the fragments of the two messages are interleaved and reassembled separately
+    BOOST_CHECK_EQUAL(frames.size(), 2);
+    BOOST_CHECK(*frames[0] == *other);
+    BOOST_CHECK(*frames[1] == *bulk);
+}
+
+BOOST_AUTO_TEST_CASE(test_splitGather)
+{
+    auto message = fakeP2PMessage(150 * 1024, 5);
+    bytes frame;
+    BOOST_CHECK(message->encode(frame));
+
+    // the header and the options are encoded separately, the payload is referenced
+    WriteBuffer gather;
+    BOOST_CHECK(message->encode(gather));
+    BOOST_CHECK_EQUAL(gather.buffer->size(), frame.size() - 150 * 1024);
+    BOOST_CHECK(gather.payload.data() == message->payloadRef().data());
+    BOOST_CHECK(gather.toBytes() == frame);
+
+    // the fragments reference the payload, the reassembled frame is the same as the contiguous one
+    auto fragments = MessageFragmenter::split(gather, 1, 64 * 1024);
+    BOOST_CHECK_EQUAL(fragments.size(), 3);
+    MessageReassembler reassembler(1024 * 1024);
+    std::shared_ptr<bytes> result;
+    for (auto const& fragment : fragments)
+    {
+        BOOST_CHECK(fragment.buffer->size() <= MessageFragmenter::FRAGMENT_HEADER_LENGTH +
+                                                   gather.buffer->size());
+        BOOST_CHECK(fragment.payload.empty() || fragment.holder);
+        auto buffer = fragment.toBytes();
+        BOOST_CHECK_EQUAL(reassembler.decode(bytesConstRef(buffer.data(), buffer.size()), result),
+            (ssize_t)buffer.size());
+    }
+    BOOST_CHECK(result && *result == frame);
+    auto contiguous =
+        MessageFragmenter::split(bytesConstRef(frame.data(), frame.size()), 1, 64 * 1024);
+    for (size_t i = 0; i < fragments.size(); ++i)
+    {
+        BOOST_CHECK(fragments[i].toBytes() == *contiguous[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_reassemblyLimit)
+{
+    auto first = encodeFakeP2PMessage(100 * 1024, 1);
+    auto second = encodeFakeP2PMessage(100 * 1024, 2);
+    auto firstFragments = MessageFragmenter::split(toRef(first), 1, 64 * 1024);
+    auto secondFragments = MessageFragmenter::split(toRef(second), 2, 64 * 1024);
+
+    MessageReassembler reassembler(first->size() + 1024);
+    std::shared_ptr<bytes> frame;
+    BOOST_CHECK(reassembler.decode(toRef(firstFragments[0]), frame) > 0);
+    // only the bytes received are charged
+    auto received = firstFragments[0]->size() - MessageFragmenter::FRAGMENT_HEADER_LENGTH;
+    BOOST_CHECK_EQUAL(reassembler.bytesSize(), received);
+    BOOST_CHECK_EQUAL(reassembler.budget()->bytesSize(), received);
+    // exceeds the reassembly memory limit
+    BOOST_CHECK_EQUAL(reassembler.decode(toRef(secondFragments[0]), frame),
+        MessageDecodeStatus::MESSAGE_ERROR);
+
+    // the memory is released after reassembled
+    BOOST_CHECK(reassembler.decode(toRef(firstFragments[1]), frame) > 0);
+    BOOST_CHECK(frame);
+    BOOST_CHECK_EQUAL(reassembler.bytesSize(), 0);
+    BOOST_CHECK(reassembler.decode(toRef(secondFragments[0]), frame) > 0);
+
+    // the frame larger than the limit is rejected by its first fragment
+    auto large = encodeFakeP2PMessage(200 * 1024, 3);
+    auto largeFragments = MessageFragmenter::split(toRef(large), 3, 64 * 1024);
+    BOOST_CHECK_EQUAL(reassembler.decode(toRef(largeFragments[0]), frame),
+        MessageDecodeStatus::MESSAGE_ERROR);
+}
+
+BOOST_AUTO_TEST_CASE(test_sharedBudget)
+{
+    auto frame = encodeFakeP2PMessage(100 * 1024, 1);
+    auto fragments = MessageFragmenter::split(toRef(frame), 1, 64 * 1024);
+    auto received = fragments[0]->size() - MessageFragmenter::FRAGMENT_HEADER_LENGTH;
+
+    // the sessions of the host share the budget, the parallel sessions can not multiply it
+    auto budget = std::make_shared<ReassemblyBudget>(frame->size() + 1024);
+    std::shared_ptr<bytes> result;
+    {
+        MessageReassembler first(budget);
+        MessageReassembler second(budget);
+        BOOST_CHECK(first.decode(toRef(fragments[0]), result) > 0);
+        BOOST_CHECK_EQUAL(budget->bytesSize(), received);
+        BOOST_CHECK_EQUAL(
+            second.decode(toRef(fragments[0]), result), MessageDecodeStatus::MESSAGE_ERROR);
+        BOOST_CHECK_EQUAL(second.bytesSize(), 0);
+        BOOST_CHECK_EQUAL(budget->bytesSize(), received);
+    }
+    // the frames left by the dropped sessions are released
+    BOOST_CHECK_EQUAL(budget->bytesSize(), 0);
+    MessageReassembler third(budget);
+    for (auto const& fragment : fragments)
+    {
+        BOOST_CHECK(third.decode(toRef(fragment), result) > 0);
+    }
+    BOOST_CHECK(result && *result == *frame);
+    BOOST_CHECK_EQUAL(budget->bytesSize(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_invalidFragment)
+{
+    auto frame = encodeFakeP2PMessage(200 * 1024, 1);
+    auto fragments = MessageFragmenter::split(toRef(frame), 1, 64 * 1024);
+    std::shared_ptr<bytes> result;
+
+    // without the first fragment
+    MessageReassembler reassembler(1024 * 1024);
+    BOOST_CHECK_EQUAL(
+        reassembler.decode(toRef(fragments[1]), result), MessageDecodeStatus::MESSAGE_ERROR);
+
+    // out of order
+    BOOST_CHECK(reassembler.decode(toRef(fragments[0]), result) > 0);
+    BOOST_CHECK_EQUAL(
+        reassembler.decode(toRef(fragments[2]), result), MessageDecodeStatus::MESSAGE_ERROR);
+
+    // the length smaller than the fragment header
+    auto invalid = std::make_shared<bytes>(*fragments[0]);
+    (*invalid)[3] = 10;
+    (*invalid)[2] = 0;
+    (*invalid)[1] = 0;
+    (*invalid)[0] = 0;
+    BOOST_CHECK_EQUAL(
+        reassembler.decode(toRef(invalid), result), MessageDecodeStatus::MESSAGE_ERROR);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
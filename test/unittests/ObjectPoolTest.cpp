@@ -0,0 +1,148 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief test for the pool recycling the messages and the response callbacks
+ * @file ObjectPoolTest.cpp
+ */
+
+#include "../common/FakeP2PMessage.h"
+#include <bcos-framework/testutils/TestPromptFixture.h>
+#include <bcos-gateway/libnetwork/ObjectPool.h>
+#include <bcos-gateway/libnetwork/SessionFace.h>
+#include <bcos-gateway/libp2p/P2PMessage.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace bcos;
+using namespace bcos::gateway;
+using namespace bcos::test;
+
+namespace
+{
+// receive the messages as Session: build, decode without copy and release
+void receive(MessageFactory::Ptr _factory, std::shared_ptr<bytes> _frame, size_t _rounds)
+{
+    for (size_t i = 0; i < _rounds; ++i)
+    {
+        auto message = _factory->buildMessage();
+        message->decode(_frame, bytesConstRef(_frame->data(), _frame->size()));
+    }
+}
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE(ObjectPoolTest, TestPromptFixture)
+
+BOOST_AUTO_TEST_CASE(test_recycle)
+{
+    auto pool = ObjectPool<ResponseCallback>::create(2);
+    auto callback = pool->acquire();
+    auto raw = callback.get();
+    callback->m_startTime = 100;
+    callback->callback = [](NetworkException, Message::Ptr) {};
+    callback.reset();
+    BOOST_CHECK_EQUAL(pool->size(), 1);
+
+    // reused after reset
+    callback = pool->acquire();
+    BOOST_CHECK(callback.get() == raw);
+    BOOST_CHECK_EQUAL(callback->m_startTime, 0);
+    BOOST_CHECK(!callback->callback);
+    BOOST_CHECK(callback->shared_from_this() == callback);
+    BOOST_CHECK_EQUAL(pool->created(), 1);
+    BOOST_CHECK_EQUAL(pool->reused(), 1);
+
+    // at most capacity idle objects are kept
+    std::vector<ResponseCallback::Ptr> callbacks;
+    for (size_t i = 0; i < 5; ++i)
+    {
+        callbacks.push_back(pool->acquire());
+    }
+    callbacks.clear();
+    BOOST_CHECK_EQUAL(pool->size(), 2);
+
+    // released after the pool destroyed
+    callback = pool->acquire();
+    pool.reset();
+    callback.reset();
+}
+
+BOOST_AUTO_TEST_CASE(test_messageReset)
+{
+    auto factory = std::make_shared<P2PMessageFactory>(16);
+    auto frame = encodeFakeP2PMessage(100, 7);
+
+    auto message = std::static_pointer_cast<P2PMessage>(factory->buildMessage());
+    BOOST_CHECK_EQUAL(
+        message->decode(frame, bytesConstRef(frame->data(), frame->size())), frame->size());
+    auto raw = message.get();
+    // the payload shared with the others is not modified by the reset
+    auto payload = std::make_shared<bytes>(10, 0x05);
+    message->setPayload(payload);
+    auto options = message->options();
+    message.reset();
+    BOOST_CHECK_EQUAL(factory->pool()->size(), 1);
+    BOOST_CHECK(*payload == bytes(10, 0x05));
+
+    message = std::static_pointer_cast<P2PMessage>(factory->buildMessage());
+    BOOST_CHECK(message.get() == raw);
+    BOOST_CHECK_EQUAL(message->seq(), 0);
+    BOOST_CHECK_EQUAL(message->packetType(), 0);
+    BOOST_CHECK_EQUAL(message->ext(), 0);
+    BOOST_CHECK(message->payloadRef().empty());
+    BOOST_CHECK(message->payload() && message->payload() != payload);
+    // the options shared with the others are replaced
+    BOOST_CHECK(message->options() != options);
+    BOOST_CHECK(message->options()->groupID().empty());
+    BOOST_CHECK_EQUAL(message->options()->dstNodeIDCount(), 0);
+    BOOST_CHECK(message->options()->srcNodeIDRef().empty());
+    BOOST_CHECK_EQUAL(options->groupID(), "group0");
+    // the frame is only referenced by the options shared
+    options.reset();
+    BOOST_CHECK_EQUAL(frame.use_count(), 1);
+
+    // the recycled message is decoded as the new one
+    BOOST_CHECK_EQUAL(
+        message->decode(frame, bytesConstRef(frame->data(), frame->size())), frame->size());
+    BOOST_CHECK_EQUAL(message->seq(), 7);
+    BOOST_CHECK_EQUAL(message->options()->groupID(), "group0");
+    BOOST_CHECK(message->payloadRef().toBytes() == *fakePayload(100, 7));
+
+    // the pool is disabled
+    auto unpooled = std::make_shared<P2PMessageFactory>(0);
+    BOOST_CHECK(!unpooled->pool());
+    BOOST_CHECK(unpooled->buildMessage());
+}
+
+// the heap allocations saved by the pool are measured by the allocs/op of
+// P2PMessage_DecodeZeroCopy and ObjectPool_AcquireCallback in bcos-gateway-bench
+BOOST_AUTO_TEST_CASE(test_reuse)
+{
+    auto frame = encodeFakeP2PMessage(1024, 7);
+    auto factory = std::make_shared<P2PMessageFactory>(16);
+    receive(factory, frame, 1000);
+    // one message is enough to receive the messages one by one
+    BOOST_CHECK_EQUAL(factory->pool()->created(), 1);
+    BOOST_CHECK_EQUAL(factory->pool()->reused(), 999);
+
+    auto pool = ObjectPool<ResponseCallback>::create(16);
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        auto callback = pool->acquire();
+        callback->m_startTime = i;
+    }
+    BOOST_CHECK_EQUAL(pool->created(), 1);
+    BOOST_CHECK_EQUAL(pool->reused(), 999);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
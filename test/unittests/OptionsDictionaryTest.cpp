@@ -0,0 +1,196 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief test for the compact options and the per-session dictionary
+ * @file OptionsDictionaryTest.cpp
+ */
+
+#include "../common/FakeP2PMessage.h"
+#include <bcos-framework/testutils/TestPromptFixture.h>
+#include <bcos-gateway/libp2p/OptionsDictionary.h>
+#include <bcos-gateway/libp2p/P2PMessage.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace bcos;
+using namespace bcos::gateway;
+using namespace bcos::test;
+
+namespace
+{
+P2PMessage::Ptr fakeMessage(bool _compact, uint32_t _seq)
+{
+    auto message = fakeP2PMessage(
+        10, _seq, _compact ? c_compactOptionsVersion : c_legacyProtocolVersion);
+    message->setExt(_compact ? MessageExtFieldFlag::CompactOptions : 0);
+    return message;
+}
+
+// encode _message by the dictionary of the sending side
+std::shared_ptr<bytes> encodeMessage(P2PMessage::Ptr _message, OptionsDictionary& _dictionary)
+{
+    auto message = std::make_shared<P2PMessage>(*_message);
+    auto encodedOptions = std::make_shared<bytes>();
+    BOOST_CHECK(message->options()->encodeCompact(*encodedOptions, &_dictionary));
+    message->setEncodedOptions(encodedOptions);
+    auto buffer = std::make_shared<bytes>();
+    BOOST_CHECK(message->encode(*buffer));
+    return buffer;
+}
+
+P2PMessage::Ptr decodeMessage(std::shared_ptr<bytes> _buffer)
+{
+    auto message = std::make_shared<P2PMessage>();
+    BOOST_CHECK_EQUAL(message->decode(_buffer, bytesConstRef(_buffer->data(), _buffer->size())),
+        (ssize_t)_buffer->size());
+    return message;
+}
+
+void checkOptions(P2PMessage::Ptr _message)
+{
+    auto options = _message->options();
+    BOOST_CHECK(!options->unresolved());
+    BOOST_CHECK_EQUAL(options->groupID(), "group0");
+    BOOST_CHECK(*options->srcNodeID() == bytes(64, 0x01));
+    BOOST_CHECK_EQUAL(options->dstNodeIDCount(), 1);
+    BOOST_CHECK(*options->dstNodeIDs()[0] == bytes(64, 0x02));
+    BOOST_CHECK(_message->payloadRef().toBytes() == *fakePayload(10, _message->seq()));
+}
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE(OptionsDictionaryTest, TestPromptFixture)
+
+BOOST_AUTO_TEST_CASE(test_compactOptions)
+{
+    OptionsDictionary sender;
+    OptionsDictionary receiver;
+    auto message = fakeMessage(true, 1);
+    bytes legacy;
+    fakeMessage(false, 1)->encode(legacy);
+
+    // the values are defined until acknowledged
+    auto first = encodeMessage(message, sender);
+    auto second = encodeMessage(message, sender);
+    BOOST_CHECK_EQUAL(first->size(), second->size());
+    // about the same size as the legacy version before acknowledged
+    BOOST_CHECK(first->size() <= legacy.size() + 2);
+
+    // the definitions received out of order
+    auto decoded = decodeMessage(second);
+    BOOST_CHECK(decoded->options()->unresolved());
+    BOOST_CHECK(decoded->options()->resolve(&receiver));
+    checkOptions(decoded);
+    decoded = decodeMessage(first);
+    BOOST_CHECK(decoded->options()->resolve(&receiver));
+    checkOptions(decoded);
+    BOOST_CHECK_EQUAL(receiver.learned(), 3);
+
+    // referenced by the index after acknowledged
+    sender.acknowledge(receiver.learned());
+    BOOST_CHECK_EQUAL(sender.acknowledged(), 3);
+    auto third = encodeMessage(message, sender);
+    BOOST_CHECK_EQUAL(third->size(), P2PMessage::MESSAGE_HEADER_LENGTH + 4 + 10);
+    decoded = decodeMessage(third);
+    BOOST_CHECK(decoded->options()->resolve(&receiver));
+    checkOptions(decoded);
+
+    // the new nodeID is defined and the others are referenced
+    message->options()->dstNodeIDs().push_back(std::make_shared<bytes>(64, 0x04));
+    decoded = decodeMessage(encodeMessage(message, sender));
+    BOOST_CHECK(decoded->options()->resolve(&receiver));
+    BOOST_CHECK(*decoded->options()->dstNodeIDs()[1] == bytes(64, 0x04));
+    BOOST_CHECK_EQUAL(receiver.learned(), 4);
+
+    // the acknowledgement never goes back or exceeds the entries sent
+    sender.acknowledge(1);
+    BOOST_CHECK_EQUAL(sender.acknowledged(), 3);
+    sender.acknowledge(100);
+    BOOST_CHECK_EQUAL(sender.acknowledged(), 4);
+}
+
+BOOST_AUTO_TEST_CASE(test_withoutDictionary)
+{
+    // the encoded options are ignored without the CompactOptions flag
+    auto message = fakeMessage(false, 1);
+    message->setEncodedOptions(std::make_shared<bytes>(3, 0));
+    auto decoded = decodeMessage(encodeMessage(message, *std::make_shared<OptionsDictionary>()));
+    BOOST_CHECK(!decoded->options()->unresolved());
+    checkOptions(decoded);
+
+    // all the values are sent without index
+    message = fakeMessage(true, 1);
+    auto buffer = std::make_shared<bytes>();
+    BOOST_CHECK(message->encode(*buffer));
+    decoded = decodeMessage(buffer);
+    BOOST_CHECK(decoded->options()->resolve(nullptr));
+    checkOptions(decoded);
+}
+
+BOOST_AUTO_TEST_CASE(test_invalidEntries)
+{
+    OptionsDictionary sender;
+    auto message = fakeMessage(true, 1);
+    auto definition = encodeMessage(message, sender);
+    sender.acknowledge(3);
+    auto reference = encodeMessage(message, sender);
+
+    // referenced before defined
+    OptionsDictionary receiver;
+    auto decoded = decodeMessage(reference);
+    BOOST_CHECK(!decoded->options()->resolve(&receiver));
+    BOOST_CHECK(!decoded->options()->resolve(nullptr));
+
+    // redefined by another value
+    BOOST_CHECK(decodeMessage(definition)->options()->resolve(&receiver));
+    OptionsDictionary other;
+    other.prepare(bytesConstRef((byte const*)"group1", 6));
+    decoded = decodeMessage(encodeMessage(message, other));
+    BOOST_CHECK(!decoded->options()->resolve(&receiver));
+
+    // the index exceeds the limit
+    OptionsDictionary::Entry entry;
+    entry.kind = OptionsDictionary::EntryKind::Reference;
+    entry.index = OptionsDictionary::c_maxEntries;
+    BOOST_CHECK(!receiver.resolve(entry));
+
+    // truncated options
+    auto invalid = std::make_shared<bytes>(
+        definition->begin(), definition->begin() + P2PMessage::MESSAGE_HEADER_LENGTH + 5);
+    uint32_t length = boost::asio::detail::socket_ops::host_to_network_long(invalid->size());
+    memcpy(invalid->data(), &length, 4);
+    decoded = std::make_shared<P2PMessage>();
+    BOOST_CHECK_EQUAL(decoded->decode(invalid, bytesConstRef(invalid->data(), invalid->size())),
+        MessageDecodeStatus::MESSAGE_ERROR);
+}
+
+BOOST_AUTO_TEST_CASE(test_dictionaryFull)
+{
+    OptionsDictionary sender;
+    for (size_t i = 0; i < OptionsDictionary::c_maxEntries; ++i)
+    {
+        auto value = std::to_string(i);
+        BOOST_CHECK_EQUAL(
+            sender.prepare(bytesConstRef((byte const*)value.data(), value.size())).kind,
+            OptionsDictionary::EntryKind::Define);
+    }
+    // sent without index after the dictionary is full
+    auto entry = sender.prepare(bytesConstRef((byte const*)"full", 4));
+    BOOST_CHECK_EQUAL(entry.kind, OptionsDictionary::EntryKind::Literal);
+    OptionsDictionary receiver;
+    auto value = receiver.resolve(entry);
+    BOOST_CHECK(value && *value == bytes({'f', 'u', 'l', 'l'}));
+    BOOST_CHECK_EQUAL(receiver.learned(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,171 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief test for the OrderedExecutor
+ * @file OrderedExecutorTest.cpp
+ */
+
+#include <bcos-framework/testutils/TestPromptFixture.h>
+#include <bcos-gateway/libnetwork/OrderedExecutor.h>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+
+using namespace bcos;
+using namespace bcos::gateway;
+using namespace bcos::test;
+
+namespace
+{
+bool waitFor(std::function<bool()> _condition)
+{
+    for (size_t i = 0; i < 1000 && !_condition(); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return _condition();
+}
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE(OrderedExecutorTest, TestPromptFixture)
+
+BOOST_AUTO_TEST_CASE(test_order)
+{
+    auto executor = std::make_shared<OrderedExecutor>("test", 4, 8);
+    executor->start();
+
+    const size_t queueCount = 16;
+    const size_t taskCount = 1000;
+    std::vector<OrderedExecutor::Queue::Ptr> queues;
+    std::vector<std::vector<size_t>> executed(queueCount);
+    std::atomic<size_t> overlapped = {0};
+    std::atomic<size_t> done = {0};
+    for (size_t i = 0; i < queueCount; ++i)
+    {
+        queues.push_back(executor->newQueue());
+    }
+    for (size_t j = 0; j < taskCount; ++j)
+    {
+        for (size_t i = 0; i < queueCount; ++i)
+        {
+            auto& result = executed[i];
+            BOOST_CHECK(queues[i]->post([&result, &overlapped, &done, j]() {
+                // the vector of the queue is modified by one worker at a time
+                result.push_back(j);
+                if (result.size() != j + 1)
+                {
+                    overlapped++;
+                }
+                done++;
+            }));
+        }
+    }
+    BOOST_CHECK(waitFor([&]() { return done == queueCount * taskCount; }));
+    BOOST_CHECK_EQUAL(overlapped, 0);
+    for (size_t i = 0; i < queueCount; ++i)
+    {
+        BOOST_CHECK_EQUAL(executed[i].size(), taskCount);
+        BOOST_CHECK(std::is_sorted(executed[i].begin(), executed[i].end()));
+        BOOST_CHECK_EQUAL(queues[i]->depth(), 0);
+        BOOST_CHECK(queues[i]->maxDepth() > 0);
+        // the metrics are updated after the task returns
+        BOOST_CHECK(waitFor([&]() { return queues[i]->metrics().executed() == taskCount; }));
+    }
+    executor->stop();
+}
+
+BOOST_AUTO_TEST_CASE(test_fairness)
+{
+    // one worker: the busy queue is run in batches interleaved with the other queues
+    auto executor = std::make_shared<OrderedExecutor>("test", 1, 4);
+    executor->start();
+    auto busyQueue = executor->newQueue();
+    auto queue = executor->newQueue();
+
+    std::atomic<size_t> busyExecuted = {0};
+    std::atomic_bool blocked = {true};
+    busyQueue->post([&]() {
+        while (blocked)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        busyQueue->post([&]() { busyExecuted++; });
+    }
+    std::atomic<size_t> busyExecutedBefore = {0};
+    std::atomic_bool executed = {false};
+    queue->post([&]() {
+        busyExecutedBefore = busyExecuted.load();
+        executed = true;
+    });
+    blocked = false;
+
+    BOOST_CHECK(waitFor([&]() { return executed.load(); }));
+    BOOST_CHECK(busyExecutedBefore < 1000);
+    BOOST_CHECK(waitFor([&]() { return busyExecuted == 1000; }));
+    executor->stop();
+}
+
+BOOST_AUTO_TEST_CASE(test_steal)
+{
+    // the tasks of the queues blocked behind a long task on one worker are stolen by the others
+    auto executor = std::make_shared<OrderedExecutor>("test", 2, 1);
+    executor->start();
+    std::atomic_bool blocked = {true};
+    std::atomic<size_t> executed = {0};
+    std::vector<OrderedExecutor::Queue::Ptr> queues;
+    for (size_t i = 0; i < 8; ++i)
+    {
+        queues.push_back(executor->newQueue());
+    }
+    queues[0]->post([&]() {
+        while (blocked)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    for (size_t i = 1; i < queues.size(); ++i)
+    {
+        queues[i]->post([&]() { executed++; });
+    }
+    BOOST_CHECK(waitFor([&]() { return executed == queues.size() - 1; }));
+    blocked = false;
+    BOOST_CHECK(waitFor([&]() { return executor->metrics().executed() == queues.size(); }));
+    executor->stop();
+}
+
+BOOST_AUTO_TEST_CASE(test_stop)
+{
+    auto executor = std::make_shared<OrderedExecutor>("test", 2);
+    auto queue = executor->newQueue();
+    // not started
+    BOOST_CHECK(!queue->post([]() {}));
+    executor->start();
+    std::atomic<size_t> executed = {0};
+    BOOST_CHECK(queue->post([&]() { executed++; }));
+    BOOST_CHECK(waitFor([&]() { return queue->metrics().executed() == 1; }));
+    auto metrics = queue->toString();
+    BOOST_CHECK(metrics.find("depth:0,maxDepth:1,executed:1") == 0);
+    executor->stop();
+    BOOST_CHECK(!queue->post([&]() { executed++; }));
+
+    // the queues outliving the executor
+    executor.reset();
+    BOOST_CHECK(!queue->post([&]() { executed++; }));
+    BOOST_CHECK_EQUAL(executed, 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
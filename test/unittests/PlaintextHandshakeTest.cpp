@@ -0,0 +1,131 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief test for the plaintext handshake
+ * @file PlaintextHandshakeTest.cpp
+ */
+
+#include <bcos-framework/testutils/TestPromptFixture.h>
+#include <bcos-gateway/libnetwork/PlaintextHandshake.h>
+#include <bcos-gateway/libnetwork/Socket.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace bcos;
+using namespace bcos::gateway;
+using namespace bcos::test;
+
+namespace
+{
+std::shared_ptr<ba::ssl::context> buildContext(std::string const& _caFile)
+{
+    std::string path = "../test/unittests/data/";
+    auto context = std::make_shared<ba::ssl::context>(ba::ssl::context::tlsv12);
+    context->use_private_key_file(path + "ca/node.key", ba::ssl::context::pem);
+    context->use_certificate_chain_file(path + "ca/node.crt");
+    context->load_verify_file(path + _caFile);
+    return context;
+}
+
+struct HandshakeResult
+{
+    boost::system::error_code clientError;
+    boost::system::error_code serverError;
+    std::shared_ptr<X509> clientPeerCert;
+    std::shared_ptr<X509> serverPeerCert;
+};
+
+HandshakeResult handshake(
+    std::shared_ptr<ba::ssl::context> _serverContext, std::shared_ptr<ba::ssl::context> _context)
+{
+    ba::io_service ioService;
+    bi::tcp::acceptor acceptor(ioService, bi::tcp::endpoint(bi::make_address("127.0.0.1"), 0));
+    auto server = std::make_shared<Socket>(ioService, *_serverContext, NodeIPEndpoint());
+    auto client = std::make_shared<Socket>(ioService, *_context, NodeIPEndpoint());
+    HandshakeResult result;
+    acceptor.async_accept(server->ref(), [&](boost::system::error_code _error) {
+        BOOST_CHECK(!_error);
+        auto handshake = std::make_shared<PlaintextHandshake>(server, _serverContext, false);
+        handshake->start([&](boost::system::error_code const& _error, std::shared_ptr<X509> _cert) {
+            result.serverError = _error;
+            result.serverPeerCert = _cert;
+        });
+    });
+    client->ref().async_connect(acceptor.local_endpoint(), [&](boost::system::error_code _error) {
+        BOOST_CHECK(!_error);
+        auto handshake = std::make_shared<PlaintextHandshake>(client, _context, true);
+        handshake->start([&](boost::system::error_code const& _error, std::shared_ptr<X509> _cert) {
+            result.clientError = _error;
+            result.clientPeerCert = _cert;
+        });
+    });
+    ioService.run();
+    return result;
+}
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE(PlaintextHandshakeTest, TestPromptFixture)
+
+BOOST_AUTO_TEST_CASE(test_plaintextNetworks)
+{
+    PlaintextNetworks networks({"10.0.0.0/24", " 192.168.1.10", "fd00::/63", "0.0.0.0/0"});
+    BOOST_CHECK_EQUAL(networks.size(), 4);
+    BOOST_CHECK(networks.contains(bi::make_address("10.0.0.1")));
+    BOOST_CHECK(networks.contains(bi::make_address("192.168.1.10")));
+    BOOST_CHECK(networks.contains(bi::make_address("::ffff:10.0.0.255")));
+    BOOST_CHECK(networks.contains(bi::make_address("fd00:0:0:1::1")));
+    BOOST_CHECK(!networks.contains(bi::make_address("fd00:0:0:2::1")));
+
+    PlaintextNetworks rack({"10.0.0.0/24", "192.168.1.10"});
+    BOOST_CHECK(!rack.contains(bi::make_address("10.0.1.1")));
+    BOOST_CHECK(!rack.contains(bi::make_address("192.168.1.11")));
+    BOOST_CHECK(!rack.contains(bi::make_address("::1")));
+
+    BOOST_CHECK(PlaintextNetworks({"", " "}).empty());
+    BOOST_CHECK_THROW(PlaintextNetworks({"10.0.0.0/33"}), InvalidParameter);
+    BOOST_CHECK_THROW(PlaintextNetworks({"10.0.0/8"}), InvalidParameter);
+    BOOST_CHECK_THROW(PlaintextNetworks({"fd00::/x"}), InvalidParameter);
+}
+
+BOOST_AUTO_TEST_CASE(test_handshake)
+{
+    auto context = buildContext("ca/ca.crt");
+    auto result = handshake(context, context);
+    BOOST_CHECK(!result.clientError);
+    BOOST_CHECK(!result.serverError);
+    BOOST_REQUIRE(result.clientPeerCert && result.serverPeerCert);
+    // the certificates of the peers
+    auto cert = SSL_CTX_get0_certificate(context->native_handle());
+    BOOST_CHECK_EQUAL(X509_cmp(result.clientPeerCert.get(), cert), 0);
+    BOOST_CHECK_EQUAL(X509_cmp(result.serverPeerCert.get(), cert), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_untrustedCertificate)
+{
+    // the certificate of the client is not issued by the ca of the server
+    auto result = handshake(buildContext("sm_ca/sm_ca.crt"), buildContext("ca/ca.crt"));
+    BOOST_CHECK(result.serverError);
+    BOOST_CHECK(result.clientError);
+    BOOST_CHECK(!result.serverPeerCert);
+    BOOST_CHECK(!result.clientPeerCert);
+}
+
+BOOST_AUTO_TEST_CASE(test_isHello)
+{
+    BOOST_CHECK(PlaintextHandshake::isHello((byte)PlaintextHandshake::c_magic[0]));
+    // the tls handshake record
+    BOOST_CHECK(!PlaintextHandshake::isHello(0x16));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
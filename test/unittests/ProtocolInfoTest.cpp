@@ -0,0 +1,83 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief test for the protocol negotiation of the session
+ * @file ProtocolInfoTest.cpp
+ */
+
+#include <bcos-framework/testutils/TestPromptFixture.h>
+#include <bcos-gateway/libp2p/ProtocolInfo.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace bcos;
+using namespace bcos::gateway;
+using namespace bcos::test;
+
+BOOST_FIXTURE_TEST_SUITE(ProtocolInfoTest, TestPromptFixture)
+
+BOOST_AUTO_TEST_CASE(test_encodeDecode)
+{
+    ProtocolInfo info(1, 3, P2PFeature::Compression | P2PFeature::Fragmentation);
+    auto payload = info.encode();
+    BOOST_CHECK_EQUAL(payload.size(), (size_t)ProtocolInfo::PAYLOAD_MIN_LENGTH);
+
+    // the fields appended by the later versions are ignored
+    payload.push_back(0x01);
+    payload.push_back(0x02);
+    ProtocolInfo decoded;
+    BOOST_CHECK(decoded.decode(bytesConstRef(payload.data(), payload.size())));
+    BOOST_CHECK_EQUAL(decoded.minVersion(), 1);
+    BOOST_CHECK_EQUAL(decoded.maxVersion(), 3);
+    BOOST_CHECK_EQUAL(decoded.features(), P2PFeature::Compression | P2PFeature::Fragmentation);
+
+    // incomplete
+    BOOST_CHECK(!decoded.decode(bytesConstRef(payload.data(), 6)));
+    // min version larger than max version
+    payload = ProtocolInfo(3, 1, 0).encode();
+    BOOST_CHECK(!decoded.decode(bytesConstRef(payload.data(), payload.size())));
+}
+
+BOOST_AUTO_TEST_CASE(test_negotiate)
+{
+    ProtocolInfo local(c_minProtocolVersion, c_maxProtocolVersion,
+        P2PFeature::Compression | P2PFeature::Fragmentation);
+    uint16_t version = 0;
+    uint32_t features = 0;
+
+    // the same protocol
+    BOOST_CHECK(local.negotiate(local, version, features));
+    BOOST_CHECK_EQUAL(version, c_maxProtocolVersion);
+    BOOST_CHECK_EQUAL(features, P2PFeature::Compression | P2PFeature::Fragmentation);
+
+    // the peer of the newer version and only part of the features
+    ProtocolInfo newer(
+        c_minProtocolVersion, c_maxProtocolVersion + 2, P2PFeature::Compression | 0x80);
+    BOOST_CHECK(local.negotiate(newer, version, features));
+    BOOST_CHECK_EQUAL(version, c_maxProtocolVersion);
+    BOOST_CHECK_EQUAL(features, P2PFeature::Compression);
+
+    // the peer of the legacy version
+    BOOST_CHECK(local.negotiate(
+        ProtocolInfo(c_legacyProtocolVersion, c_legacyProtocolVersion, 0), version, features));
+    BOOST_CHECK_EQUAL(version, c_legacyProtocolVersion);
+    BOOST_CHECK_EQUAL(features, 0);
+
+    // no common version
+    BOOST_CHECK(!local.negotiate(
+        ProtocolInfo(c_maxProtocolVersion + 1, c_maxProtocolVersion + 2, P2PFeature::Compression),
+        version, features));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
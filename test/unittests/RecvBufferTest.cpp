@@ -0,0 +1,150 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief test for the receive buffer of the session
+ * @file RecvBufferTest.cpp
+ */
+
+#include <bcos-framework/testutils/TestPromptFixture.h>
+#include <bcos-gateway/libnetwork/RecvBuffer.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace bcos;
+using namespace bcos::gateway;
+using namespace bcos::test;
+
+namespace
+{
+// simulate the socket writing _data into the buffer, _readSize bytes each read
+void receive(RecvBuffer& _buffer, bytes const& _data, size_t _readSize)
+{
+    size_t offset = 0;
+    while (offset < _data.size())
+    {
+        auto writable = _buffer.writableBuffer();
+        auto size = std::min(std::min(_readSize, writable.size()), _data.size() - offset);
+        memcpy(writable.data(), _data.data() + offset, size);
+        _buffer.commit(size);
+        offset += size;
+    }
+}
+
+bytes makeData(size_t _size, byte _seed)
+{
+    bytes data(_size);
+    for (size_t i = 0; i < _size; ++i)
+    {
+        data[i] = (byte)(_seed + i);
+    }
+    return data;
+}
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE(RecvBufferTest, TestPromptFixture)
+
+BOOST_AUTO_TEST_CASE(test_consume)
+{
+    RecvBuffer buffer(16);
+    BOOST_CHECK_EQUAL(buffer.readableSize(), 0);
+    BOOST_CHECK(buffer.writableBuffer().size() >= 16);
+
+    auto data = makeData(10, 1);
+    receive(buffer, data, 10);
+    BOOST_CHECK_EQUAL(buffer.readableSize(), 10);
+    BOOST_CHECK(buffer.readableData().toBytes() == data);
+
+    buffer.consume(4);
+    BOOST_CHECK_EQUAL(buffer.readableSize(), 6);
+    BOOST_CHECK(buffer.readableData().toBytes() == bytes(data.begin() + 4, data.end()));
+
+    // consume all the data, the cursors are reset
+    buffer.consume(100);
+    BOOST_CHECK_EQUAL(buffer.readableSize(), 0);
+    BOOST_CHECK_EQUAL(buffer.writableBuffer().size(), buffer.capacity());
+}
+
+BOOST_AUTO_TEST_CASE(test_compactAndGrow)
+{
+    RecvBuffer buffer(16);
+    // frames of 7 bytes, receive in 5 bytes chunk and consume frame by frame
+    bytes stream;
+    for (byte i = 0; i < 100; ++i)
+    {
+        auto frame = makeData(7, i);
+        stream.insert(stream.end(), frame.begin(), frame.end());
+    }
+    size_t consumed = 0;
+    size_t offset = 0;
+    while (offset < stream.size())
+    {
+        auto size = std::min<size_t>(5, stream.size() - offset);
+        receive(buffer, bytes(stream.begin() + offset, stream.begin() + offset + size), 5);
+        offset += size;
+        while (buffer.readableSize() >= 7)
+        {
+            auto frame = buffer.readableData().getCroppedData(0, 7).toBytes();
+            BOOST_CHECK(frame == bytes(stream.begin() + consumed, stream.begin() + consumed + 7));
+            buffer.consume(7);
+            consumed += 7;
+        }
+    }
+    BOOST_CHECK_EQUAL(consumed, stream.size());
+    BOOST_CHECK_EQUAL(buffer.readableSize(), 0);
+    // the pending data is always less than one frame, the buffer only grows a little
+    BOOST_CHECK(buffer.capacity() <= 64);
+
+    // large frame makes the buffer grow and keep the pending data
+    auto largeFrame = makeData(3 * 1024 * 1024, 3);
+    receive(buffer, largeFrame, 4096);
+    BOOST_CHECK(buffer.capacity() >= largeFrame.size());
+    BOOST_CHECK(buffer.readableData().toBytes() == largeFrame);
+
+    // the memory is released after the large frame consumed
+    buffer.consume(largeFrame.size());
+    BOOST_CHECK_EQUAL(buffer.readableSize(), 0);
+    BOOST_CHECK(buffer.capacity() <= 32);
+}
+
+BOOST_AUTO_TEST_CASE(test_referencedChunk)
+{
+    RecvBuffer buffer(16);
+    auto data = makeData(12, 1);
+    receive(buffer, data, 12);
+
+    // the decoded message references the first 8 bytes
+    auto chunk = buffer.chunk();
+    auto frame = buffer.readableData().getCroppedData(0, 8);
+    buffer.consume(8);
+
+    // the referenced data is not overwritten by the following reads
+    auto nextData = makeData(40, 100);
+    receive(buffer, nextData, 16);
+    BOOST_CHECK(frame.toBytes() == bytes(data.begin(), data.begin() + 8));
+    BOOST_CHECK(buffer.chunk() != chunk);
+
+    bytes expected(data.begin() + 8, data.end());
+    expected.insert(expected.end(), nextData.begin(), nextData.end());
+    BOOST_CHECK(buffer.readableData().toBytes() == expected);
+
+    // the buffer is reused when no message references it
+    chunk.reset();
+    buffer.consume(expected.size());
+    auto current = buffer.chunk().get();
+    receive(buffer, data, 12);
+    BOOST_CHECK_EQUAL(buffer.chunk().get(), current);
+    BOOST_CHECK(buffer.readableData().toBytes() == data);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
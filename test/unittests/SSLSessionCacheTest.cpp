@@ -0,0 +1,154 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief test for the ssl session resumption
+ * @file SSLSessionCacheTest.cpp
+ */
+
+#include <bcos-framework/testutils/TestPromptFixture.h>
+#include <bcos-gateway/libnetwork/SSLSessionCache.h>
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/test/unit_test.hpp>
+
+using namespace bcos;
+using namespace bcos::gateway;
+using namespace bcos::test;
+
+namespace
+{
+using SSLStream = boost::asio::ssl::stream<boost::asio::ip::tcp::socket>;
+
+std::shared_ptr<boost::asio::ssl::context> buildContext()
+{
+    std::string path = "../test/unittests/data/ca/";
+    auto context =
+        std::make_shared<boost::asio::ssl::context>(boost::asio::ssl::context::tlsv12);
+    context->use_private_key_file(path + "node.key", boost::asio::ssl::context::pem);
+    context->use_certificate_chain_file(path + "node.crt");
+    context->load_verify_file(path + "ca.crt");
+    context->set_verify_mode(
+        boost::asio::ssl::verify_peer | boost::asio::ssl::verify_fail_if_no_peer_cert);
+    return context;
+}
+
+struct HandshakeResult
+{
+    bool clientResumed = false;
+    bool serverResumed = false;
+    std::string clientNodeInfo;
+    std::string serverNodeInfo;
+};
+
+// connect to the server and handshake, the verify callback records the node info of the peer
+HandshakeResult handshake(boost::asio::io_service& _ioService,
+    boost::asio::ip::tcp::acceptor& _acceptor, boost::asio::ssl::context& _serverContext,
+    boost::asio::ssl::context& _clientContext, SSLSessionCache& _serverCache,
+    SSLSessionCache& _clientCache, NodeIPEndpoint const& _endpoint)
+{
+    HandshakeResult result;
+    SSLStream server(_ioService, _serverContext);
+    SSLStream client(_ioService, _clientContext);
+    server.set_verify_callback([&result](bool _preverified, boost::asio::ssl::verify_context&) {
+        result.serverNodeInfo = "client#agency#node";
+        return _preverified;
+    });
+    client.set_verify_callback([&result](bool _preverified, boost::asio::ssl::verify_context&) {
+        result.clientNodeInfo = "server#agency#node";
+        return _preverified;
+    });
+    _acceptor.async_accept(server.lowest_layer(), [&](boost::system::error_code _error) {
+        BOOST_CHECK(!_error);
+        server.async_handshake(
+            boost::asio::ssl::stream_base::server, [&](boost::system::error_code _error) {
+                BOOST_CHECK(!_error);
+                auto ssl = server.native_handle();
+                result.serverResumed = SSL_session_reused(ssl);
+                if (result.serverResumed)
+                {
+                    BOOST_CHECK(SSLSessionCache::resumedNodeInfo(ssl, result.serverNodeInfo));
+                }
+                _serverCache.onHandshakeSucceed(ssl, _endpoint, false, result.serverNodeInfo);
+            });
+    });
+    client.lowest_layer().async_connect(
+        _acceptor.local_endpoint(), [&](boost::system::error_code _error) {
+            BOOST_CHECK(!_error);
+            _clientCache.setClientSession(client.native_handle(), _endpoint);
+            client.async_handshake(
+                boost::asio::ssl::stream_base::client, [&](boost::system::error_code _error) {
+                    BOOST_CHECK(!_error);
+                    auto ssl = client.native_handle();
+                    result.clientResumed = SSL_session_reused(ssl);
+                    if (result.clientResumed)
+                    {
+                        BOOST_CHECK(SSLSessionCache::resumedNodeInfo(ssl, result.clientNodeInfo));
+                    }
+                    _clientCache.onHandshakeSucceed(ssl, _endpoint, true, result.clientNodeInfo);
+                });
+        });
+    _ioService.restart();
+    _ioService.run();
+    // close the connections without close_notify like Socket::close
+    for (auto ssl : {server.native_handle(), client.native_handle()})
+    {
+        SSL_set_shutdown(ssl, SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+    }
+    return result;
+}
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE(SSLSessionCacheTest, TestPromptFixture)
+
+BOOST_AUTO_TEST_CASE(test_resumption)
+{
+    boost::asio::io_service ioService;
+    boost::asio::ip::tcp::acceptor acceptor(
+        ioService, boost::asio::ip::tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0));
+    auto serverContext = buildContext();
+    auto clientContext = buildContext();
+    SSLSessionCache serverCache;
+    SSLSessionCache clientCache;
+    serverCache.attach(serverContext->native_handle());
+    clientCache.attach(clientContext->native_handle());
+    NodeIPEndpoint endpoint("127.0.0.1", acceptor.local_endpoint().port());
+
+    // the first connection does the full handshake
+    auto result = handshake(
+        ioService, acceptor, *serverContext, *clientContext, serverCache, clientCache, endpoint);
+    BOOST_CHECK(!result.clientResumed);
+    BOOST_CHECK(!result.serverResumed);
+    BOOST_CHECK_EQUAL(clientCache.clientSessionSize(), 1);
+
+    // the reconnection resumes the session and gets the node info without the verify callback
+    result = handshake(
+        ioService, acceptor, *serverContext, *clientContext, serverCache, clientCache, endpoint);
+    BOOST_CHECK(result.clientResumed);
+    BOOST_CHECK(result.serverResumed);
+    BOOST_CHECK_EQUAL(result.clientNodeInfo, "server#agency#node");
+    BOOST_CHECK_EQUAL(result.serverNodeInfo, "client#agency#node");
+
+    // the session removed, do the full handshake again
+    clientCache.removeClientSession(endpoint);
+    result = handshake(
+        ioService, acceptor, *serverContext, *clientContext, serverCache, clientCache, endpoint);
+    BOOST_CHECK(!result.clientResumed);
+
+    clientCache.reportHandshake(false, true, 1000);
+    clientCache.reportHandshake(true, true, 100);
+    BOOST_CHECK(clientCache.metrics().find("resumedHandshakes:1") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
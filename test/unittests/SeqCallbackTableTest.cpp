@@ -0,0 +1,187 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief test for the response callback table of the session
+ * @file SeqCallbackTableTest.cpp
+ */
+
+#include <bcos-framework/testutils/TestPromptFixture.h>
+#include <bcos-gateway/libnetwork/SeqCallbackTable.h>
+#include <boost/test/unit_test.hpp>
+#include <thread>
+
+using namespace bcos;
+using namespace bcos::gateway;
+using namespace bcos::test;
+
+BOOST_FIXTURE_TEST_SUITE(SeqCallbackTableTest, TestPromptFixture)
+
+BOOST_AUTO_TEST_CASE(test_insertAndTake)
+{
+    SeqCallbackTable table(16);
+    auto callback = std::make_shared<ResponseCallback>();
+    BOOST_CHECK(table.insert(1, callback));
+    BOOST_CHECK_EQUAL(table.size(), 1);
+    BOOST_CHECK(table.get(1) == callback);
+    BOOST_CHECK(table.get(17) == nullptr);
+
+    BOOST_CHECK(table.take(1) == callback);
+    BOOST_CHECK(table.take(1) == nullptr);
+    BOOST_CHECK(table.get(1) == nullptr);
+    BOOST_CHECK_EQUAL(table.size(), 0);
+
+    // the seqs with the same index and the wrapped seqs never collide
+    std::vector<uint32_t> seqs = {0, 16, 32, 0xFFFFFFFF, 0xFFFFFFF0, 15};
+    std::map<uint32_t, ResponseCallback::Ptr> callbacks;
+    for (auto seq : seqs)
+    {
+        callbacks[seq] = std::make_shared<ResponseCallback>();
+        BOOST_CHECK(table.insert(seq, callbacks[seq]));
+    }
+    for (auto seq : seqs)
+    {
+        BOOST_CHECK(table.get(seq) == callbacks[seq]);
+    }
+    BOOST_CHECK(table.take(16) == callbacks[16]);
+    BOOST_CHECK(table.get(32) == callbacks[32]);
+    BOOST_CHECK(table.get(0xFFFFFFFF) == callbacks[0xFFFFFFFF]);
+}
+
+BOOST_AUTO_TEST_CASE(test_levels)
+{
+    SeqCallbackTable table(16);
+    std::map<uint32_t, ResponseCallback::Ptr> callbacks;
+    // more callbacks than the slots, placed in the next levels
+    for (uint32_t seq = 100; seq < 200; ++seq)
+    {
+        callbacks[seq] = std::make_shared<ResponseCallback>();
+        BOOST_CHECK(table.insert(seq, callbacks[seq]));
+    }
+    BOOST_CHECK_EQUAL(table.size(), 100);
+    for (uint32_t seq = 100; seq < 150; ++seq)
+    {
+        BOOST_CHECK(table.take(seq) == callbacks[seq]);
+    }
+    BOOST_CHECK_EQUAL(table.size(), 50);
+
+    auto all = table.takeAll();
+    BOOST_CHECK_EQUAL(all.size(), 50);
+    for (auto& it : all)
+    {
+        BOOST_CHECK(it.second == callbacks[it.first]);
+    }
+    BOOST_CHECK_EQUAL(table.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_concurrentTake)
+{
+    SeqCallbackTable table(1024);
+    const uint32_t count = 10000;
+    std::atomic<uint32_t> taken = {0};
+    // the producer inserts the seqs, two consumers race to take every seq
+    std::thread producer([&]() {
+        for (uint32_t seq = 0; seq < count; ++seq)
+        {
+            while (!table.insert(seq, std::make_shared<ResponseCallback>()))
+            {
+            }
+            // keep the number of callbacks in flight bounded
+            while (table.size() > 512)
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+    auto consumer = [&]() {
+        for (uint32_t seq = 0; seq < count; ++seq)
+        {
+            while (true)
+            {
+                if (table.take(seq))
+                {
+                    taken++;
+                    break;
+                }
+                // taken by the other consumer
+                if (taken.load() > seq && !table.get(seq))
+                {
+                    break;
+                }
+            }
+        }
+    };
+    std::thread consumer1(consumer);
+    std::thread consumer2(consumer);
+    producer.join();
+    consumer1.join();
+    consumer2.join();
+    BOOST_CHECK_EQUAL(taken.load(), count);
+    BOOST_CHECK_EQUAL(table.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_concurrentGet)
+{
+    SeqCallbackTable table(64);
+    std::atomic<bool> stopped = {false};
+    std::atomic<uint32_t> mismatched = {0};
+    std::map<uint32_t, ResponseCallback::Ptr> callbacks;
+    // the seq and seq + 64 share the slot
+    std::vector<uint32_t> seqs;
+    for (uint32_t seq = 0; seq < 32; ++seq)
+    {
+        seqs.push_back(seq);
+        seqs.push_back(seq + 64);
+    }
+    for (auto seq : seqs)
+    {
+        callbacks[seq] = std::make_shared<ResponseCallback>();
+    }
+    // the readers of the same seqs never wait for each other, and never see the callback of
+    // another seq reusing the slot
+    auto reader = [&]() {
+        while (!stopped.load())
+        {
+            for (auto seq : seqs)
+            {
+                auto callback = table.get(seq);
+                if (callback && callback != callbacks[seq])
+                {
+                    mismatched++;
+                }
+            }
+        }
+    };
+    std::thread reader1(reader);
+    std::thread reader2(reader);
+    for (size_t round = 0; round < 2000; ++round)
+    {
+        auto offset = (round % 2) * 64;
+        for (uint32_t seq = offset; seq < offset + 32; ++seq)
+        {
+            table.insert(seq, callbacks[seq]);
+        }
+        for (uint32_t seq = offset; seq < offset + 32; ++seq)
+        {
+            BOOST_CHECK(table.take(seq) == callbacks[seq]);
+        }
+    }
+    stopped = true;
+    reader1.join();
+    reader2.join();
+    BOOST_CHECK_EQUAL(mismatched.load(), 0);
+    BOOST_CHECK_EQUAL(table.size(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,163 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief test for the copy-on-write session table
+ * @file SessionTableTest.cpp
+ */
+
+#include <bcos-framework/testutils/TestPromptFixture.h>
+#include <bcos-gateway/libp2p/SessionTable.h>
+#include <boost/test/unit_test.hpp>
+#include <thread>
+
+using namespace bcos;
+using namespace bcos::gateway;
+using namespace bcos::test;
+
+BOOST_FIXTURE_TEST_SUITE(SessionTableTest, TestPromptFixture)
+
+BOOST_AUTO_TEST_CASE(test_publish)
+{
+    SessionTable table;
+    auto empty = table.snapshot();
+    BOOST_CHECK(empty->sessions.empty());
+    BOOST_CHECK(!empty->find("node1"));
+
+    auto session = std::make_shared<P2PSession>();
+    auto next = table.copy();
+    next->sessions["node1"] = session;
+    // not visible until published
+    BOOST_CHECK(!table.snapshot()->find("node1"));
+    table.publish(next);
+    BOOST_CHECK(table.snapshot()->find("node1") == session);
+    // the snapshot taken before is not modified
+    BOOST_CHECK(empty->sessions.empty());
+
+    // the snapshot published is seen by the other threads
+    P2PSession::Ptr found;
+    std::thread reader([&]() { found = table.snapshot()->find("node1"); });
+    reader.join();
+    BOOST_CHECK(found == session);
+
+    next = table.copy();
+    next->sessions.erase("node1");
+    next->stripeSessions["node2"].push_back(session);
+    table.publish(next);
+    BOOST_CHECK(!table.snapshot()->find("node1"));
+    BOOST_CHECK_EQUAL(table.snapshot()->stripeSessions.at("node2").size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_multipleTables)
+{
+    // the snapshots cached by the thread are not mixed up between the tables
+    SessionTable first;
+    SessionTable second;
+    auto next = first.copy();
+    next->sessions["node1"] = std::make_shared<P2PSession>();
+    first.publish(next);
+    for (size_t i = 0; i < 3; ++i)
+    {
+        BOOST_CHECK(first.snapshot()->find("node1"));
+        BOOST_CHECK(!second.snapshot()->find("node1"));
+    }
+
+    // a new table reusing the address of the destroyed one
+    auto table = std::make_unique<SessionTable>();
+    next = table->copy();
+    next->sessions["node1"] = std::make_shared<P2PSession>();
+    table->publish(next);
+    BOOST_CHECK(table->snapshot()->find("node1"));
+    table.reset();
+    table = std::make_unique<SessionTable>();
+    BOOST_CHECK(!table->snapshot()->find("node1"));
+}
+
+BOOST_AUTO_TEST_CASE(test_releaseReplaced)
+{
+    SessionTable table;
+    auto session = std::make_shared<P2PSession>();
+    std::weak_ptr<P2PSession> weakSession = session;
+    auto next = table.copy();
+    next->sessions["node1"] = session;
+    table.publish(next);
+    next.reset();
+    session.reset();
+
+    // a thread reads the snapshot once and stays idle
+    std::atomic_bool read = {false};
+    std::atomic_bool stop = {false};
+    std::thread reader([&]() {
+        BOOST_CHECK(table.snapshot()->find("node1"));
+        read = true;
+        while (!stop)
+        {
+            std::this_thread::yield();
+        }
+    });
+    while (!read)
+    {
+        std::this_thread::yield();
+    }
+    BOOST_CHECK(table.snapshot()->find("node1"));
+
+    // the session dropped from the table is released although both threads cached the snapshot
+    next = table.copy();
+    next->sessions.erase("node1");
+    table.publish(next);
+    next.reset();
+    BOOST_CHECK(weakSession.expired());
+    stop = true;
+    reader.join();
+    BOOST_CHECK(!table.snapshot()->find("node1"));
+}
+
+BOOST_AUTO_TEST_CASE(test_concurrentReaders)
+{
+    SessionTable table;
+    std::atomic_bool stop = {false};
+    std::atomic<size_t> invalid = {0};
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < 8; ++i)
+    {
+        readers.emplace_back([&]() {
+            while (!stop)
+            {
+                // every snapshot is consistent: the sessions are published with their stripes
+                auto snapshot = table.snapshot();
+                if (snapshot->sessions.size() != snapshot->stripeSessions.size())
+                {
+                    invalid++;
+                }
+            }
+        });
+    }
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        auto next = table.copy();
+        auto nodeID = "node" + std::to_string(i % 10);
+        next->sessions[nodeID] = std::make_shared<P2PSession>();
+        next->stripeSessions[nodeID].push_back(next->sessions[nodeID]);
+        table.publish(next);
+    }
+    stop = true;
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+    BOOST_CHECK_EQUAL(invalid, 0);
+    BOOST_CHECK_EQUAL(table.snapshot()->sessions.size(), 10);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
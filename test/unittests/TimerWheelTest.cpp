@@ -0,0 +1,84 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief test for the timer wheel
+ * @file TimerWheelTest.cpp
+ */
+
+#include <bcos-framework/testutils/TestPromptFixture.h>
+#include <bcos-gateway/libnetwork/TimerWheel.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace bcos;
+using namespace bcos::gateway;
+using namespace bcos::test;
+
+namespace
+{
+class FakeHandler : public TimerWheelHandler
+{
+public:
+    void onExpired(uint32_t _seq) override { expiredSeqs.push_back(_seq); }
+    std::vector<uint32_t> expiredSeqs;
+};
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE(TimerWheelTest, TestPromptFixture)
+
+BOOST_AUTO_TEST_CASE(test_expire)
+{
+    auto ioService = std::make_shared<boost::asio::io_service>();
+    // 10ms * 16 slots
+    auto wheel = std::make_shared<TimerWheel>(ioService, 10, 16);
+    auto handler = std::make_shared<FakeHandler>();
+    auto now = utcSteadyTime();
+    wheel->add(handler, 1, 50);
+    wheel->add(handler, 2, 100);
+    // longer than one round of the wheel
+    wheel->add(handler, 3, 1000);
+    BOOST_CHECK_EQUAL(wheel->size(), 3);
+
+    BOOST_CHECK_EQUAL(wheel->expire(now + 20), 0);
+    BOOST_CHECK_EQUAL(wheel->expire(now + 80), 1);
+    BOOST_CHECK(handler->expiredSeqs == std::vector<uint32_t>({1}));
+    BOOST_CHECK_EQUAL(wheel->expire(now + 150), 1);
+    BOOST_CHECK_EQUAL(wheel->expire(now + 500), 0);
+    BOOST_CHECK_EQUAL(wheel->size(), 1);
+    BOOST_CHECK_EQUAL(wheel->expire(now + 1100), 1);
+    BOOST_CHECK(handler->expiredSeqs == std::vector<uint32_t>({1, 2, 3}));
+    BOOST_CHECK_EQUAL(wheel->size(), 0);
+
+    // the handler has gone, the entry is dropped silently
+    auto tmpHandler = std::make_shared<FakeHandler>();
+    wheel->add(tmpHandler, 4, 10);
+    tmpHandler.reset();
+    BOOST_CHECK_EQUAL(wheel->expire(now + 2000), 1);
+    BOOST_CHECK_EQUAL(wheel->size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_tick)
+{
+    auto ioService = std::make_shared<boost::asio::io_service>();
+    auto wheel = std::make_shared<TimerWheel>(ioService, 5, 16);
+    auto handler = std::make_shared<FakeHandler>();
+    wheel->add(handler, 1, 10);
+    wheel->add(handler, 2, 30);
+    // the tick timer stops when the wheel is empty, so the io_service returns
+    ioService->run();
+    BOOST_CHECK(handler->expiredSeqs == std::vector<uint32_t>({1, 2}));
+    BOOST_CHECK_EQUAL(wheel->size(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
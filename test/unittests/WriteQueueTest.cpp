@@ -0,0 +1,206 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief test for the write queue of the session
+ * @file WriteQueueTest.cpp
+ */
+
+#include <bcos-framework/testutils/TestPromptFixture.h>
+#include <bcos-gateway/libnetwork/WriteQueue.h>
+#include <bcos-gateway/libp2p/P2PMessage.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace bcos;
+using namespace bcos::gateway;
+using namespace bcos::test;
+
+namespace
+{
+std::shared_ptr<bytes> makeBuffer(size_t _size, byte _tag)
+{
+    return std::make_shared<bytes>(_size, _tag);
+}
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE(WriteQueueTest, TestPromptFixture)
+
+BOOST_AUTO_TEST_CASE(test_classify)
+{
+    auto factory = std::make_shared<P2PMessageFactory>();
+    auto message = std::dynamic_pointer_cast<P2PMessage>(factory->buildMessage());
+
+    message->setPacketType(MessageType::Heartbeat);
+    BOOST_CHECK(WriteQueue::classify(message, 100) == MessagePriority::Control);
+
+    message->setPacketType(MessageType::PeerToPeerMessage);
+    BOOST_CHECK(WriteQueue::classify(message, 100) == MessagePriority::Consensus);
+    BOOST_CHECK(WriteQueue::classify(message, 100 * 1024) == MessagePriority::Normal);
+    BOOST_CHECK(WriteQueue::classify(message, 2 * 1024 * 1024) == MessagePriority::Bulk);
+
+    message->setRespPacket();
+    BOOST_CHECK(WriteQueue::classify(message, 100) == MessagePriority::Response);
+    BOOST_CHECK(WriteQueue::classify(message, 100 * 1024) == MessagePriority::Response);
+    BOOST_CHECK(WriteQueue::classify(message, 2 * 1024 * 1024) == MessagePriority::Bulk);
+
+    message->setExt(0);
+    message->setPacketType(MessageType::AMOPMessageType);
+    BOOST_CHECK(WriteQueue::classify(message, 100) == MessagePriority::AMOP);
+}
+
+BOOST_AUTO_TEST_CASE(test_controlFirst)
+{
+    WriteQueue queue;
+    queue.push(makeBuffer(10, 1), MessagePriority::Bulk);
+    queue.push(makeBuffer(10, 2), MessagePriority::Consensus);
+    queue.push(makeBuffer(10, 3), MessagePriority::Control);
+    BOOST_CHECK_EQUAL(queue.size(), 3);
+    BOOST_CHECK_EQUAL(queue.bytesSize(), 30);
+    BOOST_CHECK_EQUAL(queue.size(MessagePriority::Control), 1);
+
+    BOOST_CHECK_EQUAL((*queue.pop().buffer)[0], 3);
+    BOOST_CHECK_EQUAL(queue.size(MessagePriority::Control), 0);
+    BOOST_CHECK_EQUAL(queue.bytesSize(MessagePriority::Control), 0);
+
+    // the messages of the same class keep the FIFO order
+    queue.push(makeBuffer(10, 4), MessagePriority::Consensus);
+    BOOST_CHECK_EQUAL((*queue.pop().buffer)[0], 2);
+    BOOST_CHECK_EQUAL((*queue.pop().buffer)[0], 4);
+    BOOST_CHECK_EQUAL((*queue.pop().buffer)[0], 1);
+    BOOST_CHECK(queue.empty());
+    BOOST_CHECK(queue.pop().buffer == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(test_weightedFair)
+{
+    WriteQueue queue(1024);
+    // keep the consensus and the bulk class busy
+    for (size_t i = 0; i < 100; ++i)
+    {
+        queue.push(makeBuffer(1024, 1), MessagePriority::Consensus);
+        queue.push(makeBuffer(1024, 2), MessagePriority::Bulk);
+    }
+    std::map<byte, size_t> sentBytes;
+    for (size_t i = 0; i < 90; ++i)
+    {
+        auto buffer = queue.pop();
+        sentBytes[(*buffer.buffer)[0]] += buffer.size();
+    }
+    // the bandwidth is shared by weight(8:1), the bulk class is not starved
+    BOOST_CHECK_EQUAL(sentBytes[1], 80 * 1024);
+    BOOST_CHECK_EQUAL(sentBytes[2], 10 * 1024);
+
+    // the large message is sent after enough rounds
+    WriteQueue largeQueue(1024);
+    largeQueue.push(makeBuffer(64 * 1024, 2), MessagePriority::Bulk);
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        largeQueue.push(makeBuffer(1024, 1), MessagePriority::Consensus);
+    }
+    size_t popped = 0;
+    while ((*largeQueue.pop().buffer)[0] != 2)
+    {
+        popped++;
+    }
+    // 64 rounds to accumulate the deficit, 8 consensus messages per round
+    BOOST_CHECK_EQUAL(popped, 64 * 8);
+    BOOST_CHECK(!largeQueue.metrics().empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_responseFlood)
+{
+    auto factory = std::make_shared<P2PMessageFactory>();
+    auto response = std::dynamic_pointer_cast<P2PMessage>(factory->buildMessage());
+    response->setPacketType(MessageType::PeerToPeerMessage);
+    response->setRespPacket();
+    auto consensus = std::dynamic_pointer_cast<P2PMessage>(factory->buildMessage());
+    consensus->setPacketType(MessageType::PeerToPeerMessage);
+
+    WriteQueue queue(1024);
+    // a flood of the small responses queued before the consensus messages
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        queue.push(makeBuffer(1024, 1), WriteQueue::classify(response, 1024));
+    }
+    for (size_t i = 0; i < 100; ++i)
+    {
+        queue.push(makeBuffer(1024, 2), WriteQueue::classify(consensus, 1024));
+    }
+    BOOST_CHECK_EQUAL(queue.size(MessagePriority::Control), 0);
+
+    std::map<byte, size_t> sentBytes;
+    size_t firstConsensus = 0;
+    for (size_t i = 0; i < 120; ++i)
+    {
+        auto tag = (*queue.pop().buffer)[0];
+        if (tag == 2 && sentBytes[2] == 0)
+        {
+            firstConsensus = i;
+        }
+        sentBytes[tag] += 1024;
+    }
+    // the consensus messages are sent in the first round, and get their weight(8:4)
+    BOOST_CHECK_LT(firstConsensus, 8);
+    BOOST_CHECK_EQUAL(sentBytes[2], 80 * 1024);
+    BOOST_CHECK_EQUAL(sentBytes[1], 40 * 1024);
+}
+
+BOOST_AUTO_TEST_CASE(test_watermark)
+{
+    WriteQueueWatermark watermark;
+    watermark.highBytes = 100;
+    watermark.lowBytes = 50;
+    watermark.highMessages = 4;
+    watermark.lowMessages = 2;
+
+    WriteQueue queue;
+    queue.push(makeBuffer(60, 1), MessagePriority::Normal);
+    BOOST_CHECK(!queue.aboveHighWatermark(watermark));
+    BOOST_CHECK(!queue.belowLowWatermark(watermark));
+    queue.push(makeBuffer(60, 1), MessagePriority::Normal);
+    BOOST_CHECK(queue.aboveHighWatermark(watermark));
+    queue.pop();
+    queue.pop();
+    BOOST_CHECK(queue.belowLowWatermark(watermark));
+
+    // too many small messages
+    for (size_t i = 0; i < 5; ++i)
+    {
+        queue.push(makeBuffer(1, 1), MessagePriority::Consensus);
+    }
+    BOOST_CHECK(queue.aboveHighWatermark(watermark));
+    queue.pop();
+    queue.pop();
+    BOOST_CHECK(!queue.belowLowWatermark(watermark));
+    queue.pop();
+    BOOST_CHECK(queue.belowLowWatermark(watermark));
+}
+
+BOOST_AUTO_TEST_CASE(test_gatherBuffer)
+{
+    // the payload referenced by the frame is counted and kept alive by the queue
+    WriteQueue queue;
+    auto payload = makeBuffer(100, 2);
+    WriteBuffer frame{makeBuffer(10, 1), bytesConstRef(payload->data(), payload->size()), payload};
+    queue.push(std::move(frame), MessagePriority::Normal);
+    BOOST_CHECK_EQUAL(queue.bytesSize(), 110);
+    payload.reset();
+    auto buffer = queue.pop();
+    BOOST_CHECK_EQUAL(buffer.size(), 110);
+    BOOST_CHECK_EQUAL(buffer.toBytes().size(), 110);
+    BOOST_CHECK_EQUAL(buffer.payload[99], 2);
+    BOOST_CHECK_EQUAL(queue.bytesSize(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()